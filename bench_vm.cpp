@@ -0,0 +1,968 @@
+#include "compiler/vm/VirtualMachine.h"
+#include "compiler/vm/RegisterVM.h"
+#include "compiler/vm/VMPool.h"
+#include "compiler/vm/VMScheduler.h"
+#include "compiler/batch/BatchRunner.h"
+#include "compiler/verifier/BytecodeVerifier.h"
+#include "compiler/codegen/CodeGenerator.h"
+#include "compiler/codegen/RegisterCodeGenerator.h"
+#include "compiler/semantic/SemanticAnalyzer.h"
+#include "compiler/parser/Parser.h"
+#include "compiler/lexer/Lexer.h"
+#include "compiler/lexer/SourceBuffer.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <fcntl.h>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <mutex>
+
+#ifdef _WIN32
+#include <io.h>
+#define NULL_DEVICE "NUL"
+#else
+#include <unistd.h>
+#define NULL_DEVICE "/dev/null"
+#endif
+
+// Every heap allocation on this thread (counted to check that VM reuse stops allocating).
+// The whole replaceable set is defined, so every form of new is counted and
+// every form of delete releases what its matching new returned
+static thread_local std::uint64_t heapAllocations = 0;
+
+// Kept out of line: GCC would otherwise see free() inlined into callers of
+// operator new and warn about a mismatched deallocation (-Wmismatched-new-delete)
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+
+static void* countedAllocate(std::size_t size) noexcept {
+    ++heapAllocations;
+    return std::malloc(size ? size : 1);
+}
+BENCH_NOINLINE static void countedRelease(void* p) noexcept { std::free(p); }
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+    if (void* p = countedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, std::size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedRelease(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedRelease(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedRelease(p); }
+
+// Nested loops in the style of demo_multiplication_table.txt, scaled up
+const char* NESTED_LOOPS =
+    "let multiplier = 3;\n"
+    "for i = 1 to 400 {\n"
+    "    for j = 1 to 400 {\n"
+    "        let result = i * j * multiplier;\n"
+    "    }\n"
+    "}\n";
+
+// demo_complex_expressions.txt, evaluated 200,000 times
+const char* COMPLEX_EXPRESSIONS =
+    "let a = 5;\n"
+    "let b = 3;\n"
+    "let c = 2;\n"
+    "for i = 1 to 200000 {\n"
+    "    let expr1 = a + b * c + i;\n"
+    "    let expr2 = (a + b) * c - i;\n"
+    "    let expr3 = a * b + c * 4 * i;\n"
+    "    let optimizable = 10 + 20 * 2 - 5;\n"
+    "    let mixed = (expr1 * expr2 - expr3) % 1000 + optimizable / (c + 1);\n"
+    "}\n"
+    "print mixed;\n";
+
+// A long simulation: 16M inner iterations
+const char* LONG_SIMULATION =
+    "let multiplier = 3;\n"
+    "for i = 1 to 4000 {\n"
+    "    for j = 1 to 4000 {\n"
+    "        let result = i * j * multiplier;\n"
+    "    }\n"
+    "}\n";
+
+// A print-heavy table: 200,000 lines of output
+const char* PRINT_TABLE =
+    "for i = 1 to 500 {\n"
+    "    for j = 1 to 400 {\n"
+    "        print i * j;\n"
+    "    }\n"
+    "}\n";
+
+std::vector<std::unique_ptr<Statement>> parseChecked(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parse();
+
+    SemanticAnalyzer analyzer(program);
+    analyzer.analyze();
+    if (analyzer.hasErrors()) {
+        throw std::runtime_error(analyzer.getErrors()[0].what());
+    }
+    return program;
+}
+
+BytecodeProgram compileSource(const std::string& source, unsigned superinstructions = FUSE_NONE,
+                              bool verify = true) {
+    auto program = parseChecked(source);
+
+    CodeGenerator codegen;
+    codegen.setSuperinstructions(superinstructions);
+    BytecodeProgram bytecode = codegen.generate(program);
+    
+    if (verify) {
+        BytecodeVerifier verifier(bytecode);
+        verifier.verify();
+    }
+    return bytecode;
+}
+
+RegisterProgram compileRegisters(const std::string& source) {
+    auto program = parseChecked(source);
+    RegisterCodeGenerator codegen;
+    return codegen.generate(program);
+}
+
+// The demos/*.txt programs (sorted by name) plus the scaled nested-loop program
+std::vector<std::pair<std::string, std::string>> loadCorpus() {
+    std::vector<std::pair<std::string, std::string>> corpus;
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator("demos")) {
+        if (entry.path().extension() == ".txt") files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        corpus.emplace_back(std::filesystem::path(file).filename().string(), buffer.str());
+    }
+    corpus.emplace_back("nested_loops (bench)", NESTED_LOOPS);
+    return corpus;
+}
+
+// Run a program with its PRINT output discarded; returns instructions dispatched
+std::int64_t runSilently(const BytecodeProgram& bytecode) {
+    CountingSink discard;
+    VirtualMachine vm;
+    vm.setOutput(&discard);
+    vm.execute(bytecode);
+    return vm.getInstructionCount();
+}
+
+struct RunResult {
+    double seconds;
+    std::int64_t instructions;
+};
+
+// Best-of-N wall time for one configured VM
+RunResult timeRun(VirtualMachine& vm, const BytecodeProgram& bytecode, int repeats = 5) {
+    RunResult best{1e30, 0};
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        vm.execute(bytecode);
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        if (seconds < best.seconds) best.seconds = seconds;
+        best.instructions = vm.getInstructionCount();
+    }
+    return best;
+}
+
+void printRow(const std::string& label, const RunResult& result, double baselineSeconds) {
+    double nsPerInstr = result.seconds * 1e9 / result.instructions;
+    std::cout << "  " << std::left << std::setw(22) << label << std::right
+              << std::setw(12) << result.instructions << " instr  "
+              << std::fixed << std::setprecision(2) << std::setw(8) << nsPerInstr << " ns/instr  "
+              << std::setprecision(2) << std::setw(6) << (baselineSeconds / result.seconds) << "x\n";
+}
+
+void benchDispatch() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Dispatch Loop (nested loops)\n";
+    std::cout << "════════════════════════════════════════\n";
+
+    BytecodeProgram bytecode = compileSource(NESTED_LOOPS, FUSE_NONE, false);
+    BytecodeProgram verified = compileSource(NESTED_LOOPS);
+
+    VirtualMachine classic;
+    classic.setDispatchMode(DispatchMode::Classic);
+    RunResult classicResult = timeRun(classic, bytecode);
+
+    VirtualMachine threaded;
+    threaded.setDispatchMode(DispatchMode::Threaded);
+    RunResult threadedResult = timeRun(threaded, bytecode);
+    RunResult uncheckedResult = timeRun(threaded, verified);
+    
+    // Observer-specialized loops (the untraced rows above have no hooks at all)
+    VirtualMachine traced;
+    traced.setTraceMode(true);
+    RunResult tracedResult = timeRun(traced, verified);
+    VirtualMachine profiled;
+    profiled.setObserverMode(ObserverMode::Profile);
+    RunResult profiledResult = timeRun(profiled, verified);
+    
+    // Budgets checked at backward jumps (limits high enough never to trigger)
+    ExecutionBudget budget;
+    budget.maxInstructions = INT64_MAX / 2;
+    budget.maxWallTime = std::chrono::milliseconds(60000);
+    VirtualMachine budgeted;
+    budgeted.setBudget(budget);
+    RunResult budgetedResult = timeRun(budgeted, verified);
+    
+    // Native code (compile time included in every run)
+    VirtualMachine jit;
+    jit.setEngine(ExecutionEngine::Jit);
+    RunResult jitResult = timeRun(jit, verified);
+    VirtualMachine jitBudgeted;
+    jitBudgeted.setEngine(ExecutionEngine::Jit);
+    jitBudgeted.setBudget(budget);
+    RunResult jitBudgetedResult = timeRun(jitBudgeted, verified);
+
+    printRow("classic", classicResult, classicResult.seconds);
+    printRow("threaded", threadedResult, classicResult.seconds);
+    printRow("threaded (verified)", uncheckedResult, classicResult.seconds);
+    printRow("  + trace ring buffer", tracedResult, classicResult.seconds);
+    printRow("  + opcode profile", profiledResult, classicResult.seconds);
+    printRow("  + fuel/time budget", budgetedResult, classicResult.seconds);
+    printRow(jit.getLastEngine() == ExecutionEngine::Jit ? "jit" : "jit (unsupported host)",
+             jitResult, classicResult.seconds);
+    printRow("  + fuel/time budget", jitBudgetedResult, classicResult.seconds);
+
+    if (classicResult.instructions == threadedResult.instructions &&
+        classicResult.instructions == uncheckedResult.instructions &&
+        classicResult.instructions == budgetedResult.instructions &&
+        classicResult.instructions == jitResult.instructions &&
+        classicResult.instructions == jitBudgetedResult.instructions) {
+        std::cout << "✅ Instruction counts match\n\n";
+    } else {
+        std::cout << "❌ Instruction counts differ\n\n";
+    }
+}
+
+void benchSuperinstructions() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Report: Superinstruction Dispatch Savings\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    struct Family { Superinstruction kind; const char* name; };
+    const Family families[] = {
+        {FUSE_INCREMENT, "inc"},
+        {FUSE_COMPARE_BRANCH, "cmp+br"},
+        {FUSE_SLOT_CONST_ARITH, "slot+k"},
+        {FUSE_STORE_LOAD, "st+ld"},
+    };
+    
+    auto corpus = loadCorpus();
+    
+    std::cout << "  " << std::left << std::setw(34) << "program" << std::right
+              << std::setw(10) << "baseline";
+    for (const auto& family : families) std::cout << std::setw(9) << family.name;
+    std::cout << std::setw(9) << "all" << std::setw(8) << "saved" << "\n";
+    
+    long long totalBase = 0, totalAll = 0;
+    long long totalSaved[4] = {0, 0, 0, 0};
+    for (const auto& [name, source] : corpus) {
+        std::cout << "  " << std::left << std::setw(34) << name << std::right;
+        try {
+            std::int64_t base = runSilently(compileSource(source));
+            std::cout << std::setw(10) << base;
+            for (size_t f = 0; f < 4; ++f) {
+                std::int64_t saved = base - runSilently(compileSource(source, families[f].kind));
+                totalSaved[f] += saved;
+                std::cout << std::setw(9) << ("-" + std::to_string(saved));
+            }
+            std::int64_t all = runSilently(compileSource(source, FUSE_ALL));
+            totalBase += base;
+            totalAll += all;
+            std::cout << std::setw(9) << all << std::setw(7) << std::fixed << std::setprecision(0)
+                      << (100.0 * (base - all) / base) << "%\n";
+        } catch (const std::exception&) {
+            std::cout << "  (skipped: does not compile)\n";
+        }
+    }
+    
+    std::cout << "  " << std::left << std::setw(34) << "TOTAL" << std::right << std::setw(10) << totalBase;
+    for (size_t f = 0; f < 4; ++f) std::cout << std::setw(9) << ("-" + std::to_string(totalSaved[f]));
+    std::cout << std::setw(9) << totalAll << std::setw(7) << std::fixed << std::setprecision(0)
+              << (100.0 * (totalBase - totalAll) / totalBase) << "%\n";
+    
+    // Wall-time effect on the nested loops
+    BytecodeProgram plain = compileSource(NESTED_LOOPS);
+    BytecodeProgram fused = compileSource(NESTED_LOOPS, FUSE_ALL);
+    VirtualMachine vm;
+    RunResult plainResult = timeRun(vm, plain);
+    RunResult fusedResult = timeRun(vm, fused);
+    std::cout << "\n";
+    printRow("threaded", plainResult, plainResult.seconds);
+    printRow("threaded + fused", fusedResult, plainResult.seconds);
+    std::cout << "\n";
+}
+
+void benchTopOfStackCache() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Top-of-Stack Caching\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    const std::pair<const char*, const char*> programs[] = {
+        {"complex expressions", COMPLEX_EXPRESSIONS},
+        {"nested loops", NESTED_LOOPS},
+    };
+    for (const auto& [name, source] : programs) {
+        std::cout << "  " << name << ":\n";
+        for (unsigned fuse : {static_cast<unsigned>(FUSE_NONE), static_cast<unsigned>(FUSE_ALL)}) {
+            BytecodeProgram bytecode = compileSource(source, fuse);
+            
+            VirtualMachine threaded;
+            VirtualMachine cached;
+            cached.setDispatchMode(DispatchMode::Cached);
+            CountingSink threadedOut, cachedOut;
+            threaded.setOutput(&threadedOut);
+            cached.setOutput(&cachedOut);
+            RunResult threadedResult = timeRun(threaded, bytecode);
+            RunResult cachedResult = timeRun(cached, bytecode);
+            
+            // Same program state at the end of both loops
+            bool same = threadedResult.instructions == cachedResult.instructions &&
+                        threadedOut.getByteCount() == cachedOut.getByteCount();
+            for (int slot = 0; same && slot < threaded.getSlotCount(); ++slot) {
+                same = threaded.getSlotValue(slot) == cached.getSlotValue(slot);
+            }
+            
+            const char* suffix = fuse == FUSE_ALL ? " + fused" : "";
+            printRow(std::string("threaded") + suffix, threadedResult, threadedResult.seconds);
+            printRow(std::string("cached") + suffix, cachedResult, threadedResult.seconds);
+            if (!same) {
+                std::cout << "  ❌ Cached loop diverged from the threaded loop\n";
+            }
+        }
+    }
+    std::cout << "\n";
+}
+
+void benchCountedLoops() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: FOR_PREP / FOR_LOOP Counted Loops\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    auto compile = [](const char* source, bool counted) {
+        auto program = parseChecked(source);
+        CodeGenerator codegen;
+        codegen.setForLoopOpcodes(counted);
+        BytecodeProgram bytecode = codegen.generate(program);
+        BytecodeVerifier verifier(bytecode);
+        verifier.verify();
+        return bytecode;
+    };
+    
+    const std::pair<const char*, const char*> programs[] = {
+        {"nested loops", NESTED_LOOPS},
+        {"slot arithmetic loop", "for i = 1 to 1000000 {\n    let r = i % 7 + 1;\n}"},
+    };
+    for (const auto& [name, source] : programs) {
+        std::cout << "  " << name << ":\n";
+        BytecodeProgram reevaluated = compile(source, false);
+        BytecodeProgram counted = compile(source, true);
+        for (int engine = 0; engine < 3; ++engine) {
+            VirtualMachine vm;
+            vm.setDispatchMode(engine == 1 ? DispatchMode::Cached : DispatchMode::Threaded);
+            vm.setEngine(engine == 2 ? ExecutionEngine::Jit : ExecutionEngine::Interpreter);
+            CountingSink discard;
+            vm.setOutput(&discard);
+            const char* label = engine == 0 ? "threaded" : engine == 1 ? "cached" : "jit";
+            RunResult before = timeRun(vm, reevaluated);
+            RunResult after = timeRun(vm, counted);
+            printRow(std::string(label), before, before.seconds);
+            printRow(std::string(label) + " + FOR_LOOP", after, before.seconds);
+        }
+    }
+    std::cout << "\n";
+}
+
+void benchSamplingProfiler() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Sampling Profiler Overhead (long run)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    // A few hundred milliseconds per run, so the per-run timer setup is noise
+    BytecodeProgram bytecode = compileSource(LONG_SIMULATION);
+    VirtualMachine plain, instrumented, sampled;
+    instrumented.setObserverMode(ObserverMode::Profile);
+    sampled.setObserverMode(ObserverMode::Sample);
+    CountingSink discard;
+    for (VirtualMachine* vm : {&plain, &instrumented, &sampled}) vm->setOutput(&discard);
+    
+    // Interleave the configurations so frequency drift hits all of them
+    RunResult plainResult{1e30, 0}, instrumentedResult{1e30, 0}, sampledResult{1e30, 0};
+    for (int round = 0; round < 5; ++round) {
+        for (auto [vm, best] : {std::pair{&plain, &plainResult}, std::pair{&instrumented, &instrumentedResult},
+                                std::pair{&sampled, &sampledResult}}) {
+            RunResult result = timeRun(*vm, bytecode, 1);
+            if (result.seconds < best->seconds) *best = result;
+        }
+    }
+    printRow("threaded", plainResult, plainResult.seconds);
+    printRow("instrumented profile", instrumentedResult, plainResult.seconds);
+    printRow("sampled (1 ms)", sampledResult, plainResult.seconds);
+    std::cout << "  " << sampled.getSampler().getTotalSamples() << " samples in the last run, overhead "
+              << std::fixed << std::setprecision(1)
+              << 100.0 * (sampledResult.seconds - plainResult.seconds) / plainResult.seconds << "%\n";
+    sampled.getSampler().printHistogram(std::cout, bytecode, 5);
+    std::cout << "\n";
+}
+
+void benchCheckpoints() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Checkpoint Overhead (long run)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    BytecodeProgram bytecode = compileSource(LONG_SIMULATION);
+    VirtualMachine plain, everyMillion, everyTenThousand;
+    std::uint64_t taken = 0;
+    std::vector<std::uint8_t> encoded;
+    auto keep = [&](const VMSnapshot& snapshot) {
+        snapshot.encode(encoded);
+        ++taken;
+    };
+    everyMillion.setCheckpointInterval(1000000, keep);
+    everyTenThousand.setCheckpointInterval(10000, keep);
+    CountingSink discard;
+    for (VirtualMachine* vm : {&plain, &everyMillion, &everyTenThousand}) vm->setOutput(&discard);
+    
+    RunResult plainResult{1e30, 0}, millionResult{1e30, 0}, tenThousandResult{1e30, 0};
+    for (int round = 0; round < 5; ++round) {
+        for (auto [vm, best] : {std::pair{&plain, &plainResult}, std::pair{&everyMillion, &millionResult},
+                                std::pair{&everyTenThousand, &tenThousandResult}}) {
+            RunResult result = timeRun(*vm, bytecode, 1);
+            if (result.seconds < best->seconds) *best = result;
+        }
+    }
+    printRow("threaded", plainResult, plainResult.seconds);
+    printRow("checkpoint every 1M", millionResult, plainResult.seconds);
+    printRow("checkpoint every 10k", tenThousandResult, plainResult.seconds);
+    
+    // Cost of one checkpoint (capture + encode), from the 10k-interval runs
+    std::uint64_t perRun = taken / 10;
+    double each = (tenThousandResult.seconds - plainResult.seconds) * 1e9 / std::max<std::uint64_t>(perRun, 1);
+    std::cout << "  " << perRun << " checkpoints per 10k-interval run, ~" << std::fixed << std::setprecision(0)
+              << std::max(each, 0.0) << " ns each, " << encoded.size() << " bytes encoded\n";
+    
+    // Restoring the last one and finishing the run
+    VirtualMachine restored;
+    restored.setOutput(&discard);
+    VMSnapshot snapshot = VMSnapshot::decode(encoded);
+    auto start = std::chrono::steady_clock::now();
+    restored.restore(bytecode, snapshot);
+    restored.resume();
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "  restore at instruction " << snapshot.instructionCount << " and finish: "
+              << std::setprecision(1) << std::chrono::duration<double, std::micro>(end - start).count()
+              << " us (" << restored.getInstructionCount() << " instructions in total)\n\n";
+}
+
+void benchTieredExecution() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Tiered Execution\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    // Cold straight-line code, where the JIT's up-front compile dominates,
+    // and the hot loops, where the tiered engine should match it
+    const std::pair<const char*, const char*> programs[] = {
+        {"cold (demo2 x1)", "let a = 10;\nlet b = 20;\nlet c = a + b * 2;\nprint c;\nprint a - b;"},
+        {"nested loops", NESTED_LOOPS},
+        {"slot arithmetic loop", "for i = 1 to 1000000 {\n    let r = i % 7 + 1;\n}"},
+    };
+    for (const auto& [name, source] : programs) {
+        std::cout << "  " << name << ":\n";
+        BytecodeProgram bytecode = compileSource(source);
+        CountingSink discard;
+        
+        VirtualMachine threaded, jit, fused, native;
+        jit.setEngine(ExecutionEngine::Jit);
+        fused.setEngine(ExecutionEngine::Tiered);
+        fused.setNativeTier(false);
+        native.setEngine(ExecutionEngine::Tiered);
+        for (VirtualMachine* vm : {&threaded, &jit, &fused, &native}) vm->setOutput(&discard);
+        
+        RunResult threadedResult = timeRun(threaded, bytecode);
+        RunResult jitResult = timeRun(jit, bytecode);
+        RunResult fusedResult = timeRun(fused, bytecode);
+        RunResult nativeResult = timeRun(native, bytecode);
+        printRow("threaded", threadedResult, threadedResult.seconds);
+        printRow("jit (whole program)", jitResult, threadedResult.seconds);
+        printRow("tiered, fused loops", fusedResult, threadedResult.seconds);
+        printRow("tiered, native loops", nativeResult, threadedResult.seconds);
+        for (VirtualMachine* vm : {&fused, &native}) {
+            for (const TierUp& tierUp : vm->getTierUps()) {
+                std::cout << "    line " << tierUp.line << " -> " << loopTierName(tierUp.tier) << " after "
+                          << tierUp.promotedAt << " instructions, entered " << tierUp.entries << " time(s)\n";
+            }
+        }
+    }
+    std::cout << "\n";
+}
+
+void benchRegisterVM() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Register VM vs Stack VM\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    // Best-of-5 time per execute(); small programs are repeated so each sample is measurable
+    auto timePerRun = [](auto&& execute, std::int64_t instructions) {
+        std::int64_t inner = std::max<std::int64_t>(1, 1000000 / std::max<std::int64_t>(instructions, 1));
+        double best = 1e30;
+        for (int r = 0; r < 5; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            for (std::int64_t i = 0; i < inner; ++i) execute();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count() / inner);
+        }
+        return best;
+    };
+    
+    std::cout << "  " << std::left << std::setw(34) << "program" << std::right
+              << std::setw(10) << "stack" << std::setw(10) << "fused" << std::setw(10) << "register"
+              << std::setw(12) << "stack ns" << std::setw(12) << "fused ns" << std::setw(12) << "reg ns"
+              << std::setw(9) << "speedup" << "\n";
+    
+    std::int64_t totalStack = 0, totalFused = 0, totalRegister = 0;
+    bool outputsMatch = true;
+    for (const auto& [name, source] : loadCorpus()) {
+        std::cout << "  " << std::left << std::setw(34) << name << std::right;
+        try {
+            BytecodeProgram stack = compileSource(source);
+            BytecodeProgram fused = compileSource(source, FUSE_ALL);
+            RegisterProgram registers = compileRegisters(source);
+            
+            BufferSink stackOut, registerOut;
+            CountingSink discard;
+            VirtualMachine vm;
+            RegisterVM registerVm;
+            registerVm.setOutput(&registerOut);
+            
+            vm.setOutput(&stackOut);
+            vm.execute(stack);
+            std::int64_t stackCount = vm.getInstructionCount();
+            vm.setOutput(&discard);
+            vm.execute(fused);
+            std::int64_t fusedCount = vm.getInstructionCount();
+            registerVm.execute(registers);
+            std::int64_t registerCount = registerVm.getInstructionCount();
+            if (stackOut.str() != registerOut.str()) {
+                outputsMatch = false;
+            }
+            
+            registerVm.setOutput(&discard);
+            double stackSeconds = timePerRun([&] { vm.execute(stack); }, stackCount);
+            double fusedSeconds = timePerRun([&] { vm.execute(fused); }, fusedCount);
+            double registerSeconds = timePerRun([&] { registerVm.execute(registers); }, registerCount);
+            
+            totalStack += stackCount;
+            totalFused += fusedCount;
+            totalRegister += registerCount;
+            std::cout << std::setw(10) << stackCount << std::setw(10) << fusedCount << std::setw(10) << registerCount
+                      << std::fixed << std::setprecision(0)
+                      << std::setw(12) << stackSeconds * 1e9 << std::setw(12) << fusedSeconds * 1e9
+                      << std::setw(12) << registerSeconds * 1e9
+                      << std::setprecision(2) << std::setw(8) << (stackSeconds / registerSeconds) << "x\n";
+        } catch (const std::exception&) {
+            std::cout << "  (skipped: does not compile)\n";
+        }
+    }
+    
+    std::cout << "  " << std::left << std::setw(34) << "TOTAL" << std::right << std::setw(10) << totalStack
+              << std::setw(10) << totalFused << std::setw(10) << totalRegister << "   ("
+              << std::fixed << std::setprecision(2) << (static_cast<double>(totalStack) / totalRegister)
+              << "x fewer dispatches than stack)\n";
+    std::cout << (outputsMatch ? "✅ Register VM output matches the stack VM\n\n"
+                               : "❌ Register VM output differs from the stack VM\n\n");
+}
+
+void benchVmReuse() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: VM Reuse (demo corpus, 20k short runs)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    std::vector<BytecodeProgram> programs;
+    for (const auto& [name, source] : loadCorpus()) {
+        if (source == NESTED_LOOPS) continue;
+        try {
+            programs.push_back(compileSource(source));
+        } catch (const std::exception&) {
+        }
+    }
+    const int runs = 20000;
+    
+    // Runs every program round-robin; reports heap and VM-counted allocations per run
+    auto measure = [&](const std::string& label, auto&& runOne) {
+        std::uint64_t vmAllocations = 0;
+        std::uint64_t heapBefore = heapAllocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; ++i) {
+            vmAllocations += runOne(programs[i % programs.size()]);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(8)
+                  << static_cast<double>(heapAllocations - heapBefore) / runs << " heap allocs/run  "
+                  << std::setw(6) << static_cast<double>(vmAllocations) / runs << " VM allocs/run  "
+                  << std::setprecision(0) << std::setw(8) << seconds * 1e9 / runs << " ns/run\n";
+    };
+    
+    measure("fresh VM per run", [](const BytecodeProgram& program) {
+        VirtualMachine vm;
+        BufferSink out;
+        vm.setOutput(&out);
+        vm.execute(program);
+        return vm.getAllocationCount();
+    });
+    
+    VirtualMachine reused;
+    BufferSink reusedOut;
+    reused.setOutput(&reusedOut);
+    measure("reused VM", [&](const BytecodeProgram& program) {
+        reusedOut.clear();
+        reused.execute(program);
+        return reused.getAllocationCount();
+    });
+    
+    VMPool pool(4);
+    BufferSink pooledOut;
+    measure("pooled VM (checkout)", [&](const BytecodeProgram& program) {
+        VMPool::Lease vm = pool.acquire();
+        pooledOut.clear();
+        vm->setOutput(&pooledOut);
+        vm->execute(program);
+        return vm->getAllocationCount();
+    });
+    std::cout << "\n";
+}
+
+void benchBatchRunner() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Batch Runner (demo corpus x500, full pipeline)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    std::vector<BatchJob> jobs;
+    auto corpus = loadCorpus();
+    for (int copy = 0; copy < 500; ++copy) {
+        for (const auto& [name, source] : corpus) {
+            if (source != NESTED_LOOPS) jobs.push_back({name, "", source});
+        }
+    }
+    
+    // Programs per second at each worker count, relative to one worker
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts = {1};
+    for (unsigned n = 2; n < hardware; n *= 2) counts.push_back(n);
+    if (hardware > 1) counts.push_back(hardware);
+    
+    double single = 0;
+    for (unsigned workers : counts) {
+        BatchRunner runner(workers);
+        double best = 1e30;
+        for (int round = 0; round < 3; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            runner.run(jobs, [](const BatchResult&) {});
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        if (workers == 1) single = best;
+        std::cout << "  " << std::setw(3) << workers << " workers  " << std::fixed << std::setprecision(0)
+                  << std::setw(10) << jobs.size() / best << " programs/s  " << std::setprecision(2)
+                  << std::setw(6) << single / best << "x  (" << runner.getStealCount() << " stolen)\n";
+    }
+    std::cout << "\n";
+}
+
+void benchScheduler() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Scheduler Latency (long programs + 2000 short ones)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    BytecodeProgram longProgram = compileSource(COMPLEX_EXPRESSIONS);
+    std::vector<BytecodeProgram> shortPrograms;
+    for (const auto& [name, source] : loadCorpus()) {
+        if (source == NESTED_LOOPS) continue;
+        try {
+            shortPrograms.push_back(compileSource(source));
+        } catch (const std::exception&) {
+        }
+    }
+    unsigned threads = std::min(4u, std::max(1u, std::thread::hardware_concurrency()));
+    
+    // The long programs are queued first; short-program latency is measured from submit()
+    auto measure = [&](const std::string& label, std::int64_t slice) {
+        std::mutex lock;
+        std::vector<double> shortLatency;
+        double longLatency = 0;
+        auto start = std::chrono::steady_clock::now();
+        {
+            VMScheduler scheduler(threads, slice);
+            for (unsigned i = 0; i < threads * 2; ++i) {
+                scheduler.submit(longProgram, [&](const ScheduledResult& result) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    longLatency = std::max(longLatency, result.latency);
+                });
+            }
+            for (int i = 0; i < 2000; ++i) {
+                scheduler.submit(shortPrograms[i % shortPrograms.size()], [&](const ScheduledResult& result) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    shortLatency.push_back(result.latency);
+                });
+            }
+            scheduler.wait();
+        }
+        double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::sort(shortLatency.begin(), shortLatency.end());
+        auto percentile = [&](double p) { return shortLatency[static_cast<size_t>(p * (shortLatency.size() - 1))] * 1e3; };
+        std::cout << "  " << std::left << std::setw(24) << label << std::right << std::fixed << std::setprecision(2)
+                  << "short p50 " << std::setw(7) << percentile(0.5) << " ms  p99 " << std::setw(7)
+                  << percentile(0.99) << " ms   long done " << std::setw(7) << longLatency * 1e3
+                  << " ms   total " << std::setw(7) << total * 1e3 << " ms\n";
+    };
+    std::cout << "  " << threads << " threads\n";
+    measure("run to completion", std::int64_t(1) << 60);
+    measure("sliced (100k instr)", DEFAULT_SCHEDULER_SLICE);
+    measure("sliced (10k instr)", 10000);
+    std::cout << "\n";
+}
+
+void benchOutputSinks() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: PRINT Output Sinks (200k lines)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    BytecodeProgram bytecode = compileSource(PRINT_TABLE);
+    
+    // Best-of-N wall time with a fresh sink per run
+    auto timeSink = [&](const std::string& label, auto makeSink, double baselineSeconds) {
+        double best = 1e30;
+        std::uint64_t lines = 0;
+        for (int r = 0; r < 5; ++r) {
+            auto sink = makeSink();
+            VirtualMachine vm;
+            vm.setOutput(sink.get());
+            auto start = std::chrono::steady_clock::now();
+            vm.execute(bytecode);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+            lines = sink->getLineCount();
+        }
+        std::cout << "  " << std::left << std::setw(26) << label << std::right
+                  << std::setw(8) << lines << " lines  "
+                  << std::fixed << std::setprecision(2) << std::setw(8) << (best * 1e9 / lines) << " ns/line  "
+                  << std::setw(6) << (baselineSeconds > 0 ? baselineSeconds / best : 1.0) << "x\n";
+        return best;
+    };
+    
+    std::ostringstream captured;
+    double streamSeconds = timeSink("stream (ostringstream)", [&] {
+        captured.str("");
+        return std::make_unique<StreamSink>(captured);
+    }, 0);
+    timeSink("buffer", [] { return std::make_unique<BufferSink>(); }, streamSeconds);
+    
+    int nullFd = open(NULL_DEVICE, O_WRONLY);
+    if (nullFd >= 0) {
+        timeSink("fd (" NULL_DEVICE ")", [&] { return std::make_unique<FdSink>(nullFd); }, streamSeconds);
+        close(nullFd);
+    }
+    timeSink("counting", [] { return std::make_unique<CountingSink>(); }, streamSeconds);
+    std::cout << "\n";
+}
+
+void benchFrontEnd() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Lexer and Parser (generated 50k-line program)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    // Generated-code style names, too long for the small-string buffer
+    std::string source = "let running_total_0 = 1;\n";
+    for (int k = 1; k < 50000; ++k) {
+        std::string name = "running_total_" + std::to_string(k);
+        source += "let " + name + " = (running_total_" + std::to_string(k - 1) + " + " +
+                  std::to_string(k) + ") * 3 % 1000;\n";
+        if (k % 10 == 0) source += "if " + name + " >= 500 {\n    print " + name + ";\n}\n";
+    }
+    
+    // Mostly keywords and short identifiers, with few numbers or operators
+    std::string identifiers;
+    const char* names[] = {"a", "idx", "count", "total", "lo", "hi", "fortune", "tolerance",
+                           "letter", "iffy", "elsewhere", "printer", "x1", "y2", "_tmp"};
+    for (int k = 0; k < 50000; ++k) {
+        const char* a = names[k % 15];
+        const char* b = names[(k * 7 + 3) % 15];
+        const char* c = names[(k * 11 + 5) % 15];
+        identifiers += std::string("for ") + a + " = " + b + " to " + c + " { if " + a + " { print " +
+                       b + "; } else { let " + c + " = " + a + "; } }\n";
+    }
+    
+    // Best of 5; heap allocations counted for the whole stage
+    auto measure = [&](const std::string& label, const std::string& input, auto&& stage) {
+        double best = 1e30;
+        size_t tokens = 0;
+        std::uint64_t allocations = 0;
+        for (int r = 0; r < 5; ++r) {
+            std::uint64_t heapBefore = heapAllocations;
+            auto start = std::chrono::steady_clock::now();
+            tokens = stage();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+            allocations = heapAllocations - heapBefore;
+        }
+        std::cout << "  " << std::left << std::setw(22) << label << std::right
+                  << std::setw(9) << tokens << " tokens  "
+                  << std::fixed << std::setprecision(2) << std::setw(7) << (best * 1e9 / tokens) << " ns/token  "
+                  << std::setprecision(3) << std::setw(7) << static_cast<double>(allocations) / tokens
+                  << " heap allocs/token  " << std::setprecision(2) << std::setw(6)
+                  << (input.size() / best / 1e6) << " MB/s\n";
+    };
+    
+    measure("lex", source, [&] {
+        Lexer lexer(source);
+        return lexer.getAllTokens().size();
+    });
+    measure("lex (identifiers)", identifiers, [&] {
+        Lexer lexer(identifiers);
+        size_t count = 0;
+        while (lexer.nextToken().type != TokenType::END_OF_FILE) ++count;
+        return count;
+    });
+    
+    // Streaming lex with each run scanner the CPU supports
+    Lexer::Scanner defaultScanner = Lexer::getScanner();
+    for (Lexer::Scanner scanner : {Lexer::Scanner::SCALAR, Lexer::Scanner::SSE2, Lexer::Scanner::AVX2}) {
+        if (!Lexer::setScanner(scanner)) continue;
+        measure(std::string("lex (") + Lexer::scannerName(scanner) + ")", source, [&] {
+            Lexer lexer(source);
+            size_t count = 0;
+            while (lexer.nextToken().type != TokenType::END_OF_FILE) ++count;
+            return count;
+        });
+    }
+    Lexer::setScanner(defaultScanner);
+    
+    size_t tokenCount = 0;
+    measure("lex + parse (list)", source, [&] {
+        Lexer lexer(source);
+        std::vector<Token> tokens = lexer.getAllTokens();
+        tokenCount = tokens.size();
+        Parser parser(std::move(tokens));
+        parser.parse();
+        return tokenCount;
+    });
+    measure("lex + parse (stream)", source, [&] {
+        Lexer lexer(source);
+        Parser parser(lexer);
+        parser.parse();
+        return tokenCount;
+    });
+    std::cout << "\n";
+}
+
+void benchSourceInput() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Benchmark: Time to First Token (100 MB source file)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    std::string chunk;
+    for (int k = 0; k < 1000; ++k) {
+        chunk += "let running_total_" + std::to_string(k) + " = (running_total_" + std::to_string(k) +
+                 " + " + std::to_string(k) + ") * 3 % 1000;\n";
+    }
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "bench_vm_source.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (size_t written = 0; written < (100u << 20); written += chunk.size()) out << chunk;
+    }
+    
+    // Best of 3 with the file in the page cache; the clock stops at the first token
+    auto measure = [&](const std::string& label, auto&& firstToken) {
+        double best = 1e30;
+        for (int r = 0; r < 3; ++r) {
+            auto start = std::chrono::steady_clock::now();
+            if (firstToken().type != TokenType::LET) throw std::runtime_error(label + ": wrong first token");
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        std::cout << "  " << std::left << std::setw(22) << label << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(10) << best * 1e3 << " ms\n";
+    };
+    
+    // What the drivers used to do: append line by line, then copy into the Lexer
+    measure("getline + append", [&] {
+        std::ifstream in(path);
+        std::string source;
+        std::string line;
+        while (std::getline(in, line)) {
+            source += line + "\n";
+        }
+        Lexer lexer(source);
+        return lexer.nextToken();
+    });
+    measure("bulk read", [&] {
+        std::ifstream in(path, std::ios::binary);
+        SourceBuffer source = SourceBuffer::readStream(in);
+        Lexer lexer(source);
+        return lexer.nextToken();
+    });
+    measure("mmap", [&] {
+        SourceBuffer source = SourceBuffer::mapFile(path.string());
+        Lexer lexer(source);
+        return lexer.nextToken();
+    });
+    std::filesystem::remove(path);
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "╔════════════════════════════════════════════╗\n";
+    std::cout << "║  Educational Compiler - VM Benchmarks      ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n\n";
+
+    try {
+        benchDispatch();
+        benchSuperinstructions();
+        benchTopOfStackCache();
+        benchCountedLoops();
+        benchSamplingProfiler();
+        benchCheckpoints();
+        benchTieredExecution();
+        benchRegisterVM();
+        benchVmReuse();
+        benchBatchRunner();
+        benchScheduler();
+        benchOutputSinks();
+        benchFrontEnd();
+        benchSourceInput();
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
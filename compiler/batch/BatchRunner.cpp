@@ -0,0 +1,159 @@
+#include "BatchRunner.h"
+#include "../verifier/BytecodeVerifier.h"
+#include "../codegen/CodeGenerator.h"
+#include "../optimizer/Optimizer.h"
+#include "../semantic/SemanticAnalyzer.h"
+#include "../parser/Parser.h"
+#include "../lexer/Lexer.h"
+#include "../lexer/SourceBuffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+BatchRunner::BatchRunner(unsigned workers) : workerCount(workers) {
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+bool BatchRunner::takeOwn(WorkQueue& queue, size_t& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+}
+
+bool BatchRunner::steal(WorkQueue& queue, size_t& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+void BatchRunner::run(const std::vector<BatchJob>& jobs, const std::function<void(const BatchResult&)>& onResult) {
+    steals = 0;
+    unsigned threads = static_cast<unsigned>(std::min<size_t>(workerCount, std::max<size_t>(jobs.size(), 1)));
+
+    // Contiguous shares, so neighbouring jobs (often similar sizes) spread out only when stolen
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (unsigned w = 0; w < threads; ++w) {
+        queues.push_back(std::make_unique<WorkQueue>());
+        size_t first = jobs.size() * w / threads;
+        size_t last = jobs.size() * (w + 1) / threads;
+        for (size_t i = first; i < last; ++i) queues[w]->jobs.push_back(i);
+    }
+
+    std::atomic<std::uint64_t> stolen{0};
+    auto work = [&](unsigned self) {
+        VirtualMachine vm;
+        vm.reserve(64, 64);
+        vm.setBudget(budget);
+        BufferSink sink;
+
+        size_t job;
+        for (;;) {
+            if (!takeOwn(*queues[self], job)) {
+                // Own queue is empty: scan the others once, starting at the next worker.
+                // Jobs are never added, so a full scan that finds nothing means done.
+                bool found = false;
+                for (unsigned k = 1; k < threads && !found; ++k) {
+                    found = steal(*queues[(self + k) % threads], job);
+                }
+                if (!found) return;
+                stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            BatchResult result = runOne(jobs[job], vm, sink);
+            result.index = job;
+            result.worker = self;
+            onResult(result);
+        }
+    };
+
+    // The calling thread is worker 0
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < threads; ++w) pool.emplace_back(work, w);
+    work(0);
+    for (std::thread& thread : pool) thread.join();
+    steals = stolen.load();
+}
+
+BatchResult BatchRunner::runOne(const BatchJob& job, VirtualMachine& vm, BufferSink& sink) {
+    BatchResult result;
+    result.name = job.name;
+    auto start = std::chrono::steady_clock::now();
+    auto finish = [&](const char* stage) {
+        result.stage = stage;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    };
+
+    // Files are memory-mapped and lexed in place
+    SourceBuffer source;
+    if (job.path.empty()) {
+        source = SourceBuffer(job.source);
+    } else {
+        try {
+            source = SourceBuffer::mapFile(job.path);
+        } catch (const std::exception& e) {
+            result.error = e.what();
+            return finish("io");
+        }
+    }
+
+    try {
+        Lexer lexer(source);
+        Parser parser(lexer);
+        auto program = parser.parse();
+
+        SemanticAnalyzer analyzer(program);
+        analyzer.analyze();
+        if (analyzer.hasErrors()) {
+            const SemanticError& first = analyzer.getErrors().front();
+            result.error = first.what();
+            result.line = first.line;
+            return finish("semantic");
+        }
+
+        Optimizer optimizer;
+        optimizer.optimize(program);
+        CodeGenerator codegen;
+        BytecodeProgram bytecode = codegen.generate(program);
+
+        BytecodeVerifier verifier(bytecode);
+        verifier.verify();
+        if (verifier.hasErrors()) {
+            const VerifierError& first = verifier.getErrors().front();
+            result.error = first.what();
+            result.line = bytecode.getLine(first.instruction);
+            return finish("verifier");
+        }
+
+        // Output printed before a failure is kept
+        sink.clear();
+        vm.setOutput(&sink);
+        const char* stage = "ok";
+        try {
+            vm.execute(bytecode);
+        } catch (const BudgetExceededError& e) {
+            result.error = e.what();
+            result.line = bytecode.getLine(e.pc);
+            stage = "budget";
+        } catch (const std::runtime_error& e) {
+            result.error = e.what();
+            stage = "runtime";
+        }
+        result.output = sink.str();
+        result.instructions = vm.getInstructionCount();
+        return finish(stage);
+    } catch (const ParserError& e) {
+        result.error = e.what();
+        result.line = e.line;
+        return finish("parser");
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        return finish("runtime");
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "../vm/VirtualMachine.h"
+#include "../vm/ExecutionBudget.h"
+#include "../vm/OutputSink.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One program to compile and run. With a path the worker reads the file
+// itself (so file I/O is spread over the workers too); otherwise source is used.
+struct BatchJob {
+    std::string name;
+    std::string path;
+    std::string source;
+};
+
+// Outcome of one job. stage is where it stopped: "ok", "io", "parser",
+// "semantic", "verifier", "budget" or "runtime".
+struct BatchResult {
+    size_t index = 0;                        // Position of the job in run()'s input
+    std::string name;
+    std::string stage;
+    std::string error;                       // First error message, empty on success
+    int line = 0;                            // Source line of the error, 0 if unknown
+    std::string output;                      // Printed output (also what ran before a failure)
+    std::int64_t instructions = 0;
+    double seconds = 0;                      // Wall time of the whole pipeline
+    unsigned worker = 0;
+
+    bool success() const { return stage == "ok"; }
+};
+
+// Runs the whole pipeline (lex, parse, analyze, optimize, generate, verify,
+// execute) for many programs on a work-stealing thread pool. Every worker
+// owns one VirtualMachine and one BufferSink, reused for all of its jobs;
+// the pipeline stages keep no shared state, so workers never synchronize
+// except to steal work.
+class BatchRunner {
+public:
+    // 0 workers = one per hardware thread
+    explicit BatchRunner(unsigned workers = 0);
+
+    // Limits applied to every program's execution (default: unlimited)
+    void setBudget(const ExecutionBudget& limits) { budget = limits; }
+
+    // Run all jobs and return when they are done. onResult is called from
+    // the worker threads as each job finishes (in completion order, possibly
+    // concurrently), so it must be thread-safe.
+    void run(const std::vector<BatchJob>& jobs, const std::function<void(const BatchResult&)>& onResult);
+
+    // One job through the pipeline on the caller's VM (with its budget) and sink
+    static BatchResult runOne(const BatchJob& job, VirtualMachine& vm, BufferSink& sink);
+
+    unsigned getWorkerCount() const { return workerCount; }
+
+    // Jobs taken from another worker's queue during the last run()
+    std::uint64_t getStealCount() const { return steals; }
+
+private:
+    // A worker's job indices: the owner takes from the front, thieves from the back
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    unsigned workerCount;
+    ExecutionBudget budget;
+    std::uint64_t steals = 0;
+
+    static bool takeOwn(WorkQueue& queue, size_t& job);
+    static bool steal(WorkQueue& queue, size_t& job);
+};
+
+#endif
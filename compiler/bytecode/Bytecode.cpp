@@ -2,23 +2,26 @@
 
 // Instruction constructors
 Instruction::Instruction() 
-    : opcode(OpCode::HALT), intOperand(0), strOperand("") {}
+    : opcode(OpCode::HALT), aux(0), operand(0) {}
 
 Instruction::Instruction(OpCode op) 
-    : opcode(op), intOperand(0), strOperand("") {}
+    : opcode(op), aux(0), operand(0) {}
 
-Instruction::Instruction(OpCode op, int operand) 
-    : opcode(op), intOperand(operand), strOperand("") {}
+Instruction::Instruction(OpCode op, std::int32_t operand) 
+    : opcode(op), aux(0), operand(operand) {}
 
-Instruction::Instruction(OpCode op, const std::string& operand) 
-    : opcode(op), intOperand(0), strOperand(operand) {}
+Instruction::Instruction(OpCode op, std::uint16_t aux, std::int32_t operand) 
+    : opcode(op), aux(aux), operand(operand) {}
 
 // Convert opcode to string for debugging
 std::string opcodeToString(OpCode opcode) {
     switch (opcode) {
         case OpCode::LOAD_CONST: return "LOAD_CONST";
+        case OpCode::LOAD_CONST_WIDE: return "LOAD_CONST_WIDE";
         case OpCode::LOAD_VAR:   return "LOAD_VAR";
         case OpCode::STORE_VAR:  return "STORE_VAR";
+        case OpCode::LOAD_SLOT:  return "LOAD_SLOT";
+        case OpCode::STORE_SLOT: return "STORE_SLOT";
         case OpCode::ADD:        return "ADD";
         case OpCode::SUB:        return "SUB";
         case OpCode::MUL:        return "MUL";
@@ -38,6 +41,21 @@ std::string opcodeToString(OpCode opcode) {
         case OpCode::JUMP_IF_TRUE:  return "JUMP_IF_TRUE";
         case OpCode::POP:        return "POP";
         case OpCode::DUP:        return "DUP";
+        case OpCode::INC_SLOT:        return "INC_SLOT";
+        case OpCode::SLOT_ADD_CONST:  return "SLOT_ADD_CONST";
+        case OpCode::SLOT_SUB_CONST:  return "SLOT_SUB_CONST";
+        case OpCode::SLOT_MUL_CONST:  return "SLOT_MUL_CONST";
+        case OpCode::SLOT_DIV_CONST:  return "SLOT_DIV_CONST";
+        case OpCode::SLOT_MOD_CONST:  return "SLOT_MOD_CONST";
+        case OpCode::JUMP_IF_NOT_LT:  return "JUMP_IF_NOT_LT";
+        case OpCode::JUMP_IF_NOT_GT:  return "JUMP_IF_NOT_GT";
+        case OpCode::JUMP_IF_NOT_LTE: return "JUMP_IF_NOT_LTE";
+        case OpCode::JUMP_IF_NOT_GTE: return "JUMP_IF_NOT_GTE";
+        case OpCode::JUMP_IF_NOT_EQ:  return "JUMP_IF_NOT_EQ";
+        case OpCode::JUMP_IF_NOT_NEQ: return "JUMP_IF_NOT_NEQ";
+        case OpCode::STORE_LOAD_SLOT: return "STORE_LOAD_SLOT";
+        case OpCode::FOR_PREP:        return "FOR_PREP";
+        case OpCode::FOR_LOOP:        return "FOR_LOOP";
         case OpCode::PRINT:      return "PRINT";
         case OpCode::HALT:       return "HALT";
         default:                 return "UNKNOWN";
@@ -48,16 +66,80 @@ std::string opcodeToString(OpCode opcode) {
 std::ostream& operator<<(std::ostream& os, const Instruction& instr) {
     os << opcodeToString(instr.opcode);
     
-    // Add operands if present
-    if (instr.opcode == OpCode::LOAD_CONST) {
-        os << " " << instr.intOperand;
-    } else if (instr.opcode == OpCode::LOAD_VAR || instr.opcode == OpCode::STORE_VAR) {
-        os << " \"" << instr.strOperand << "\"";
+    // Add operands if present (variable names live in BytecodeProgram)
+    if (instr.opcode == OpCode::LOAD_CONST || instr.opcode == OpCode::LOAD_CONST_WIDE ||
+        isVariableOpcode(instr.opcode)) {
+        os << " " << instr.operand;
     } else if (instr.opcode == OpCode::JUMP || 
                instr.opcode == OpCode::JUMP_IF_FALSE || 
-               instr.opcode == OpCode::JUMP_IF_TRUE) {
-        os << " " << instr.intOperand;  // Jump address
+               instr.opcode == OpCode::JUMP_IF_TRUE ||
+               isCompareBranchOpcode(instr.opcode)) {
+        os << " " << instr.operand;  // Jump address
+    } else if (isFusedSlotOpcode(instr.opcode)) {
+        os << " " << instr.aux << " " << instr.operand;  // Slot, then constant, slot or jump address
     }
     
     return os;
 }
+
+// ===== Stack Effects =====
+
+// Values popped before the instruction runs (DUP needs one it puts back)
+int stackPops(OpCode opcode) {
+    switch (opcode) {
+        case OpCode::LOAD_CONST:
+        case OpCode::LOAD_CONST_WIDE:
+        case OpCode::LOAD_VAR:
+        case OpCode::LOAD_SLOT:
+        case OpCode::INC_SLOT:
+        case OpCode::SLOT_ADD_CONST:
+        case OpCode::SLOT_SUB_CONST:
+        case OpCode::SLOT_MUL_CONST:
+        case OpCode::SLOT_DIV_CONST:
+        case OpCode::SLOT_MOD_CONST:
+        case OpCode::JUMP:
+        case OpCode::HALT:
+            return 0;
+        case OpCode::STORE_VAR:
+        case OpCode::STORE_SLOT:
+        case OpCode::NOT:
+        case OpCode::JUMP_IF_FALSE:
+        case OpCode::JUMP_IF_TRUE:
+        case OpCode::POP:
+        case OpCode::DUP:
+        case OpCode::STORE_LOAD_SLOT:
+        case OpCode::FOR_PREP:
+        case OpCode::FOR_LOOP:
+        case OpCode::PRINT:
+            return 1;
+        default:
+            return 2;  // Binary operators and fused compare-and-branch
+    }
+}
+
+// Values pushed once the instruction has run
+int stackPushes(OpCode opcode) {
+    switch (opcode) {
+        case OpCode::LOAD_CONST:
+        case OpCode::LOAD_CONST_WIDE:
+        case OpCode::LOAD_VAR:
+        case OpCode::LOAD_SLOT:
+        case OpCode::SLOT_ADD_CONST:
+        case OpCode::SLOT_SUB_CONST:
+        case OpCode::SLOT_MUL_CONST:
+        case OpCode::SLOT_DIV_CONST:
+        case OpCode::SLOT_MOD_CONST:
+        case OpCode::STORE_LOAD_SLOT:
+        case OpCode::FOR_PREP:   // Leave the loop limit where it was
+        case OpCode::FOR_LOOP:
+        case OpCode::ADD: case OpCode::SUB: case OpCode::MUL: case OpCode::DIV: case OpCode::MOD:
+        case OpCode::CMP_LT: case OpCode::CMP_GT: case OpCode::CMP_LTE:
+        case OpCode::CMP_GTE: case OpCode::CMP_EQ: case OpCode::CMP_NEQ:
+        case OpCode::AND: case OpCode::OR: case OpCode::NOT:
+            return 1;
+        case OpCode::DUP:
+            return 2;
+        default:
+            return 0;
+    }
+}
@@ -3,13 +3,17 @@
 
 #include <string>
 #include <iostream>
+#include <cstdint>
 
-// Opcode enumeration for all VM instructions
-enum class OpCode {
+// Opcode enumeration for all VM instructions (one byte each)
+enum class OpCode : std::uint8_t {
     // Literal and variable operations
     LOAD_CONST,    // Push constant to stack
+    LOAD_CONST_WIDE, // Push constant pool entry operand (values outside 32 bits)
     LOAD_VAR,      // Push variable value to stack
     STORE_VAR,     // Pop from stack and store in variable
+    LOAD_SLOT,     // Push value of variable slot (resolved at compile time)
+    STORE_SLOT,    // Pop from stack and store in variable slot
     
     // Arithmetic operations
     ADD,           // Pop two values, push sum
@@ -40,30 +44,83 @@ enum class OpCode {
     POP,           // Pop and discard top of stack
     DUP,           // Duplicate top of stack
     
+    // Superinstructions (fused sequences, see CodeGenerator::setSuperinstructions)
+    INC_SLOT,         // slot[aux] += operand              (LOAD_SLOT; LOAD_CONST; ADD/SUB; STORE_SLOT)
+    SLOT_ADD_CONST,   // Push slot[aux] + operand          (LOAD_SLOT; LOAD_CONST; ADD)
+    SLOT_SUB_CONST,   // Push slot[aux] - operand          (LOAD_SLOT; LOAD_CONST; SUB)
+    SLOT_MUL_CONST,   // Push slot[aux] * operand          (LOAD_SLOT; LOAD_CONST; MUL)
+    SLOT_DIV_CONST,   // Push slot[aux] / operand, operand != 0, -1
+    SLOT_MOD_CONST,   // Push slot[aux] % operand, operand != 0, -1
+    JUMP_IF_NOT_LT,   // Pop two values, jump to operand unless (a < b)   (CMP_LT; JUMP_IF_FALSE)
+    JUMP_IF_NOT_GT,   // Pop two values, jump to operand unless (a > b)
+    JUMP_IF_NOT_LTE,  // Pop two values, jump to operand unless (a <= b)
+    JUMP_IF_NOT_GTE,  // Pop two values, jump to operand unless (a >= b)
+    JUMP_IF_NOT_EQ,   // Pop two values, jump to operand unless (a == b)
+    JUMP_IF_NOT_NEQ,  // Pop two values, jump to operand unless (a != b)
+    STORE_LOAD_SLOT,  // Pop into slot[aux], then push slot[operand]  (STORE_SLOT; LOAD_SLOT)
+    
+    // Counted loops (see CodeGenerator::generateForStatement); the limit stays on top of the stack
+    FOR_PREP,         // Jump to operand unless slot[aux] <= limit
+    FOR_LOOP,         // slot[aux] += 1, jump to operand if slot[aux] <= limit
+    
     // I/O operations
     PRINT,         // Pop and print value
-    HALT           // Stop execution
+    HALT           // Stop execution (keep last: dispatch tables are sized by it)
 };
 
-// Single bytecode instruction
+// Single bytecode instruction, packed into 8 bytes:
+// an opcode byte plus a 32-bit operand. Variable names are not stored
+// inline; the operand of a variable instruction indexes the name (slot)
+// table of the owning BytecodeProgram. Superinstructions keep their
+// slot in the otherwise unused padding (aux).
 struct Instruction {
     OpCode opcode;
-    int intOperand;           // For LOAD_CONST
-    std::string strOperand;   // For LOAD_VAR, STORE_VAR
+    std::uint16_t aux;        // Slot index for superinstructions
+    std::int32_t operand;     // Constant value, constant pool index, jump address or slot index
     
     // Constructor for instructions without operands
     explicit Instruction(OpCode op);
     
-    // Constructor for instructions with integer operand
-    Instruction(OpCode op, int operand);
+    // Constructor for instructions with an operand
+    Instruction(OpCode op, std::int32_t operand);
     
-    // Constructor for instructions with string operand
-    Instruction(OpCode op, const std::string& operand);
+    // Constructor for superinstructions (slot + operand)
+    Instruction(OpCode op, std::uint16_t aux, std::int32_t operand);
     
     // Default constructor
     Instruction();
 };
 
+static_assert(sizeof(Instruction) <= 8, "Instruction must stay a compact fixed-width encoding");
+
+// Does this opcode's operand index the program's name (slot) table?
+inline bool isVariableOpcode(OpCode opcode) {
+    return opcode == OpCode::LOAD_VAR || opcode == OpCode::STORE_VAR ||
+           opcode == OpCode::LOAD_SLOT || opcode == OpCode::STORE_SLOT;
+}
+
+// Is this a superinstruction whose aux field holds a slot index?
+inline bool isFusedSlotOpcode(OpCode opcode) {
+    return opcode == OpCode::INC_SLOT ||
+           (opcode >= OpCode::SLOT_ADD_CONST && opcode <= OpCode::SLOT_MOD_CONST) ||
+           opcode == OpCode::STORE_LOAD_SLOT ||
+           opcode == OpCode::FOR_PREP || opcode == OpCode::FOR_LOOP;
+}
+
+// Is this a counted-loop branch (slot in aux, jump address in operand)?
+inline bool isForLoopOpcode(OpCode opcode) {
+    return opcode == OpCode::FOR_PREP || opcode == OpCode::FOR_LOOP;
+}
+
+// Is this a fused compare-and-branch?
+inline bool isCompareBranchOpcode(OpCode opcode) {
+    return opcode >= OpCode::JUMP_IF_NOT_LT && opcode <= OpCode::JUMP_IF_NOT_NEQ;
+}
+
+// Stack effect of an instruction: values it pops, then values it pushes
+int stackPops(OpCode opcode);
+int stackPushes(OpCode opcode);
+
 // Helper functions
 std::string opcodeToString(OpCode opcode);
 std::ostream& operator<<(std::ostream& os, const Instruction& instr);
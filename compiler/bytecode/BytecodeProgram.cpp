@@ -1,21 +1,39 @@
 #include "BytecodeProgram.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 
 void BytecodeProgram::addInstruction(const Instruction& instr) {
     instructions.push_back(instr);
+    lines.push_back(currentLine);
+    resetVerification();
 }
 
 void BytecodeProgram::emit(OpCode opcode) {
     instructions.emplace_back(opcode);
+    lines.push_back(currentLine);
+    resetVerification();
 }
 
 void BytecodeProgram::emit(OpCode opcode, int operand) {
     instructions.emplace_back(opcode, operand);
+    lines.push_back(currentLine);
+    resetVerification();
 }
 
 void BytecodeProgram::emit(OpCode opcode, const std::string& operand) {
-    instructions.emplace_back(opcode, operand);
+    // Names are interned in the slot table; the instruction only keeps the index
+    instructions.emplace_back(opcode, declareSlot(operand));
+    lines.push_back(currentLine);
+    resetVerification();
+}
+
+void BytecodeProgram::emitConstant(Value value) {
+    if (fitsInt32(value)) {
+        emit(OpCode::LOAD_CONST, static_cast<int>(value));
+    } else {
+        emit(OpCode::LOAD_CONST_WIDE, addConstant(value));
+    }
 }
 
 const std::vector<Instruction>& BytecodeProgram::getInstructions() const {
@@ -35,7 +53,21 @@ void BytecodeProgram::print() const {
     std::cout << "----------------------------------------\n";
     
     for (size_t i = 0; i < instructions.size(); ++i) {
-        std::cout << std::setw(4) << i << ": " << instructions[i] << "\n";
+        std::cout << std::setw(4) << i << ": " << instructions[i];
+        
+        // Show the variable name behind slot-indexed instructions
+        const Instruction& instr = instructions[i];
+        if (isVariableOpcode(instr.opcode)) {
+            std::cout << " (" << getSlotName(instr.operand) << ")";
+        } else if (instr.opcode == OpCode::LOAD_CONST_WIDE && instr.operand >= 0 &&
+                   static_cast<size_t>(instr.operand) < constants.size()) {
+            std::cout << " (" << getConstant(instr.operand) << ")";
+        } else if (instr.opcode == OpCode::STORE_LOAD_SLOT) {
+            std::cout << " (" << getSlotName(instr.aux) << ", " << getSlotName(instr.operand) << ")";
+        } else if (isFusedSlotOpcode(instr.opcode)) {
+            std::cout << " (" << getSlotName(instr.aux) << ")";
+        }
+        std::cout << "\n";
     }
     
     std::cout << "----------------------------------------\n";
@@ -43,10 +75,62 @@ void BytecodeProgram::print() const {
 
 void BytecodeProgram::patchInstruction(size_t index, int operand) {
     if (index < instructions.size()) {
-        instructions[index].intOperand = operand;
+        instructions[index].operand = operand;
+        resetVerification();
     }
 }
 
+void BytecodeProgram::setInstructions(std::vector<Instruction> newInstructions, std::vector<int> newLines) {
+    instructions = std::move(newInstructions);
+    lines = std::move(newLines);
+    lines.resize(instructions.size(), 0);
+    resetVerification();
+}
+
 void BytecodeProgram::clear() {
     instructions.clear();
+    lines.clear();
+    currentLine = 0;
+    slotNames.clear();
+    slotIndex.clear();
+    constants.clear();
+    resetVerification();
+}
+
+void BytecodeProgram::resetVerification() {
+    verifiedStackDepth = -1;
+    verifiedEntryDepths.clear();
+}
+
+int BytecodeProgram::declareSlot(const std::string& name) {
+    auto it = slotIndex.find(name);
+    if (it != slotIndex.end()) {
+        return it->second;
+    }
+    
+    int slot = static_cast<int>(slotNames.size());
+    slotNames.push_back(name);
+    slotIndex[name] = slot;
+    return slot;
+}
+
+int BytecodeProgram::addConstant(Value value) {
+    auto it = std::find(constants.begin(), constants.end(), value);
+    if (it != constants.end()) {
+        return static_cast<int>(it - constants.begin());
+    }
+    constants.push_back(value);
+    return static_cast<int>(constants.size()) - 1;
+}
+
+int BytecodeProgram::getSlotCount() const {
+    return static_cast<int>(slotNames.size());
+}
+
+const std::string& BytecodeProgram::getSlotName(int slot) const {
+    return slotNames.at(slot);
+}
+
+const std::vector<std::string>& BytecodeProgram::getSlotNames() const {
+    return slotNames;
 }
@@ -2,7 +2,10 @@
 #define BYTECODE_PROGRAM_H
 
 #include "Bytecode.h"
+#include "Value.h"
 #include <vector>
+#include <string>
+#include <unordered_map>
 
 class BytecodeProgram {
 public:
@@ -16,6 +19,10 @@ public:
     void emit(OpCode opcode, int operand);
     void emit(OpCode opcode, const std::string& operand);
     
+    // Push a constant: LOAD_CONST when it fits the operand, otherwise
+    // LOAD_CONST_WIDE with a constant pool entry
+    void emitConstant(Value value);
+    
     // Access instructions
     const std::vector<Instruction>& getInstructions() const;
     const Instruction& operator[](size_t index) const;
@@ -27,11 +34,53 @@ public:
     // Modify an instruction's operand (for backpatching jumps)
     void patchInstruction(size_t index, int operand);
     
+    // Replace the whole instruction stream (for bytecode-level passes); keeps the slot
+    // table. newLines gives the source line of each new instruction (empty = unknown).
+    void setInstructions(std::vector<Instruction> newInstructions, std::vector<int> newLines = {});
+    
     // Clear all instructions
     void clear();
     
+    // Variable slots: each variable name gets a dense index at compile time
+    int declareSlot(const std::string& name);   // Returns existing slot if already declared
+    int getSlotCount() const;
+    const std::string& getSlotName(int slot) const;
+    const std::vector<std::string>& getSlotNames() const;
+    
+    // Constant pool for values that do not fit an instruction operand
+    int addConstant(Value value);               // Returns existing index if already pooled
+    Value getConstant(int index) const { return constants.at(index); }
+    const std::vector<Value>& getConstants() const { return constants; }
+    void setConstants(std::vector<Value> pool) { constants = std::move(pool); }
+    
+    // Line table: emitted instructions are tagged with the current source line
+    void setCurrentLine(int line) { currentLine = line; }
+    int getCurrentLine() const { return currentLine; }
+    int getLine(size_t index) const { return index < lines.size() ? lines[index] : 0; }
+    const std::vector<int>& getLines() const { return lines; }
+    
+    // Verification result: maximum stack depth proven by BytecodeVerifier,
+    // or -1 if the program is unverified, and the stack depth on entry to
+    // each instruction (-1 if unknown). Any modification resets both.
+    bool isVerified() const { return verifiedStackDepth >= 0; }
+    int getVerifiedStackDepth() const { return verifiedStackDepth; }
+    void setVerifiedStackDepth(int depth) { verifiedStackDepth = depth; }
+    int getVerifiedEntryDepth(size_t index) const {
+        return index < verifiedEntryDepths.size() ? verifiedEntryDepths[index] : -1;
+    }
+    void setVerifiedEntryDepths(std::vector<int> depths) { verifiedEntryDepths = std::move(depths); }
+    
 private:
     std::vector<Instruction> instructions;
+    std::vector<int> lines;                             // Instruction index -> source line (0 = none)
+    int currentLine = 0;
+    std::vector<std::string> slotNames;                 // Slot index -> variable name
+    std::unordered_map<std::string, int> slotIndex;     // Variable name -> slot index
+    std::vector<Value> constants;                       // LOAD_CONST_WIDE operand -> value
+    int verifiedStackDepth = -1;
+    std::vector<int> verifiedEntryDepths;               // Instruction index -> stack depth
+    
+    void resetVerification();
 };
 
 #endif
@@ -0,0 +1,167 @@
+#include "RegisterProgram.h"
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+
+std::string regOpcodeToString(RegOpCode opcode) {
+    switch (opcode) {
+        case RegOpCode::LOADI:           return "LOADI";
+        case RegOpCode::LOADK:           return "LOADK";
+        case RegOpCode::MOVE:            return "MOVE";
+        case RegOpCode::ADD:             return "ADD";
+        case RegOpCode::SUB:             return "SUB";
+        case RegOpCode::MUL:             return "MUL";
+        case RegOpCode::DIV:             return "DIV";
+        case RegOpCode::MOD:             return "MOD";
+        case RegOpCode::ADDI:            return "ADDI";
+        case RegOpCode::SUBI:            return "SUBI";
+        case RegOpCode::MULI:            return "MULI";
+        case RegOpCode::DIVI:            return "DIVI";
+        case RegOpCode::MODI:            return "MODI";
+        case RegOpCode::LT:              return "LT";
+        case RegOpCode::GT:              return "GT";
+        case RegOpCode::LTE:             return "LTE";
+        case RegOpCode::GTE:             return "GTE";
+        case RegOpCode::EQ:              return "EQ";
+        case RegOpCode::NEQ:             return "NEQ";
+        case RegOpCode::AND:             return "AND";
+        case RegOpCode::OR:              return "OR";
+        case RegOpCode::NOT:             return "NOT";
+        case RegOpCode::JUMP:            return "JUMP";
+        case RegOpCode::JUMP_IF_FALSE:   return "JUMP_IF_FALSE";
+        case RegOpCode::JUMP_IF_TRUE:    return "JUMP_IF_TRUE";
+        case RegOpCode::JUMP_IF_NOT_LT:  return "JUMP_IF_NOT_LT";
+        case RegOpCode::JUMP_IF_NOT_GT:  return "JUMP_IF_NOT_GT";
+        case RegOpCode::JUMP_IF_NOT_LTE: return "JUMP_IF_NOT_LTE";
+        case RegOpCode::JUMP_IF_NOT_GTE: return "JUMP_IF_NOT_GTE";
+        case RegOpCode::JUMP_IF_NOT_EQ:  return "JUMP_IF_NOT_EQ";
+        case RegOpCode::JUMP_IF_NOT_NEQ: return "JUMP_IF_NOT_NEQ";
+        case RegOpCode::PRINT:           return "PRINT";
+        case RegOpCode::HALT:            return "HALT";
+        default:                         return "UNKNOWN";
+    }
+}
+
+unsigned regOperands(RegOpCode opcode) {
+    switch (opcode) {
+        case RegOpCode::LOADI:
+        case RegOpCode::LOADK:
+        case RegOpCode::JUMP_IF_FALSE:
+        case RegOpCode::JUMP_IF_TRUE:
+            return REG_A | REG_IMM;
+        case RegOpCode::MOVE:
+        case RegOpCode::NOT:
+            return REG_A | REG_B;
+        case RegOpCode::ADDI:
+        case RegOpCode::SUBI:
+        case RegOpCode::MULI:
+        case RegOpCode::DIVI:
+        case RegOpCode::MODI:
+            return REG_A | REG_B | REG_IMM;
+        case RegOpCode::JUMP:
+            return REG_IMM;
+        case RegOpCode::JUMP_IF_NOT_LT:
+        case RegOpCode::JUMP_IF_NOT_GT:
+        case RegOpCode::JUMP_IF_NOT_LTE:
+        case RegOpCode::JUMP_IF_NOT_GTE:
+        case RegOpCode::JUMP_IF_NOT_EQ:
+        case RegOpCode::JUMP_IF_NOT_NEQ:
+            return REG_B | REG_C | REG_IMM;
+        case RegOpCode::PRINT:
+            return REG_A;
+        case RegOpCode::HALT:
+            return 0;
+        default:
+            return REG_A | REG_B | REG_C;   // Three-register arithmetic, comparison, logic
+    }
+}
+
+// Print instruction as "OP rA, rB, rC" / "OP rA, rB, imm"
+std::ostream& operator<<(std::ostream& os, const RegInstruction& instr) {
+    os << regOpcodeToString(instr.opcode);
+    
+    unsigned used = regOperands(instr.opcode);
+    const char* separator = " ";
+    if (used & REG_A) { os << separator << "r" << instr.a; separator = ", "; }
+    if (used & REG_B) { os << separator << "r" << instr.b; separator = ", "; }
+    if (used & REG_C) { os << separator << "r" << instr.c; separator = ", "; }
+    if (used & REG_IMM) { os << separator << instr.imm; }
+    
+    return os;
+}
+
+int RegisterProgram::emit(const RegInstruction& instr) {
+    instructions.push_back(instr);
+    lines.push_back(currentLine);
+    return static_cast<int>(instructions.size()) - 1;
+}
+
+void RegisterProgram::patchTarget(size_t index, int target) {
+    if (index < instructions.size()) {
+        instructions[index].imm = target;
+    }
+}
+
+void RegisterProgram::clear() {
+    instructions.clear();
+    lines.clear();
+    currentLine = 0;
+    slotNames.clear();
+    slotIndex.clear();
+    constants.clear();
+    registerCount = 0;
+}
+
+int RegisterProgram::declareSlot(const std::string& name) {
+    auto it = slotIndex.find(name);
+    if (it != slotIndex.end()) {
+        return it->second;
+    }
+    
+    int slot = static_cast<int>(slotNames.size());
+    slotNames.push_back(name);
+    slotIndex[name] = slot;
+    return slot;
+}
+
+int RegisterProgram::addConstant(Value value) {
+    auto it = std::find(constants.begin(), constants.end(), value);
+    if (it != constants.end()) {
+        return static_cast<int>(it - constants.begin());
+    }
+    constants.push_back(value);
+    return static_cast<int>(constants.size()) - 1;
+}
+
+std::string RegisterProgram::registerName(int reg) const {
+    if (reg < getSlotCount()) {
+        return slotNames[reg];
+    }
+    return "t" + std::to_string(reg - getSlotCount());
+}
+
+void RegisterProgram::print() const {
+    std::cout << "Register Program (" << instructions.size() << " instructions, "
+              << registerCount << " registers):\n";
+    std::cout << "----------------------------------------\n";
+    
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        const RegInstruction& instr = instructions[i];
+        std::ostringstream text;
+        text << instr;
+        std::cout << std::setw(4) << i << ": " << std::left << std::setw(28) << text.str() << std::right;
+        
+        // Show the variable (or temporary) behind each register operand
+        unsigned used = regOperands(instr.opcode);
+        std::string names;
+        if (used & REG_A) names += registerName(instr.a);
+        if (used & REG_B) names += (names.empty() ? "" : ", ") + registerName(instr.b);
+        if (used & REG_C) names += (names.empty() ? "" : ", ") + registerName(instr.c);
+        if (instr.opcode == RegOpCode::LOADK && instr.imm >= 0 &&
+            static_cast<size_t>(instr.imm) < constants.size()) names += " = " + std::to_string(constants[instr.imm]);
+        if (!names.empty()) std::cout << " (" << names << ")";
+        std::cout << "\n";
+    }
+    
+    std::cout << "----------------------------------------\n";
+}
@@ -0,0 +1,148 @@
+#ifndef REGISTER_PROGRAM_H
+#define REGISTER_PROGRAM_H
+
+#include "Value.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <iostream>
+#include <cstdint>
+
+// Opcodes of the register-based bytecode (see RegisterVM). Operands name
+// registers r[a], r[b], r[c] directly, so an expression like x + y * 2
+// needs no loads or stores: MULI t, y, 2; ADD x, x, t.
+enum class RegOpCode : std::uint8_t {
+    LOADI,            // r[a] = imm
+    LOADK,            // r[a] = constant pool entry imm (values outside 32 bits)
+    MOVE,             // r[a] = r[b]
+
+    // Arithmetic: r[a] = r[b] op r[c]
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+
+    // Arithmetic with a constant: r[a] = r[b] op imm (DIVI/MODI only with imm != 0, -1)
+    ADDI,
+    SUBI,
+    MULI,
+    DIVI,
+    MODI,
+
+    // Comparisons and logic: r[a] = (r[b] op r[c]) ? 1 : 0
+    LT,
+    GT,
+    LTE,
+    GTE,
+    EQ,
+    NEQ,
+    AND,
+    OR,
+    NOT,              // r[a] = !r[b]
+
+    // Control flow (imm = target instruction)
+    JUMP,             // Jump to imm
+    JUMP_IF_FALSE,    // Jump to imm if r[a] == 0
+    JUMP_IF_TRUE,     // Jump to imm if r[a] != 0
+    JUMP_IF_NOT_LT,   // Jump to imm unless r[b] < r[c]
+    JUMP_IF_NOT_GT,
+    JUMP_IF_NOT_LTE,
+    JUMP_IF_NOT_GTE,
+    JUMP_IF_NOT_EQ,
+    JUMP_IF_NOT_NEQ,
+
+    PRINT,            // Print r[a]
+    HALT              // Stop execution (keep last: dispatch tables are sized by it)
+};
+
+// Three-address instruction: every operand form fits in one fixed-width
+// record, so the interpreter decodes with plain field loads
+struct RegInstruction {
+    RegOpCode opcode;
+    std::uint16_t a;          // Destination, or the tested/printed register
+    std::uint16_t b;          // First source
+    std::uint16_t c;          // Second source
+    std::int32_t imm;         // Constant, constant pool index or jump target
+
+    RegInstruction() : opcode(RegOpCode::HALT), a(0), b(0), c(0), imm(0) {}
+    RegInstruction(RegOpCode op, int a, int b, int c, std::int32_t imm = 0)
+        : opcode(op), a(static_cast<std::uint16_t>(a)), b(static_cast<std::uint16_t>(b)),
+          c(static_cast<std::uint16_t>(c)), imm(imm) {}
+};
+
+static_assert(sizeof(RegInstruction) <= 12, "RegInstruction must stay a compact fixed-width encoding");
+
+// Register indices are 16-bit
+const int MAX_REGISTERS = 0xFFFF;
+
+inline bool isRegJumpOpcode(RegOpCode opcode) {
+    return opcode >= RegOpCode::JUMP && opcode <= RegOpCode::JUMP_IF_NOT_NEQ;
+}
+
+// Which fields an opcode uses (bit flags)
+enum RegOperand : unsigned {
+    REG_A = 1 << 0,
+    REG_B = 1 << 1,
+    REG_C = 1 << 2,
+    REG_IMM = 1 << 3
+};
+unsigned regOperands(RegOpCode opcode);
+
+std::string regOpcodeToString(RegOpCode opcode);
+std::ostream& operator<<(std::ostream& os, const RegInstruction& instr);
+
+// Register bytecode for one program. Registers 0..getSlotCount()-1 hold the
+// program's variables (one per name, like BytecodeProgram slots); the rest
+// are temporaries for intermediate values.
+class RegisterProgram {
+public:
+    RegisterProgram() = default;
+
+    // Append an instruction; returns its index (for backpatching)
+    int emit(const RegInstruction& instr);
+    void patchTarget(size_t index, int target);
+
+    const std::vector<RegInstruction>& getInstructions() const { return instructions; }
+    const RegInstruction& operator[](size_t index) const { return instructions[index]; }
+    size_t size() const { return instructions.size(); }
+
+    void clear();
+
+    // Variables: each name gets a dense register index at compile time
+    int declareSlot(const std::string& name);   // Returns existing register if already declared
+    int getSlotCount() const { return static_cast<int>(slotNames.size()); }
+    const std::string& getSlotName(int slot) const { return slotNames[slot]; }
+    const std::vector<std::string>& getSlotNames() const { return slotNames; }
+
+    // Constant pool for LOADK, as in BytecodeProgram
+    int addConstant(Value value);               // Returns existing index if already pooled
+    Value getConstant(int index) const { return constants.at(index); }
+    const std::vector<Value>& getConstants() const { return constants; }
+
+    // Registers the program needs (variables plus temporaries)
+    void setRegisterCount(int count) { registerCount = count; }
+    int getRegisterCount() const { return registerCount; }
+
+    // Line table, as in BytecodeProgram
+    void setCurrentLine(int line) { currentLine = line; }
+    int getCurrentLine() const { return currentLine; }
+    int getLine(size_t index) const { return index < lines.size() ? lines[index] : 0; }
+
+    // Name of a register for listings: the variable name, or "t<n>" for temporaries
+    std::string registerName(int reg) const;
+
+    // Pretty-print bytecode
+    void print() const;
+
+private:
+    std::vector<RegInstruction> instructions;
+    std::vector<int> lines;
+    int currentLine = 0;
+    std::vector<std::string> slotNames;
+    std::unordered_map<std::string, int> slotIndex;
+    std::vector<Value> constants;
+    int registerCount = 0;
+};
+
+#endif
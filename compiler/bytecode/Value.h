@@ -0,0 +1,63 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+// Runtime value of the language: a 64-bit signed integer. Arithmetic that
+// leaves its range is a runtime error (never wraps), and the optimizer, both
+// VMs and the JIT all check it the same way.
+using Value = std::int64_t;
+
+const Value VALUE_MIN = std::numeric_limits<Value>::min();
+const Value VALUE_MAX = std::numeric_limits<Value>::max();
+
+// Whether a value fits an instruction's 32-bit immediate operand
+inline bool fitsInt32(Value value) { return value >= INT32_MIN && value <= INT32_MAX; }
+
+// Message of the runtime error raised on overflow
+const char* const OVERFLOW_ERROR = "Runtime error: Integer overflow";
+
+// Checked arithmetic: each returns true if the exact result does not fit in
+// a Value (out is then unspecified). GCC/Clang compile these to the plain
+// instruction plus one jump on the overflow flag.
+#if defined(__GNUC__) || defined(__clang__)
+inline bool addOverflows(Value a, Value b, Value& out) { return __builtin_add_overflow(a, b, &out); }
+inline bool subOverflows(Value a, Value b, Value& out) { return __builtin_sub_overflow(a, b, &out); }
+inline bool mulOverflows(Value a, Value b, Value& out) { return __builtin_mul_overflow(a, b, &out); }
+#else
+inline bool addOverflows(Value a, Value b, Value& out) {
+    if ((b > 0 && a > VALUE_MAX - b) || (b < 0 && a < VALUE_MIN - b)) return true;
+    out = a + b;
+    return false;
+}
+inline bool subOverflows(Value a, Value b, Value& out) {
+    if ((b < 0 && a > VALUE_MAX + b) || (b > 0 && a < VALUE_MIN + b)) return true;
+    out = a - b;
+    return false;
+}
+inline bool mulOverflows(Value a, Value b, Value& out) {
+    if (a != 0 && b != 0) {
+        if (a == -1) return b == VALUE_MIN ? true : (out = -b, false);
+        if (b == -1) return a == VALUE_MIN ? true : (out = -a, false);
+        if (a > 0 ? (b > 0 ? a > VALUE_MAX / b : b < VALUE_MIN / a)
+                  : (b > 0 ? a < VALUE_MIN / b : b < VALUE_MAX / a)) {
+            return true;
+        }
+    }
+    out = a * b;
+    return false;
+}
+#endif
+
+// Division overflows only for VALUE_MIN / -1 (b must be non-zero). The
+// remainder of that division is 0, so checkedRemainder() never overflows.
+inline bool divOverflows(Value a, Value b, Value& out) {
+    if (b == -1 && a == VALUE_MIN) return true;
+    out = a / b;
+    return false;
+}
+inline Value checkedRemainder(Value a, Value b) { return b == -1 ? 0 : a % b; }
+
+#endif
@@ -1,7 +1,24 @@
 #include "CodeGenerator.h"
+#include <climits>
+#include <set>
+
+// Fusions applied by one superinstruction pass, per family
+struct FusionTally {
+    int increments = 0;
+    int compareBranches = 0;
+    int slotConstArith = 0;
+    int storeLoads = 0;
+};
+
+static FusionTally fuse(BytecodeProgram& bytecode, unsigned superinstructions,
+                        std::vector<int>* indexMap = nullptr);
 
 BytecodeProgram CodeGenerator::generate(const std::vector<std::unique_ptr<Statement>>& program) {
     bytecode.clear();
+    fusedIncrements = 0;
+    fusedCompareBranches = 0;
+    fusedSlotConstArith = 0;
+    fusedStoreLoads = 0;
     
     // Generate code for each statement
     for (const auto& stmt : program) {
@@ -11,10 +28,24 @@ BytecodeProgram CodeGenerator::generate(const std::vector<std::unique_ptr<Statem
     // Add HALT instruction at the end
     bytecode.emit(OpCode::HALT);
     
-    return bytecode;
+    if (superinstructions != FUSE_NONE) {
+        FusionTally tally = fuse(bytecode, superinstructions);
+        fusedIncrements = tally.increments;
+        fusedCompareBranches = tally.compareBranches;
+        fusedSlotConstArith = tally.slotConstArith;
+        fusedStoreLoads = tally.storeLoads;
+    }
+    
+    // Hand the program over instead of copying it (clear() resets the member next time)
+    return std::move(bytecode);
 }
 
 void CodeGenerator::generateStatement(Statement* stmt) {
+    // Tag this statement's code with its line; loop/branch code emitted after
+    // a nested body goes back to the enclosing statement's line
+    int outerLine = bytecode.getCurrentLine();
+    bytecode.setCurrentLine(stmt->startLine);
+    
     if (auto* letStmt = dynamic_cast<LetStatement*>(stmt)) {
         generateLetStatement(letStmt);
     } else if (auto* printStmt = dynamic_cast<PrintStatement*>(stmt)) {
@@ -24,14 +55,16 @@ void CodeGenerator::generateStatement(Statement* stmt) {
     } else if (auto* forStmt = dynamic_cast<ForStatement*>(stmt)) {
         generateForStatement(forStmt);
     }
+    
+    bytecode.setCurrentLine(outerLine);
 }
 
 void CodeGenerator::generateLetStatement(LetStatement* stmt) {
     // Generate code to evaluate the expression (result pushed to stack)
     generateExpression(stmt->expression.get());
     
-    // Store the value from stack into the variable
-    bytecode.emit(OpCode::STORE_VAR, stmt->identifier);
+    // Store the value from stack into the variable's slot
+    bytecode.emit(OpCode::STORE_SLOT, bytecode.declareSlot(stmt->identifier));
 }
 
 void CodeGenerator::generatePrintStatement(PrintStatement* stmt) {
@@ -59,13 +92,13 @@ void CodeGenerator::generateExpression(Expression* expr) {
 }
 
 void CodeGenerator::generateIntegerLiteral(IntegerLiteral* expr) {
-    // Push constant value onto stack
-    bytecode.emit(OpCode::LOAD_CONST, expr->value);
+    // Push constant value onto stack (from the constant pool if it needs 64 bits)
+    bytecode.emitConstant(expr->value);
 }
 
 void CodeGenerator::generateVariable(Variable* expr) {
-    // Push variable value onto stack
-    bytecode.emit(OpCode::LOAD_VAR, expr->name);
+    // Push variable value onto stack (slot resolved at compile time)
+    bytecode.emit(OpCode::LOAD_SLOT, bytecode.declareSlot(expr->name));
 }
 
 void CodeGenerator::generateBinaryOperation(BinaryOperation* expr) {
@@ -180,34 +213,114 @@ void CodeGenerator::generateIfStatement(IfStatement* stmt) {
     }
 }
 
+// Superinstructions keep their slot in a 16-bit field
+static bool fitsAux(int slot) {
+    return slot >= 0 && slot <= 0xFFFF;
+}
+
+// Names read by an expression
+static void collectReads(Expression* expr, std::set<std::string>& names) {
+    if (auto* var = dynamic_cast<Variable*>(expr)) {
+        names.insert(var->name);
+    } else if (auto* binOp = dynamic_cast<BinaryOperation*>(expr)) {
+        collectReads(binOp->left.get(), names);
+        collectReads(binOp->right.get(), names);
+    } else if (auto* compExpr = dynamic_cast<ComparisonExpression*>(expr)) {
+        collectReads(compExpr->left.get(), names);
+        collectReads(compExpr->right.get(), names);
+    } else if (auto* logicExpr = dynamic_cast<LogicalExpression*>(expr)) {
+        collectReads(logicExpr->left.get(), names);
+        collectReads(logicExpr->right.get(), names);
+    } else if (auto* unaryExpr = dynamic_cast<UnaryExpression*>(expr)) {
+        collectReads(unaryExpr->operand.get(), names);
+    }
+}
+
+// Names a statement may store to (let targets and loop variables, nested bodies included)
+static void collectStores(Statement* stmt, std::set<std::string>& names) {
+    if (auto* letStmt = dynamic_cast<LetStatement*>(stmt)) {
+        names.insert(letStmt->identifier);
+    } else if (auto* ifStmt = dynamic_cast<IfStatement*>(stmt)) {
+        for (const auto& s : ifStmt->thenBlock) collectStores(s.get(), names);
+        for (const auto& s : ifStmt->elseBlock) collectStores(s.get(), names);
+    } else if (auto* forStmt = dynamic_cast<ForStatement*>(stmt)) {
+        names.insert(forStmt->variable);
+        for (const auto& s : forStmt->body) collectStores(s.get(), names);
+    }
+}
+
+// The bound can be evaluated once if nothing the loop stores changes its value
+static bool hasInvariantBound(ForStatement* stmt) {
+    std::set<std::string> reads;
+    collectReads(stmt->end.get(), reads);
+    if (reads.empty()) return true;
+    
+    std::set<std::string> stores{stmt->variable};
+    for (const auto& s : stmt->body) collectStores(s.get(), stores);
+    for (const auto& name : reads) {
+        if (stores.count(name)) return false;
+    }
+    return true;
+}
+
 // NEW: Generate for loop
 void CodeGenerator::generateForStatement(ForStatement* stmt) {
     // for var = start to end { body }
-    // Bytecode pattern:
+    // With a loop-invariant end the bound is evaluated once and kept on the
+    // stack for the whole loop; increment, test and branch are one dispatch:
     //   <start code>
-    //   STORE_VAR var
+    //   STORE_SLOT var
+    //   <end code>                (limit)
+    //   FOR_PREP var, loop_exit   (skip the loop if var > limit)
+    // loop_body:
+    //   <body code>
+    //   FOR_LOOP var, loop_body   (var += 1; repeat while var <= limit)
+    // loop_exit:
+    //   POP                       (drop the limit)
+    //
+    // Otherwise end is re-evaluated before every iteration:
+    //   <start code>
+    //   STORE_SLOT var
     // loop_start:
-    //   LOAD_VAR var
+    //   LOAD_SLOT var
     //   <end code>
     //   CMP_LTE
     //   JUMP_IF_FALSE loop_end
     //   <body code>
-    //   LOAD_VAR var
+    //   LOAD_SLOT var
     //   LOAD_CONST 1
     //   ADD
-    //   STORE_VAR var
+    //   STORE_SLOT var
     //   JUMP loop_start
     // loop_end:
     
     // Initialize loop variable
+    int varSlot = bytecode.declareSlot(stmt->variable);
     generateExpression(stmt->start.get());
-    bytecode.emit(OpCode::STORE_VAR, stmt->variable);
+    bytecode.emit(OpCode::STORE_SLOT, varSlot);
+    
+    if (forLoopOpcodes && fitsAux(varSlot) && hasInvariantBound(stmt)) {
+        generateExpression(stmt->end.get());
+        int prep = bytecode.size();
+        bytecode.addInstruction(Instruction(OpCode::FOR_PREP, static_cast<std::uint16_t>(varSlot), 0));  // Placeholder
+        
+        int loopBody = bytecode.size();
+        for (const auto& s : stmt->body) {
+            generateStatement(s.get());
+        }
+        bytecode.addInstruction(Instruction(OpCode::FOR_LOOP, static_cast<std::uint16_t>(varSlot), loopBody));
+        
+        // loop_exit: (backpatch FOR_PREP)
+        bytecode.patchInstruction(prep, bytecode.size());
+        bytecode.emit(OpCode::POP);
+        return;
+    }
     
     // loop_start:
     int loopStart = bytecode.size();
     
     // Check condition: var <= end
-    bytecode.emit(OpCode::LOAD_VAR, stmt->variable);
+    bytecode.emit(OpCode::LOAD_SLOT, varSlot);
     generateExpression(stmt->end.get());
     bytecode.emit(OpCode::CMP_LTE);
     
@@ -221,10 +334,10 @@ void CodeGenerator::generateForStatement(ForStatement* stmt) {
     }
     
     // Increment: var = var + 1
-    bytecode.emit(OpCode::LOAD_VAR, stmt->variable);
+    bytecode.emit(OpCode::LOAD_SLOT, varSlot);
     bytecode.emit(OpCode::LOAD_CONST, 1);
     bytecode.emit(OpCode::ADD);
-    bytecode.emit(OpCode::STORE_VAR, stmt->variable);
+    bytecode.emit(OpCode::STORE_SLOT, varSlot);
     
     // JUMP back to loop_start
     bytecode.emit(OpCode::JUMP, loopStart);
@@ -233,3 +346,135 @@ void CodeGenerator::generateForStatement(ForStatement* stmt) {
     int loopEnd = bytecode.size();
     bytecode.patchInstruction(jumpToEnd, loopEnd);
 }
+
+int CodeGenerator::getFusionCount(Superinstruction kind) const {
+    switch (kind) {
+        case FUSE_INCREMENT:        return fusedIncrements;
+        case FUSE_COMPARE_BRANCH:   return fusedCompareBranches;
+        case FUSE_SLOT_CONST_ARITH: return fusedSlotConstArith;
+        case FUSE_STORE_LOAD:       return fusedStoreLoads;
+        default:                    return 0;
+    }
+}
+
+static bool isJumpOpcode(OpCode opcode) {
+    return opcode == OpCode::JUMP || opcode == OpCode::JUMP_IF_FALSE ||
+           opcode == OpCode::JUMP_IF_TRUE || isCompareBranchOpcode(opcode) ||
+           isForLoopOpcode(opcode);
+}
+
+std::vector<int> CodeGenerator::fuseSuperinstructions(BytecodeProgram& program, unsigned kinds) {
+    std::vector<int> indexMap;
+    fuse(program, kinds, &indexMap);
+    return indexMap;
+}
+
+// Peephole pass that rewrites hot sequences into superinstructions; indexMap,
+// if given, receives the old-to-new index map
+static FusionTally fuse(BytecodeProgram& bytecode, unsigned superinstructions, std::vector<int>* indexMap) {
+    FusionTally tally;
+    const std::vector<Instruction>& code = bytecode.getInstructions();
+    const std::vector<int>& lines = bytecode.getLines();
+    size_t n = code.size();
+    
+    // A sequence may only be fused if nothing jumps into its middle
+    std::vector<bool> isTarget(n + 1, false);
+    for (const auto& instr : code) {
+        if (isJumpOpcode(instr.opcode) && instr.operand >= 0 && static_cast<size_t>(instr.operand) <= n) {
+            isTarget[instr.operand] = true;
+        }
+    }
+    auto canFuse = [&](size_t start, size_t length) {
+        if (start + length > n) return false;
+        for (size_t k = start + 1; k < start + length; ++k) {
+            if (isTarget[k]) return false;
+        }
+        return true;
+    };
+    
+    std::vector<Instruction> fused;
+    std::vector<int> fusedLines;  // A fused instruction keeps the line of its first part
+    fused.reserve(n);
+    fusedLines.reserve(n);
+    std::vector<int> newIndex(n + 1, 0);  // Old address -> new address
+    
+    size_t i = 0;
+    while (i < n) {
+        const Instruction& a = code[i];
+        size_t consumed = 1;
+        newIndex[i] = static_cast<int>(fused.size());
+        
+        // LOAD_SLOT v; LOAD_CONST k; ADD/SUB; STORE_SLOT v  ->  INC_SLOT v, +-k
+        if ((superinstructions & FUSE_INCREMENT) && canFuse(i, 4) &&
+            a.opcode == OpCode::LOAD_SLOT && fitsAux(a.operand) &&
+            code[i + 1].opcode == OpCode::LOAD_CONST &&
+            (code[i + 2].opcode == OpCode::ADD ||
+             (code[i + 2].opcode == OpCode::SUB && code[i + 1].operand != INT_MIN)) &&
+            code[i + 3].opcode == OpCode::STORE_SLOT && code[i + 3].operand == a.operand) {
+            int delta = code[i + 2].opcode == OpCode::ADD ? code[i + 1].operand : -code[i + 1].operand;
+            fused.emplace_back(OpCode::INC_SLOT, static_cast<std::uint16_t>(a.operand), delta);
+            tally.increments++;
+            consumed = 4;
+        }
+        // LOAD_SLOT v; LOAD_CONST k; <arith>  ->  SLOT_<arith>_CONST v, k
+        else if ((superinstructions & FUSE_SLOT_CONST_ARITH) && canFuse(i, 3) &&
+                 a.opcode == OpCode::LOAD_SLOT && fitsAux(a.operand) &&
+                 code[i + 1].opcode == OpCode::LOAD_CONST) {
+            int k = code[i + 1].operand;
+            OpCode op = OpCode::HALT;
+            switch (code[i + 2].opcode) {
+                case OpCode::ADD: op = OpCode::SLOT_ADD_CONST; break;
+                case OpCode::SUB: op = OpCode::SLOT_SUB_CONST; break;
+                case OpCode::MUL: op = OpCode::SLOT_MUL_CONST; break;
+                // Division keeps its runtime error paths unless the divisor is a safe constant
+                case OpCode::DIV: if (k != 0 && k != -1) op = OpCode::SLOT_DIV_CONST; break;
+                case OpCode::MOD: if (k != 0 && k != -1) op = OpCode::SLOT_MOD_CONST; break;
+                default: break;
+            }
+            if (op != OpCode::HALT) {
+                fused.emplace_back(op, static_cast<std::uint16_t>(a.operand), k);
+                tally.slotConstArith++;
+                consumed = 3;
+            }
+        }
+        // CMP_*; JUMP_IF_FALSE t  ->  JUMP_IF_NOT_* t
+        else if ((superinstructions & FUSE_COMPARE_BRANCH) && canFuse(i, 2) &&
+                 a.opcode >= OpCode::CMP_LT && a.opcode <= OpCode::CMP_NEQ &&
+                 code[i + 1].opcode == OpCode::JUMP_IF_FALSE) {
+            int offset = static_cast<int>(a.opcode) - static_cast<int>(OpCode::CMP_LT);
+            OpCode op = static_cast<OpCode>(static_cast<int>(OpCode::JUMP_IF_NOT_LT) + offset);
+            fused.emplace_back(op, code[i + 1].operand);  // Target remapped below
+            tally.compareBranches++;
+            consumed = 2;
+        }
+        // STORE_SLOT a; LOAD_SLOT b  ->  STORE_LOAD_SLOT a, b
+        else if ((superinstructions & FUSE_STORE_LOAD) && canFuse(i, 2) &&
+                 a.opcode == OpCode::STORE_SLOT && fitsAux(a.operand) &&
+                 code[i + 1].opcode == OpCode::LOAD_SLOT) {
+            fused.emplace_back(OpCode::STORE_LOAD_SLOT, static_cast<std::uint16_t>(a.operand), code[i + 1].operand);
+            tally.storeLoads++;
+            consumed = 2;
+        }
+        
+        if (consumed == 1) {
+            fused.push_back(a);
+        }
+        fusedLines.push_back(lines[i]);
+        for (size_t k = i + 1; k < i + consumed; ++k) {
+            newIndex[k] = newIndex[i];
+        }
+        i += consumed;
+    }
+    newIndex[n] = static_cast<int>(fused.size());
+    
+    // Retarget jumps to the compacted addresses
+    for (auto& instr : fused) {
+        if (isJumpOpcode(instr.opcode) && instr.operand >= 0 && static_cast<size_t>(instr.operand) <= n) {
+            instr.operand = newIndex[instr.operand];
+        }
+    }
+    
+    bytecode.setInstructions(std::move(fused), std::move(fusedLines));
+    if (indexMap) *indexMap = std::move(newIndex);
+    return tally;
+}
@@ -6,6 +6,16 @@
 #include <vector>
 #include <memory>
 
+// Superinstruction families that generate() may fuse (bit flags)
+enum Superinstruction : unsigned {
+    FUSE_NONE            = 0,
+    FUSE_INCREMENT       = 1 << 0,  // LOAD_SLOT v; LOAD_CONST k; ADD/SUB; STORE_SLOT v -> INC_SLOT
+    FUSE_COMPARE_BRANCH  = 1 << 1,  // CMP_*; JUMP_IF_FALSE                       -> JUMP_IF_NOT_*
+    FUSE_SLOT_CONST_ARITH = 1 << 2, // LOAD_SLOT v; LOAD_CONST k; <arith>          -> SLOT_*_CONST
+    FUSE_STORE_LOAD      = 1 << 3,  // STORE_SLOT a; LOAD_SLOT b                   -> STORE_LOAD_SLOT
+    FUSE_ALL             = FUSE_INCREMENT | FUSE_COMPARE_BRANCH | FUSE_SLOT_CONST_ARITH | FUSE_STORE_LOAD
+};
+
 class CodeGenerator {
 public:
     CodeGenerator() = default;
@@ -13,8 +23,30 @@ public:
     // Generate bytecode from AST program
     BytecodeProgram generate(const std::vector<std::unique_ptr<Statement>>& program);
     
+    // Select which superinstruction families to fuse (FUSE_NONE by default)
+    void setSuperinstructions(unsigned kinds) { superinstructions = kinds; }
+    
+    // Number of fusions of each family applied by the last generate()
+    int getFusionCount(Superinstruction kind) const;
+    
+    // Compile for loops with a loop-invariant bound to FOR_PREP/FOR_LOOP (on by default)
+    void setForLoopOpcodes(bool enabled) { forLoopOpcodes = enabled; }
+    
+    // The superinstruction pass generate() runs, for bytecode built elsewhere
+    // (such as hot loops recompiled by the VM's tiered engine). Returns the
+    // old-to-new index map: entry i is the index of the instruction now holding
+    // old instruction i (the fused instruction, for any part of a fusion), and
+    // the extra last entry is the new size
+    static std::vector<int> fuseSuperinstructions(BytecodeProgram& program, unsigned kinds);
+    
 private:
     BytecodeProgram bytecode;
+    unsigned superinstructions = FUSE_NONE;
+    bool forLoopOpcodes = true;
+    int fusedIncrements = 0;
+    int fusedCompareBranches = 0;
+    int fusedSlotConstArith = 0;
+    int fusedStoreLoads = 0;
     
     // Statement code generation
     void generateStatement(Statement* stmt);
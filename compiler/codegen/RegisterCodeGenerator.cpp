@@ -0,0 +1,275 @@
+#include "RegisterCodeGenerator.h"
+#include <algorithm>
+#include <stdexcept>
+
+RegisterProgram RegisterCodeGenerator::generate(const std::vector<std::unique_ptr<Statement>>& program) {
+    code.clear();
+
+    for (const auto& stmt : program) {
+        declareVariables(stmt.get());
+    }
+    firstTemp = nextTemp = registerCount = code.getSlotCount();
+
+    for (const auto& stmt : program) {
+        generateStatement(stmt.get());
+    }
+
+    code.emit(RegInstruction(RegOpCode::HALT, 0, 0, 0));
+    code.setRegisterCount(registerCount);
+
+    return std::move(code);
+}
+
+void RegisterCodeGenerator::declareVariables(Statement* stmt) {
+    if (auto* letStmt = dynamic_cast<LetStatement*>(stmt)) {
+        declareVariables(letStmt->expression.get());
+        code.declareSlot(letStmt->identifier);
+    } else if (auto* printStmt = dynamic_cast<PrintStatement*>(stmt)) {
+        declareVariables(printStmt->expression.get());
+    } else if (auto* ifStmt = dynamic_cast<IfStatement*>(stmt)) {
+        declareVariables(ifStmt->condition.get());
+        for (const auto& s : ifStmt->thenBlock) declareVariables(s.get());
+        for (const auto& s : ifStmt->elseBlock) declareVariables(s.get());
+    } else if (auto* forStmt = dynamic_cast<ForStatement*>(stmt)) {
+        code.declareSlot(forStmt->variable);
+        declareVariables(forStmt->start.get());
+        declareVariables(forStmt->end.get());
+        for (const auto& s : forStmt->body) declareVariables(s.get());
+    }
+}
+
+void RegisterCodeGenerator::declareVariables(Expression* expr) {
+    if (auto* var = dynamic_cast<Variable*>(expr)) {
+        code.declareSlot(var->name);
+    } else if (auto* binOp = dynamic_cast<BinaryOperation*>(expr)) {
+        declareVariables(binOp->left.get());
+        declareVariables(binOp->right.get());
+    } else if (auto* compExpr = dynamic_cast<ComparisonExpression*>(expr)) {
+        declareVariables(compExpr->left.get());
+        declareVariables(compExpr->right.get());
+    } else if (auto* logicExpr = dynamic_cast<LogicalExpression*>(expr)) {
+        declareVariables(logicExpr->left.get());
+        declareVariables(logicExpr->right.get());
+    } else if (auto* unaryExpr = dynamic_cast<UnaryExpression*>(expr)) {
+        declareVariables(unaryExpr->operand.get());
+    }
+}
+
+int RegisterCodeGenerator::allocateTemp() {
+    if (nextTemp >= MAX_REGISTERS) {
+        throw std::runtime_error("Code generation error: expression needs too many registers");
+    }
+    int reg = nextTemp++;
+    registerCount = std::max(registerCount, nextTemp);
+    return reg;
+}
+
+void RegisterCodeGenerator::generateStatement(Statement* stmt) {
+    int outerLine = code.getCurrentLine();
+    code.setCurrentLine(stmt->startLine);
+
+    if (auto* letStmt = dynamic_cast<LetStatement*>(stmt)) {
+        generateLetStatement(letStmt);
+    } else if (auto* printStmt = dynamic_cast<PrintStatement*>(stmt)) {
+        generatePrintStatement(printStmt);
+    } else if (auto* ifStmt = dynamic_cast<IfStatement*>(stmt)) {
+        generateIfStatement(ifStmt);
+    } else if (auto* forStmt = dynamic_cast<ForStatement*>(stmt)) {
+        generateForStatement(forStmt);
+    }
+
+    // Temporaries never live across statements
+    nextTemp = firstTemp;
+    code.setCurrentLine(outerLine);
+}
+
+void RegisterCodeGenerator::generateLetStatement(LetStatement* stmt) {
+    // Evaluate straight into the variable's register
+    generateExpression(stmt->expression.get(), code.declareSlot(stmt->identifier));
+}
+
+void RegisterCodeGenerator::generatePrintStatement(PrintStatement* stmt) {
+    int value = generateExpression(stmt->expression.get());
+    code.emit(RegInstruction(RegOpCode::PRINT, value, 0, 0));
+}
+
+void RegisterCodeGenerator::generateIfStatement(IfStatement* stmt) {
+    // <branch to else_label unless condition>
+    // <then_block>
+    // JUMP end_label            (only with an else block)
+    // else_label: <else_block>
+    // end_label:
+    int jumpToElse = generateBranchIfFalse(stmt->condition.get());
+
+    for (const auto& s : stmt->thenBlock) {
+        generateStatement(s.get());
+    }
+
+    int jumpToEnd = -1;
+    if (!stmt->elseBlock.empty()) {
+        jumpToEnd = code.emit(RegInstruction(RegOpCode::JUMP, 0, 0, 0));
+    }
+
+    code.patchTarget(jumpToElse, static_cast<int>(code.size()));
+
+    for (const auto& s : stmt->elseBlock) {
+        generateStatement(s.get());
+    }
+
+    if (jumpToEnd != -1) {
+        code.patchTarget(jumpToEnd, static_cast<int>(code.size()));
+    }
+}
+
+void RegisterCodeGenerator::generateForStatement(ForStatement* stmt) {
+    //   var = <start>
+    // loop_start:
+    //   end = <end>                      (re-evaluated each iteration, as on the stack VM)
+    //   JUMP_IF_NOT_LTE var, end, loop_end
+    //   <body>
+    //   ADDI var, var, 1
+    //   JUMP loop_start
+    // loop_end:
+    int var = code.declareSlot(stmt->variable);
+    generateExpression(stmt->start.get(), var);
+
+    int loopStart = static_cast<int>(code.size());
+    int end = generateExpression(stmt->end.get());
+    int jumpToEnd = code.emit(RegInstruction(RegOpCode::JUMP_IF_NOT_LTE, 0, var, end));
+    nextTemp = firstTemp;
+
+    for (const auto& s : stmt->body) {
+        generateStatement(s.get());
+    }
+
+    code.emit(RegInstruction(RegOpCode::ADDI, var, var, 0, 1));
+    code.emit(RegInstruction(RegOpCode::JUMP, 0, 0, 0, loopStart));
+
+    code.patchTarget(jumpToEnd, static_cast<int>(code.size()));
+}
+
+int RegisterCodeGenerator::generateBranchIfFalse(Expression* condition) {
+    int mark = nextTemp;
+
+    // A comparison branches on its operands directly
+    if (auto* compExpr = dynamic_cast<ComparisonExpression*>(condition)) {
+        int left = generateExpression(compExpr->left.get());
+        int right = generateExpression(compExpr->right.get());
+        nextTemp = mark;
+
+        RegOpCode op = RegOpCode::JUMP_IF_NOT_NEQ;
+        if (compExpr->op == "<") op = RegOpCode::JUMP_IF_NOT_LT;
+        else if (compExpr->op == ">") op = RegOpCode::JUMP_IF_NOT_GT;
+        else if (compExpr->op == "<=") op = RegOpCode::JUMP_IF_NOT_LTE;
+        else if (compExpr->op == ">=") op = RegOpCode::JUMP_IF_NOT_GTE;
+        else if (compExpr->op == "==") op = RegOpCode::JUMP_IF_NOT_EQ;
+        return code.emit(RegInstruction(op, 0, left, right));
+    }
+
+    int value = generateExpression(condition);
+    nextTemp = mark;
+    return code.emit(RegInstruction(RegOpCode::JUMP_IF_FALSE, value, 0, 0));
+}
+
+int RegisterCodeGenerator::generateExpression(Expression* expr, int target) {
+    if (auto* intLit = dynamic_cast<IntegerLiteral*>(expr)) {
+        int dest = target >= 0 ? target : allocateTemp();
+        if (fitsInt32(intLit->value)) {
+            code.emit(RegInstruction(RegOpCode::LOADI, dest, 0, 0, static_cast<std::int32_t>(intLit->value)));
+        } else {
+            code.emit(RegInstruction(RegOpCode::LOADK, dest, 0, 0, code.addConstant(intLit->value)));
+        }
+        return dest;
+    }
+
+    if (auto* var = dynamic_cast<Variable*>(expr)) {
+        int reg = code.declareSlot(var->name);
+        if (target >= 0 && target != reg) {
+            code.emit(RegInstruction(RegOpCode::MOVE, target, reg, 0));
+            return target;
+        }
+        return reg;
+    }
+
+    if (auto* binOp = dynamic_cast<BinaryOperation*>(expr)) {
+        return generateBinaryOperation(binOp, target);
+    }
+
+    // Comparisons, logic and NOT: operands into registers, then one instruction.
+    // Sources are read before the destination is written, so the destination
+    // may reuse an operand's temporary.
+    int mark = nextTemp;
+    RegInstruction instr;
+    if (auto* compExpr = dynamic_cast<ComparisonExpression*>(expr)) {
+        RegOpCode op = RegOpCode::NEQ;
+        if (compExpr->op == "<") op = RegOpCode::LT;
+        else if (compExpr->op == ">") op = RegOpCode::GT;
+        else if (compExpr->op == "<=") op = RegOpCode::LTE;
+        else if (compExpr->op == ">=") op = RegOpCode::GTE;
+        else if (compExpr->op == "==") op = RegOpCode::EQ;
+        int left = generateExpression(compExpr->left.get());
+        int right = generateExpression(compExpr->right.get());
+        instr = RegInstruction(op, 0, left, right);
+    } else if (auto* logicExpr = dynamic_cast<LogicalExpression*>(expr)) {
+        int left = generateExpression(logicExpr->left.get());
+        int right = generateExpression(logicExpr->right.get());
+        instr = RegInstruction(logicExpr->op == "&&" ? RegOpCode::AND : RegOpCode::OR, 0, left, right);
+    } else if (auto* unaryExpr = dynamic_cast<UnaryExpression*>(expr)) {
+        int operand = generateExpression(unaryExpr->operand.get());
+        instr = RegInstruction(RegOpCode::NOT, 0, operand, 0);
+    } else {
+        return target >= 0 ? target : allocateTemp();
+    }
+
+    nextTemp = mark;
+    int dest = target >= 0 ? target : allocateTemp();
+    instr.a = static_cast<std::uint16_t>(dest);
+    code.emit(instr);
+    return dest;
+}
+
+int RegisterCodeGenerator::generateBinaryOperation(BinaryOperation* expr, int target) {
+    RegOpCode op = RegOpCode::ADD;
+    if (expr->op == "-") op = RegOpCode::SUB;
+    else if (expr->op == "*") op = RegOpCode::MUL;
+    else if (expr->op == "/") op = RegOpCode::DIV;
+    else if (expr->op == "%") op = RegOpCode::MOD;
+
+    Expression* left = expr->left.get();
+    Expression* right = expr->right.get();
+
+    // Constant operand -> immediate form (k + x becomes x + k; only 32-bit constants,
+    // and division only by a constant other than 0 and -1)
+    auto* constant = dynamic_cast<IntegerLiteral*>(right);
+    bool commutative = op == RegOpCode::ADD || op == RegOpCode::MUL;
+    if (!constant && commutative) {
+        if (auto* leftConstant = dynamic_cast<IntegerLiteral*>(left)) {
+            constant = leftConstant;
+            std::swap(left, right);
+        }
+    }
+    bool divides = op == RegOpCode::DIV || op == RegOpCode::MOD;
+    if (constant && (!fitsInt32(constant->value) ||
+                     (divides && (constant->value == 0 || constant->value == -1)))) {
+        constant = nullptr;
+        left = expr->left.get();
+        right = expr->right.get();
+    }
+
+    int mark = nextTemp;
+    int leftReg = generateExpression(left);
+    if (constant) {
+        nextTemp = mark;
+        int dest = target >= 0 ? target : allocateTemp();
+        RegOpCode immediateOp = static_cast<RegOpCode>(static_cast<int>(op) - static_cast<int>(RegOpCode::ADD) +
+                                                       static_cast<int>(RegOpCode::ADDI));
+        code.emit(RegInstruction(immediateOp, dest, leftReg, 0, static_cast<std::int32_t>(constant->value)));
+        return dest;
+    }
+
+    int rightReg = generateExpression(right);
+    nextTemp = mark;
+    int dest = target >= 0 ? target : allocateTemp();
+    code.emit(RegInstruction(op, dest, leftReg, rightReg));
+    return dest;
+}
@@ -0,0 +1,52 @@
+#ifndef REGISTER_CODE_GENERATOR_H
+#define REGISTER_CODE_GENERATOR_H
+
+#include "../parser/AST.h"
+#include "../bytecode/RegisterProgram.h"
+#include <vector>
+#include <memory>
+
+// Generates three-address register bytecode (RegisterProgram) from the AST,
+// the counterpart of CodeGenerator for the RegisterVM backend.
+//
+// Every variable owns a register, so variable operands are used in place and
+// a statement like "let x = x + 1" is a single ADDI x, x, 1. Intermediate
+// values get temporary registers above the variables, allocated like a stack
+// and released at the end of each statement.
+class RegisterCodeGenerator {
+public:
+    RegisterCodeGenerator() = default;
+
+    // Generate register bytecode from AST program
+    RegisterProgram generate(const std::vector<std::unique_ptr<Statement>>& program);
+
+private:
+    RegisterProgram code;
+    int firstTemp = 0;      // First register after the variables
+    int nextTemp = 0;       // Next free temporary
+    int registerCount = 0;  // Highest register used + 1
+
+    // Assign registers to all variables up front (same order as CodeGenerator slots)
+    void declareVariables(Statement* stmt);
+    void declareVariables(Expression* expr);
+
+    int allocateTemp();
+
+    // Statement code generation
+    void generateStatement(Statement* stmt);
+    void generateLetStatement(LetStatement* stmt);
+    void generatePrintStatement(PrintStatement* stmt);
+    void generateIfStatement(IfStatement* stmt);
+    void generateForStatement(ForStatement* stmt);
+
+    // Evaluate an expression; returns the register holding the result.
+    // With target >= 0 the result is written there, otherwise a variable is
+    // used in place and anything else lands in a fresh temporary.
+    int generateExpression(Expression* expr, int target = -1);
+    int generateBinaryOperation(BinaryOperation* expr, int target);
+
+    // Emit a jump taken when the condition is false; returns it for backpatching
+    int generateBranchIfFalse(Expression* condition);
+};
+
+#endif
@@ -0,0 +1,580 @@
+#include "JitCompiler.h"
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+#if defined(__x86_64__) && !defined(_WIN32) && (defined(__unix__) || defined(__APPLE__))
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define JIT_X86_64 0
+#endif
+
+bool JitCompiler::isSupported() {
+    return JIT_X86_64 != 0;
+}
+
+JitCode::~JitCode() {
+#if JIT_X86_64
+    munmap(memory, codeSize);
+#endif
+}
+
+void JitCode::run(JitContext& context) const {
+    reinterpret_cast<void (*)(JitContext*)>(memory)(&context);
+}
+
+#if JIT_X86_64
+
+namespace {
+
+enum Reg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// Condition codes (low nibble of Jcc/SETcc)
+enum Cond { CC_O = 0x0, CC_E = 0x4, CC_NE = 0x5, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+// Register allocation for generated code:
+//   rbx = JitContext*, r15 = slots, rbp = assigned flags, r14 = spill area,
+//   r13 = instruction counter, rax/rcx/rdx = scratch
+// Values are 64-bit. Operand stack positions 0-5 live in these (caller-saved)
+// registers:
+const Reg STACK_REGS[] = {RSI, RDI, R8, R9, R10, R11};
+const int STACK_REG_COUNT = 6;
+
+// Operand of an instruction: a register or [base + disp32]
+struct Loc {
+    bool isReg;
+    int reg;      // Register, or memory base (never rsp/r12, which need a SIB byte)
+    std::int32_t disp;
+
+    static Loc r(int reg) { return {true, reg, 0}; }
+    static Loc mem(int base, std::int32_t disp) { return {false, base, disp}; }
+    bool operator==(const Loc& other) const {
+        return isReg == other.isReg && reg == other.reg && (isReg || disp == other.disp);
+    }
+};
+
+class Assembler {
+public:
+    std::vector<std::uint8_t> code;
+
+    size_t offset() const { return code.size(); }
+    void byte(std::uint8_t b) { code.push_back(b); }
+    void bytes(std::initializer_list<std::uint8_t> list) { code.insert(code.end(), list); }
+    void dword(std::int32_t value) {
+        for (int i = 0; i < 4; ++i) byte(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+    void qword(std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) byte(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    // [REX] opcode ModRM [disp32] for "op reg, r/m" style encodings
+    void modrm(bool wide, std::initializer_list<std::uint8_t> opcode, int reg, Loc rm) {
+        std::uint8_t rex = 0x40 | (wide ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm.reg & 8) ? 1 : 0);
+        if (rex != 0x40) byte(rex);
+        bytes(opcode);
+        if (rm.isReg) {
+            byte(0xC0 | ((reg & 7) << 3) | (rm.reg & 7));
+        } else {
+            byte(0x80 | ((reg & 7) << 3) | (rm.reg & 7));
+            dword(rm.disp);
+        }
+    }
+
+    // 64-bit (value) moves
+    void load(int reg, Loc src) { modrm(true, {0x8B}, reg, src); }
+    void store(Loc dst, int reg) { modrm(true, {0x89}, reg, dst); }
+    void move(Loc dst, Loc src) {
+        if (dst == src) return;
+        if (dst.isReg) {
+            load(dst.reg, src);
+        } else if (src.isReg) {
+            store(dst, src.reg);
+        } else {
+            load(RAX, src);
+            store(dst, RAX);
+        }
+    }
+    // dst = sign-extended imm32
+    void moveImm(Loc dst, std::int32_t imm) {
+        modrm(true, {0xC7}, 0, dst);
+        dword(imm);
+    }
+    // reg = imm64
+    void moveImm64(int reg, std::int64_t imm) {
+        byte(0x48 | ((reg & 8) ? 1 : 0));
+        byte(0xB8 + (reg & 7));
+        qword(static_cast<std::uint64_t>(imm));
+    }
+
+    // 32-bit fields of JitContext and int results of runtime calls
+    void store32(Loc dst, int reg) { modrm(false, {0x89}, reg, dst); }
+    void moveImm32(Loc dst, std::int32_t imm) {
+        modrm(false, {0xC7}, 0, dst);
+        dword(imm);
+    }
+    void test32(int reg) { modrm(false, {0x85}, reg, Loc::r(reg)); }
+
+    // reg = reg OP src (add/sub/imul set the overflow flag)
+    void add(int reg, Loc src) { modrm(true, {0x03}, reg, src); }
+    void sub(int reg, Loc src) { modrm(true, {0x2B}, reg, src); }
+    void imul(int reg, Loc src) { modrm(true, {0x0F, 0xAF}, reg, src); }
+    void cmp(int reg, Loc src) { modrm(true, {0x3B}, reg, src); }
+    void test(int reg) { modrm(true, {0x85}, reg, Loc::r(reg)); }
+
+    // rax = rax OP imm32 (sign-extended)
+    void addRaxImm(std::int32_t imm) { bytes({0x48, 0x05}); dword(imm); }
+    void subRaxImm(std::int32_t imm) { bytes({0x48, 0x2D}); dword(imm); }
+    void imulRaxImm(std::int32_t imm) { bytes({0x48, 0x69, 0xC0}); dword(imm); }
+    void cmpImm8(int reg, std::int8_t imm) { modrm(true, {0x83}, 7, Loc::r(reg)); byte(static_cast<std::uint8_t>(imm)); }
+    void neg(int reg) { modrm(true, {0xF7}, 3, Loc::r(reg)); }
+
+    // al/cl = condition; eax = zero-extended al
+    void setcc(Cond cc, int lowReg) { bytes({0x0F, static_cast<std::uint8_t>(0x90 | cc), static_cast<std::uint8_t>(0xC0 | lowReg)}); }
+    void movzxEaxAl() { bytes({0x0F, 0xB6, 0xC0}); }
+
+    // rdx:rax / rcx (cqo; idiv rcx)
+    void signedDivide() { bytes({0x48, 0x99, 0x48, 0xF7, 0xF9}); }
+
+    // Branches with a rel32 to be patched; returns the patch position
+    size_t jmp() { byte(0xE9); dword(0); return offset() - 4; }
+    size_t jcc(Cond cc) { bytes({0x0F, static_cast<std::uint8_t>(0x80 | cc)}); dword(0); return offset() - 4; }
+    void patch(size_t at, size_t target) {
+        std::int32_t rel = static_cast<std::int32_t>(target) - static_cast<std::int32_t>(at + 4);
+        std::memcpy(&code[at], &rel, 4);
+    }
+};
+
+// Runtime callback for PRINT; exceptions must not unwind through generated code
+int jitPrint(JitContext* context, std::int64_t value) noexcept {
+    try {
+        context->runtime->output->printInt(value);
+        return 0;
+    } catch (...) {
+        context->runtime->printError = std::current_exception();
+        return 1;
+    }
+}
+
+// Runtime callback at backward jumps when budgets are on
+int jitBudgetCheck(JitContext* context) noexcept {
+    return context->runtime->budgetCheck(*context) ? 1 : 0;
+}
+
+Cond compareCond(OpCode opcode) {
+    switch (opcode) {
+        case OpCode::CMP_LT:  return CC_L;
+        case OpCode::CMP_GT:  return CC_G;
+        case OpCode::CMP_LTE: return CC_LE;
+        case OpCode::CMP_GTE: return CC_GE;
+        case OpCode::CMP_EQ:  return CC_E;
+        default:              return CC_NE;
+    }
+}
+
+// JUMP_IF_NOT_* jumps when the comparison is false
+Cond inverseBranchCond(OpCode opcode) {
+    switch (opcode) {
+        case OpCode::JUMP_IF_NOT_LT:  return CC_GE;
+        case OpCode::JUMP_IF_NOT_GT:  return CC_LE;
+        case OpCode::JUMP_IF_NOT_LTE: return CC_G;
+        case OpCode::JUMP_IF_NOT_GTE: return CC_L;
+        case OpCode::JUMP_IF_NOT_EQ:  return CC_NE;
+        default:                      return CC_E;
+    }
+}
+
+bool isJump(OpCode opcode) {
+    return opcode == OpCode::JUMP || opcode == OpCode::JUMP_IF_FALSE ||
+           opcode == OpCode::JUMP_IF_TRUE || isCompareBranchOpcode(opcode) ||
+           isForLoopOpcode(opcode);
+}
+
+Loc spillAt(int position) {
+    return Loc::mem(R14, 8 * position);
+}
+
+Loc stackAt(int position) {
+    return position < STACK_REG_COUNT ? Loc::r(STACK_REGS[position]) : spillAt(position);
+}
+
+Loc slotAt(int slot) {
+    return Loc::mem(R15, 8 * slot);
+}
+
+} // namespace
+
+#endif
+
+std::unique_ptr<JitCode> JitCompiler::compile(const BytecodeProgram& program, int entryDepth) {
+#if !JIT_X86_64
+    (void)program;
+    (void)entryDepth;
+    return nullptr;
+#else
+    if (!program.isVerified() || entryDepth < 0 || entryDepth > program.getVerifiedStackDepth()) {
+        return nullptr;
+    }
+
+    const auto& code = program.getInstructions();
+    int n = static_cast<int>(code.size());
+
+    // Stack depth before each instruction (-1 = unreachable); the verifier
+    // already proved it is the same on every path
+    std::vector<int> depth(n, -1);
+    std::vector<int> worklist{0};
+    depth[0] = entryDepth;
+    while (!worklist.empty()) {
+        int pc = worklist.back();
+        worklist.pop_back();
+        OpCode op = code[pc].opcode;
+        int after = depth[pc] - stackPops(op) + stackPushes(op);
+        auto reach = [&](int target) {
+            if (depth[target] < 0) {
+                depth[target] = after;
+                worklist.push_back(target);
+            }
+        };
+        if (op == OpCode::HALT) continue;
+        if (isJump(op)) reach(code[pc].operand);
+        if (op != OpCode::JUMP) reach(pc + 1);
+    }
+
+    // Basic blocks: the counter is bumped once per block, and an error in
+    // the middle of a block subtracts the instructions it did not execute
+    std::vector<bool> leader(n, false);
+    leader[0] = true;
+    for (int pc = 0; pc < n; ++pc) {
+        OpCode op = code[pc].opcode;
+        if (isJump(op)) leader[code[pc].operand] = true;
+        if ((isJump(op) || op == OpCode::HALT) && pc + 1 < n) leader[pc + 1] = true;
+    }
+    std::vector<int> remaining(n + 1, 0);   // Counted instructions from pc to block end
+    for (int pc = n - 1; pc >= 0; --pc) {
+        int next = (pc + 1 < n && !leader[pc + 1]) ? remaining[pc + 1] : 0;
+        remaining[pc] = next + (code[pc].opcode != OpCode::HALT ? 1 : 0);
+    }
+
+    struct Branch { size_t at; int target; };
+    struct ErrorSite { size_t at; JitError kind; int pc; };
+    std::vector<size_t> pcOffset(n, 0);
+    std::vector<Branch> branches;
+    std::vector<ErrorSite> errorSites;
+    std::vector<size_t> haltJumps;
+
+    Assembler as;
+
+    // Prologue: save callee-saved registers, keep rsp 16-byte aligned for calls
+    as.bytes({0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57});  // push rbx, rbp, r12-r15
+    as.bytes({0x48, 0x83, 0xEC, 0x08});                                       // sub rsp, 8
+    as.modrm(true, {0x89}, RDI, Loc::r(RBX));                                 // mov rbx, rdi
+    as.modrm(true, {0x8B}, R15, Loc::mem(RBX, offsetof(JitContext, slots)));
+    as.modrm(true, {0x8B}, RBP, Loc::mem(RBX, offsetof(JitContext, assigned)));
+    as.modrm(true, {0x8B}, R14, Loc::mem(RBX, offsetof(JitContext, stack)));
+    as.modrm(false, {0x31}, R13, Loc::r(R13));                                // xor r13d, r13d
+    for (int p = 0; p < std::min(entryDepth, STACK_REG_COUNT); ++p) {
+        as.load(STACK_REGS[p], spillAt(p));
+    }
+
+    for (int pc = 0; pc < n; ++pc) {
+        pcOffset[pc] = as.offset();
+        if (depth[pc] < 0) continue;
+
+        const Instruction& instr = code[pc];
+        int d = depth[pc];
+
+        if (leader[pc] && remaining[pc] > 0) {
+            as.modrm(true, {0x81}, 0, Loc::r(R13));                           // add r13, imm32
+            as.dword(remaining[pc]);
+        }
+
+        // Budget check on backward jumps: calls out only when the count
+        // (excluding the rest of this block) has reached the checkpoint
+        if (budgetChecks && isJump(instr.opcode) && instr.operand <= pc) {
+            int live = std::min(d, STACK_REG_COUNT);
+            as.modrm(true, {0x8B}, RAX, Loc::r(R13));                         // mov rax, r13
+            as.bytes({0x48, 0x2D}); as.dword(remaining[pc]);                  // sub rax, uncounted
+            as.modrm(true, {0x3B}, RAX, Loc::mem(RBX, offsetof(JitContext, checkpoint)));
+            size_t skip = as.jcc(CC_L);
+            as.modrm(true, {0x89}, RAX, Loc::mem(RBX, offsetof(JitContext, instructionCount)));
+            for (int p = 0; p < live; ++p) as.store(spillAt(p), STACK_REGS[p]);
+            as.modrm(true, {0x89}, RBX, Loc::r(RDI));                         // mov rdi, rbx
+            as.bytes({0x48, 0xB8});                                           // mov rax, imm64
+            as.qword(reinterpret_cast<std::uint64_t>(&jitBudgetCheck));
+            as.bytes({0xFF, 0xD0});                                           // call rax
+            as.test32(RAX);
+            errorSites.push_back({as.jcc(CC_NE), JIT_BUDGET_EXCEEDED, pc});
+            for (int p = 0; p < live; ++p) as.load(STACK_REGS[p], spillAt(p));
+            as.patch(skip, as.offset());
+        }
+
+        switch (instr.opcode) {
+            case OpCode::LOAD_CONST:
+                as.moveImm(stackAt(d), instr.operand);
+                break;
+
+            case OpCode::LOAD_CONST_WIDE: {
+                Loc top = stackAt(d);
+                as.moveImm64(top.isReg ? top.reg : RAX, program.getConstant(instr.operand));
+                if (!top.isReg) as.store(top, RAX);
+                break;
+            }
+
+            case OpCode::LOAD_VAR:
+            case OpCode::LOAD_SLOT:
+                as.move(stackAt(d), slotAt(instr.operand));
+                break;
+
+            case OpCode::STORE_VAR:
+            case OpCode::STORE_SLOT:
+                as.move(slotAt(instr.operand), stackAt(d - 1));
+                as.modrm(false, {0xC6}, 0, Loc::mem(RBP, instr.operand));   // mov byte [rbp+slot], 1
+                as.byte(1);
+                break;
+
+            case OpCode::ADD:
+            case OpCode::SUB:
+            case OpCode::MUL: {
+                Loc a = stackAt(d - 2);
+                Loc b = stackAt(d - 1);
+                int reg = a.isReg ? a.reg : RAX;
+                if (!a.isReg) as.load(RAX, a);
+                if (instr.opcode == OpCode::ADD) as.add(reg, b);
+                else if (instr.opcode == OpCode::SUB) as.sub(reg, b);
+                else as.imul(reg, b);
+                errorSites.push_back({as.jcc(CC_O), JIT_OVERFLOW, pc});
+                if (!a.isReg) as.store(a, RAX);
+                break;
+            }
+
+            case OpCode::DIV:
+            case OpCode::MOD: {
+                Loc a = stackAt(d - 2);
+                as.load(RCX, stackAt(d - 1));
+                as.test(RCX);
+                errorSites.push_back({as.jcc(CC_E),
+                                      instr.opcode == OpCode::DIV ? JIT_DIVISION_BY_ZERO : JIT_MODULO_BY_ZERO,
+                                      pc});
+                as.load(RAX, a);
+                // idiv faults on MIN / -1: negate instead (remainder 0)
+                as.cmpImm8(RCX, -1);
+                size_t divide = as.jcc(CC_NE);
+                if (instr.opcode == OpCode::DIV) {
+                    as.neg(RAX);
+                    errorSites.push_back({as.jcc(CC_O), JIT_OVERFLOW, pc});
+                } else {
+                    as.modrm(false, {0x31}, RDX, Loc::r(RDX));                // xor edx, edx
+                }
+                size_t done = as.jmp();
+                as.patch(divide, as.offset());
+                as.signedDivide();
+                as.patch(done, as.offset());
+                as.store(a, instr.opcode == OpCode::DIV ? RAX : RDX);
+                break;
+            }
+
+            case OpCode::CMP_LT:
+            case OpCode::CMP_GT:
+            case OpCode::CMP_LTE:
+            case OpCode::CMP_GTE:
+            case OpCode::CMP_EQ:
+            case OpCode::CMP_NEQ: {
+                Loc a = stackAt(d - 2);
+                as.load(RAX, a);
+                as.cmp(RAX, stackAt(d - 1));
+                as.setcc(compareCond(instr.opcode), RAX);
+                as.movzxEaxAl();
+                as.store(a, RAX);
+                break;
+            }
+
+            case OpCode::AND:
+            case OpCode::OR: {
+                Loc a = stackAt(d - 2);
+                as.load(RAX, a);
+                as.test(RAX);
+                as.setcc(CC_NE, RAX);
+                as.load(RCX, stackAt(d - 1));
+                as.test(RCX);
+                as.setcc(CC_NE, RCX);
+                as.bytes({static_cast<std::uint8_t>(instr.opcode == OpCode::AND ? 0x20 : 0x08), 0xC8});  // and/or al, cl
+                as.movzxEaxAl();
+                as.store(a, RAX);
+                break;
+            }
+
+            case OpCode::NOT: {
+                Loc a = stackAt(d - 1);
+                as.load(RAX, a);
+                as.test(RAX);
+                as.setcc(CC_E, RAX);
+                as.movzxEaxAl();
+                as.store(a, RAX);
+                break;
+            }
+
+            case OpCode::JUMP:
+                branches.push_back({as.jmp(), instr.operand});
+                break;
+
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE: {
+                Loc value = stackAt(d - 1);
+                int reg = value.isReg ? value.reg : RAX;
+                if (!value.isReg) as.load(RAX, value);
+                as.test(reg);
+                branches.push_back({as.jcc(instr.opcode == OpCode::JUMP_IF_FALSE ? CC_E : CC_NE),
+                                    instr.operand});
+                break;
+            }
+
+            case OpCode::POP:
+                break;
+
+            case OpCode::DUP:
+                as.move(stackAt(d), stackAt(d - 1));
+                break;
+
+            case OpCode::INC_SLOT:
+                as.load(RAX, slotAt(instr.aux));
+                as.addRaxImm(instr.operand);
+                errorSites.push_back({as.jcc(CC_O), JIT_OVERFLOW, pc});
+                as.store(slotAt(instr.aux), RAX);
+                break;
+
+            case OpCode::SLOT_ADD_CONST:
+            case OpCode::SLOT_SUB_CONST:
+            case OpCode::SLOT_MUL_CONST:
+            case OpCode::SLOT_DIV_CONST:
+            case OpCode::SLOT_MOD_CONST: {
+                as.load(RAX, slotAt(instr.aux));
+                int result = RAX;
+                switch (instr.opcode) {
+                    case OpCode::SLOT_ADD_CONST: as.addRaxImm(instr.operand); break;
+                    case OpCode::SLOT_SUB_CONST: as.subRaxImm(instr.operand); break;
+                    case OpCode::SLOT_MUL_CONST: as.imulRaxImm(instr.operand); break;
+                    default:
+                        // The verifier only accepts divisors other than 0 and -1
+                        as.moveImm(Loc::r(RCX), instr.operand);
+                        as.signedDivide();
+                        if (instr.opcode == OpCode::SLOT_MOD_CONST) result = RDX;
+                        break;
+                }
+                if (instr.opcode != OpCode::SLOT_DIV_CONST && instr.opcode != OpCode::SLOT_MOD_CONST) {
+                    errorSites.push_back({as.jcc(CC_O), JIT_OVERFLOW, pc});
+                }
+                as.move(stackAt(d), Loc::r(result));
+                break;
+            }
+
+            case OpCode::JUMP_IF_NOT_LT:
+            case OpCode::JUMP_IF_NOT_GT:
+            case OpCode::JUMP_IF_NOT_LTE:
+            case OpCode::JUMP_IF_NOT_GTE:
+            case OpCode::JUMP_IF_NOT_EQ:
+            case OpCode::JUMP_IF_NOT_NEQ: {
+                Loc a = stackAt(d - 2);
+                int reg = a.isReg ? a.reg : RAX;
+                if (!a.isReg) as.load(RAX, a);
+                as.cmp(reg, stackAt(d - 1));
+                branches.push_back({as.jcc(inverseBranchCond(instr.opcode)), instr.operand});
+                break;
+            }
+
+            case OpCode::STORE_LOAD_SLOT: {
+                Loc top = stackAt(d - 1);
+                as.move(slotAt(instr.aux), top);
+                as.modrm(false, {0xC6}, 0, Loc::mem(RBP, instr.aux));
+                as.byte(1);
+                as.move(top, slotAt(instr.operand));
+                break;
+            }
+
+            case OpCode::FOR_PREP:
+            case OpCode::FOR_LOOP: {
+                // The loop limit is the top of the stack (usually a register)
+                as.load(RAX, slotAt(instr.aux));
+                if (instr.opcode == OpCode::FOR_LOOP) {
+                    as.addRaxImm(1);
+                    errorSites.push_back({as.jcc(CC_O), JIT_OVERFLOW, pc});
+                    as.store(slotAt(instr.aux), RAX);
+                }
+                as.cmp(RAX, stackAt(d - 1));
+                branches.push_back({as.jcc(instr.opcode == OpCode::FOR_PREP ? CC_G : CC_LE),
+                                    instr.operand});
+                break;
+            }
+
+            case OpCode::PRINT: {
+                // Values below the printed one survive the call in the spill area
+                int live = std::min(d - 1, STACK_REG_COUNT);
+                as.load(RAX, stackAt(d - 1));
+                for (int p = 0; p < live; ++p) as.store(spillAt(p), STACK_REGS[p]);
+                as.modrm(true, {0x89}, RBX, Loc::r(RDI));                     // mov rdi, rbx
+                as.store(Loc::r(RSI), RAX);                                   // mov rsi, rax
+                as.bytes({0x48, 0xB8});                                       // mov rax, imm64
+                as.qword(reinterpret_cast<std::uint64_t>(&jitPrint));
+                as.bytes({0xFF, 0xD0});                                       // call rax
+                as.test32(RAX);
+                errorSites.push_back({as.jcc(CC_NE), JIT_PRINT_FAILED, pc});
+                for (int p = 0; p < live; ++p) as.load(STACK_REGS[p], spillAt(p));
+                break;
+            }
+
+            case OpCode::HALT: {
+                // Leave the stack in the spill area and say where to resume
+                // (a compiled loop's exits are HALTs carrying the program pc)
+                for (int p = 0; p < std::min(d, STACK_REG_COUNT); ++p) as.store(spillAt(p), STACK_REGS[p]);
+                as.moveImm32(Loc::mem(RBX, offsetof(JitContext, exitPc)), instr.operand);
+                as.moveImm32(Loc::mem(RBX, offsetof(JitContext, exitDepth)), d);
+                haltJumps.push_back(as.jmp());
+                break;
+            }
+        }
+    }
+
+    // Error stubs: record the error and drop the uncounted rest of the block
+    size_t commonError = 0;
+    std::vector<size_t> toCommonError;
+    for (const ErrorSite& site : errorSites) {
+        as.patch(site.at, as.offset());
+        as.byte(0xB8); as.dword(site.kind);                                   // mov eax, kind
+        as.byte(0xBA); as.dword(site.pc);                                     // mov edx, pc
+        as.byte(0xB9); as.dword(remaining[site.pc]);                          // mov ecx, uncounted
+        toCommonError.push_back(as.jmp());
+    }
+    commonError = as.offset();
+    for (size_t at : toCommonError) as.patch(at, commonError);
+    as.store32(Loc::mem(RBX, offsetof(JitContext, error)), RAX);
+    as.store32(Loc::mem(RBX, offsetof(JitContext, errorPc)), RDX);
+    as.modrm(true, {0x2B}, R13, Loc::r(RCX));                                 // sub r13, rcx
+
+    // Epilogue
+    size_t epilogue = as.offset();
+    for (size_t at : haltJumps) as.patch(at, epilogue);
+    as.modrm(true, {0x89}, R13, Loc::mem(RBX, offsetof(JitContext, instructionCount)));
+    as.bytes({0x48, 0x83, 0xC4, 0x08});                                       // add rsp, 8
+    as.bytes({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B});  // pop r15-r12, rbp, rbx
+    as.byte(0xC3);                                                            // ret
+
+    for (const Branch& branch : branches) {
+        as.patch(branch.at, pcOffset[branch.target]);
+    }
+
+    // Copy into a fresh mapping, then make it executable (never writable and executable)
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (as.code.size() + pageSize - 1) / pageSize * pageSize;
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(memory, as.code.data(), as.code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+    return std::make_unique<JitCode>(memory, size);
+#endif
+}
@@ -0,0 +1,93 @@
+#ifndef JIT_COMPILER_H
+#define JIT_COMPILER_H
+
+#include "../bytecode/BytecodeProgram.h"
+#include "../vm/OutputSink.h"
+#include <cstdint>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+
+struct JitContext;
+
+// Runtime services the generated code calls back into
+struct JitRuntime {
+    OutputSink* output = nullptr;
+    std::exception_ptr printError;    // Set when the sink threw during PRINT
+    
+    // Called at a backward jump once instructionCount reaches JitContext::checkpoint
+    // (only in code compiled with budget checks); returns true to stop, otherwise
+    // sets the next checkpoint. Must not throw.
+    std::function<bool(JitContext&)> budgetCheck;
+};
+
+// Error codes reported by generated code in JitContext::error
+enum JitError : std::int32_t {
+    JIT_OK = 0,
+    JIT_DIVISION_BY_ZERO = 1,
+    JIT_MODULO_BY_ZERO = 2,
+    JIT_PRINT_FAILED = 3,
+    JIT_BUDGET_EXCEEDED = 4,
+    JIT_OVERFLOW = 5
+};
+
+// State shared between the VM and generated code (read/written at fixed
+// offsets by the machine code, so keep it plain data)
+struct JitContext {
+    Value* slots;                // VirtualMachine frame
+    unsigned char* assigned;     // VirtualMachine assigned flags
+    Value* stack;                // Spill area, one value per verified stack position
+    JitRuntime* runtime;
+    std::int64_t instructionCount;
+    std::int32_t error;          // JitError
+    std::int32_t errorPc;        // Instruction that failed
+    std::int64_t checkpoint;     // Instruction count of the next budget check
+    std::int32_t exitPc;         // Operand of the HALT the run ended at
+    std::int32_t exitDepth;      // Stack depth there (values left in the spill area)
+};
+
+// Native code for one program; owns its executable mapping
+class JitCode {
+public:
+    JitCode(void* memory, size_t size) : memory(memory), codeSize(size) {}
+    ~JitCode();
+    JitCode(const JitCode&) = delete;
+    JitCode& operator=(const JitCode&) = delete;
+
+    size_t size() const { return codeSize; }
+
+    // Run to HALT or the first runtime error (see JitContext::error)
+    void run(JitContext& context) const;
+
+private:
+    void* memory;
+    size_t codeSize;
+};
+
+// Baseline template JIT: translates a verified BytecodeProgram into x86-64
+// machine code, one fixed template per opcode.
+//
+// The verifier guarantees the stack depth at every instruction, so each
+// operand stack position maps to a fixed location: the first six live in
+// registers, deeper ones in the spill area. Jumps become native branches;
+// PRINT and runtime errors call back into C++. Arithmetic is 64-bit and
+// branches on the overflow flag to the same error the interpreter raises.
+class JitCompiler {
+public:
+    // x86-64 with mmap (Linux, macOS, BSD); elsewhere callers use the interpreter
+    static bool isSupported();
+
+    // Emit a counter check before backward jumps (for VMs running with a budget)
+    void setBudgetChecks(bool enabled) { budgetChecks = enabled; }
+
+    // nullptr when the host is unsupported or the program is not verified.
+    // With an entry depth, the code starts with that many values already in
+    // the spill area (entering a loop compiled for on-stack replacement).
+    std::unique_ptr<JitCode> compile(const BytecodeProgram& program, int entryDepth = 0);
+
+private:
+    bool budgetChecks = false;
+};
+
+#endif
@@ -1,8 +1,283 @@
 #include "Lexer.h"
-#include <cctype>
+#include "SourceBuffer.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <utility>
 
-Lexer::Lexer(const std::string& source) 
-    : source(source), current(0), line(1), column(1) {}
+// SIMD run scanning needs GCC/Clang (per-function target attributes and
+// __builtin_cpu_supports) on x86-64; elsewhere only the scalar scanner exists
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define LEXER_USE_SIMD 1
+#include <immintrin.h>
+#else
+#define LEXER_USE_SIMD 0
+#endif
+
+namespace {
+
+// Character classes, one table load per test instead of range checks
+enum CharClass : uint8_t {
+    CHAR_DIGIT = 1 << 0,
+    CHAR_ALPHA = 1 << 1,    // Letters and '_'
+    CHAR_SPACE = 1 << 2,    // Whitespace other than '\n'
+    CHAR_NEWLINE = 1 << 3,
+    CHAR_IDENT = CHAR_DIGIT | CHAR_ALPHA,
+    CHAR_WHITESPACE = CHAR_SPACE | CHAR_NEWLINE
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+    std::array<uint8_t, 256> classes{};
+    for (int c = '0'; c <= '9'; ++c) classes[c] = CHAR_DIGIT;
+    for (int c = 'a'; c <= 'z'; ++c) classes[c] = CHAR_ALPHA;
+    for (int c = 'A'; c <= 'Z'; ++c) classes[c] = CHAR_ALPHA;
+    classes['_'] = CHAR_ALPHA;
+    classes[' '] = classes['\t'] = classes['\r'] = CHAR_SPACE;
+    classes['\n'] = CHAR_NEWLINE;
+    return classes;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = makeCharClasses();
+
+inline bool hasClass(char c, uint8_t mask) {
+    return (CHAR_CLASSES[static_cast<uint8_t>(c)] & mask) != 0;
+}
+
+// ===== Run Scanners =====
+// Each returns the first position in [p, end) whose character is outside
+// the class. The whitespace scanner also counts the newlines it passes.
+
+struct WhitespaceRun {
+    const char* end;
+    int newlines;
+    const char* lastNewline;    // nullptr if newlines == 0
+};
+
+const char* scalarRun(const char* p, const char* end, uint8_t mask) {
+    while (p < end && hasClass(*p, mask)) ++p;
+    return p;
+}
+
+const char* scalarIdentifier(const char* p, const char* end) {
+    return scalarRun(p, end, CHAR_IDENT);
+}
+
+const char* scalarDigits(const char* p, const char* end) {
+    return scalarRun(p, end, CHAR_DIGIT);
+}
+
+// Continues a run that a vector scanner may have started
+WhitespaceRun finishWhitespace(WhitespaceRun run, const char* end) {
+    while (run.end < end && hasClass(*run.end, CHAR_WHITESPACE)) {
+        if (*run.end == '\n') {
+            ++run.newlines;
+            run.lastNewline = run.end;
+        }
+        ++run.end;
+    }
+    return run;
+}
+
+WhitespaceRun scalarWhitespace(const char* p, const char* end) {
+    return finishWhitespace({p, 0, nullptr}, end);
+}
+
+#if LEXER_USE_SIMD
+
+// SSE2 has only signed byte compares; biasing by 0x80 - lo maps [lo, hi]
+// onto [-128, -128 + hi - lo] so one compare tests the unsigned range
+inline __m128i inRange16(__m128i c, char lo, char hi) {
+    __m128i biased = _mm_add_epi8(c, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm_cmplt_epi8(biased, _mm_set1_epi8(static_cast<char>(0x80 + hi - lo + 1)));
+}
+
+inline __m128i isIdentifier16(__m128i c) {
+    __m128i letter = inRange16(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i digit = inRange16(c, '0', '9');
+    return _mm_or_si128(_mm_or_si128(letter, digit), _mm_cmpeq_epi8(c, _mm_set1_epi8('_')));
+}
+
+inline __m128i isWhitespace16(__m128i c) {
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\t')));
+    __m128i breaks = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(c, _mm_set1_epi8('\n')));
+    return _mm_or_si128(space, breaks);
+}
+
+inline __m128i load16(const char* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+const char* sse2Identifier(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned outside = ~_mm_movemask_epi8(isIdentifier16(load16(p))) & 0xFFFFu;
+        if (outside) return p + __builtin_ctz(outside);
+    }
+    return scalarIdentifier(p, end);
+}
+
+const char* sse2Digits(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned outside = ~_mm_movemask_epi8(inRange16(load16(p), '0', '9')) & 0xFFFFu;
+        if (outside) return p + __builtin_ctz(outside);
+    }
+    return scalarDigits(p, end);
+}
+
+WhitespaceRun sse2Whitespace(const char* p, const char* end) {
+    WhitespaceRun run{p, 0, nullptr};
+    while (end - run.end >= 16) {
+        __m128i chunk = load16(run.end);
+        unsigned outside = ~_mm_movemask_epi8(isWhitespace16(chunk)) & 0xFFFFu;
+        unsigned length = outside ? __builtin_ctz(outside) : 16;
+        unsigned newlines = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))) &
+                            ((1u << length) - 1);
+        if (newlines) {
+            run.newlines += __builtin_popcount(newlines);
+            run.lastNewline = run.end + (31 - __builtin_clz(newlines));
+        }
+        run.end += length;
+        if (outside) return run;
+    }
+    return finishWhitespace(run, end);
+}
+
+// The AVX2 versions are the same tests 32 bytes at a time
+#define LEXER_AVX2 __attribute__((target("avx2")))
+
+LEXER_AVX2 inline __m256i inRange32(__m256i c, char lo, char hi) {
+    __m256i biased = _mm256_add_epi8(c, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + hi - lo + 1)), biased);
+}
+
+LEXER_AVX2 inline __m256i isIdentifier32(__m256i c) {
+    __m256i letter = inRange32(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i digit = inRange32(c, '0', '9');
+    return _mm256_or_si256(_mm256_or_si256(letter, digit), _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_')));
+}
+
+LEXER_AVX2 inline __m256i isWhitespace32(__m256i c) {
+    __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+                                    _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t')));
+    __m256i breaks = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r')),
+                                     _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n')));
+    return _mm256_or_si256(space, breaks);
+}
+
+LEXER_AVX2 inline __m256i load32(const char* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+LEXER_AVX2 const char* avx2Identifier(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned outside = ~static_cast<unsigned>(_mm256_movemask_epi8(isIdentifier32(load32(p))));
+        if (outside) return p + __builtin_ctz(outside);
+    }
+    return sse2Identifier(p, end);
+}
+
+LEXER_AVX2 const char* avx2Digits(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned outside = ~static_cast<unsigned>(_mm256_movemask_epi8(inRange32(load32(p), '0', '9')));
+        if (outside) return p + __builtin_ctz(outside);
+    }
+    return sse2Digits(p, end);
+}
+
+LEXER_AVX2 WhitespaceRun avx2Whitespace(const char* p, const char* end) {
+    WhitespaceRun run{p, 0, nullptr};
+    while (end - run.end >= 32) {
+        __m256i chunk = load32(run.end);
+        unsigned outside = ~static_cast<unsigned>(_mm256_movemask_epi8(isWhitespace32(chunk)));
+        unsigned length = outside ? __builtin_ctz(outside) : 32;
+        unsigned newlines = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))));
+        if (length < 32) newlines &= (1u << length) - 1;
+        if (newlines) {
+            run.newlines += __builtin_popcount(newlines);
+            run.lastNewline = run.end + (31 - __builtin_clz(newlines));
+        }
+        run.end += length;
+        if (outside) return run;
+    }
+    WhitespaceRun rest = sse2Whitespace(run.end, end);
+    if (rest.newlines) {
+        run.newlines += rest.newlines;
+        run.lastNewline = rest.lastNewline;
+    }
+    run.end = rest.end;
+    return run;
+}
+
+#undef LEXER_AVX2
+
+#endif // LEXER_USE_SIMD
+
+// -1 until the first Lexer picks the best scanner for this CPU
+std::atomic<int> selectedScanner{-1};
+
+} // namespace
+
+struct Lexer::RunScanners {
+    const char* (*identifier)(const char* p, const char* end);
+    const char* (*digits)(const char* p, const char* end);
+    WhitespaceRun (*whitespace)(const char* p, const char* end);
+};
+
+#if LEXER_USE_SIMD
+const Lexer::RunScanners Lexer::SCANNERS[] = {
+    {scalarIdentifier, scalarDigits, scalarWhitespace},
+    {sse2Identifier, sse2Digits, sse2Whitespace},
+    {avx2Identifier, avx2Digits, avx2Whitespace},
+};
+#else
+const Lexer::RunScanners Lexer::SCANNERS[] = {
+    {scalarIdentifier, scalarDigits, scalarWhitespace},
+};
+#endif
+
+bool Lexer::isSupported(Scanner scanner) {
+    switch (scanner) {
+        case Scanner::SCALAR: return true;
+#if LEXER_USE_SIMD
+        case Scanner::SSE2:   return true;      // Part of x86-64
+        case Scanner::AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+        default:              return false;
+    }
+}
+
+Lexer::Scanner Lexer::getScanner() {
+    int selected = selectedScanner.load(std::memory_order_relaxed);
+    if (selected < 0) {
+        Scanner best = isSupported(Scanner::AVX2) ? Scanner::AVX2
+                     : isSupported(Scanner::SSE2) ? Scanner::SSE2 : Scanner::SCALAR;
+        selected = static_cast<int>(best);
+        selectedScanner.store(selected, std::memory_order_relaxed);
+    }
+    return static_cast<Scanner>(selected);
+}
+
+bool Lexer::setScanner(Scanner scanner) {
+    if (!isSupported(scanner)) return false;
+    selectedScanner.store(static_cast<int>(scanner), std::memory_order_relaxed);
+    return true;
+}
+
+const char* Lexer::scannerName(Scanner scanner) {
+    switch (scanner) {
+        case Scanner::SCALAR: return "scalar";
+        case Scanner::SSE2:   return "sse2";
+        case Scanner::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+Lexer::Lexer(std::string text) 
+    : owned(std::move(text)), source(owned), current(0), line(1), column(1),
+      scanners(&SCANNERS[static_cast<size_t>(getScanner())]) {}
+
+Lexer::Lexer(const SourceBuffer& buffer) 
+    : source(buffer.text()), current(0), line(1), column(1),
+      scanners(&SCANNERS[static_cast<size_t>(getScanner())]) {}
 
 bool Lexer::isAtEnd() const {
     return current >= source.length();
@@ -26,80 +301,58 @@ char Lexer::peekNext() const {
 }
 
 void Lexer::skipWhitespace() {
-    while (!isAtEnd()) {
-        char c = peek();
-        switch (c) {
-            case ' ':
-            case '\r':
-            case '\t':
-                advance();
-                break;
-            case '\n':
-                advance();
-                line++;
-                column = 1;
-                break;
-            default:
-                return;
-        }
+    const char* start = source.data() + current;
+    const char* end = source.data() + source.size();
+    
+    // Most gaps between tokens are a single space; only longer runs (line
+    // breaks and indentation) go to the run scanner
+    if (start == end || !hasClass(*start, CHAR_WHITESPACE)) return;
+    if (*start == ' ' && (start + 1 == end || !hasClass(start[1], CHAR_WHITESPACE))) {
+        ++current;
+        ++column;
+        return;
+    }
+    
+    WhitespaceRun run = scanners->whitespace(start, end);
+    current = run.end - source.data();
+    if (run.newlines > 0) {
+        line += run.newlines;
+        column = static_cast<int>(run.end - run.lastNewline);
+    } else {
+        column += static_cast<int>(run.end - start);
     }
 }
 
-bool Lexer::isDigit(char c) const {
-    return c >= '0' && c <= '9';
-}
-
-bool Lexer::isAlpha(char c) const {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
-}
-
-bool Lexer::isAlphaNumeric(char c) const {
-    return isAlpha(c) || isDigit(c);
-}
-
-Token Lexer::makeToken(TokenType type, const std::string& lexeme) {
-    return Token(type, lexeme, line, column - lexeme.length());
+// The lexeme is the source text from start to the current position
+Token Lexer::makeToken(TokenType type, size_t start, int startColumn) const {
+    return Token(type, std::string_view(source.data() + start, current - start), line, startColumn);
 }
 
 Token Lexer::readNumber() {
+    size_t start = current;
     int startColumn = column;
-    std::string number;
     
-    while (isDigit(peek())) {
-        number += advance();
-    }
+    const char* end = source.data() + source.size();
+    current = scanners->digits(source.data() + current, end) - source.data();
+    column += static_cast<int>(current - start);
     
-    return Token(TokenType::INTEGER, number, line, startColumn);
+    return makeToken(TokenType::INTEGER, start, startColumn);
 }
 
 Token Lexer::readIdentifierOrKeyword() {
+    size_t start = current;
     int startColumn = column;
-    std::string identifier;
-    
-    while (isAlphaNumeric(peek())) {
-        identifier += advance();
-    }
     
-    // Check for keywords
-    TokenType type = TokenType::IDENTIFIER;
-    if (identifier == "let") {
-        type = TokenType::LET;
-    } else if (identifier == "print") {
-        type = TokenType::PRINT;
-    } else if (identifier == "if") {
-        type = TokenType::IF;
-    } else if (identifier == "else") {
-        type = TokenType::ELSE;
-    } else if (identifier == "for") {
-        type = TokenType::FOR;
-    } else if (identifier == "to") {
-        type = TokenType::TO;
-    }
+    // The first character is already known to be a letter or '_'
+    const char* end = source.data() + source.size();
+    current = scanners->identifier(source.data() + current + 1, end) - source.data();
+    column += static_cast<int>(current - start);
+    std::string_view identifier(source.data() + start, current - start);
     
-    return Token(type, identifier, line, startColumn);
+    return makeToken(lookupKeyword(identifier), start, startColumn);
 }
 
-Token Lexer::nextToken() {
+Token Lexer::scanToken() {
     skipWhitespace();
     
     if (isAtEnd()) {
@@ -107,95 +360,86 @@ Token Lexer::nextToken() {
     }
     
     char c = peek();
+    size_t start = current;
     int startColumn = column;
     
     // Numbers
-    if (isDigit(c)) {
+    if (hasClass(c, CHAR_DIGIT)) {
         return readNumber();
     }
     
     // Identifiers and keywords
-    if (isAlpha(c)) {
+    if (hasClass(c, CHAR_ALPHA)) {
         return readIdentifierOrKeyword();
     }
     
     // Operators and punctuation
     advance();
     switch (c) {
-        case '+': return Token(TokenType::PLUS, "+", line, startColumn);
-        case '-': return Token(TokenType::MINUS, "-", line, startColumn);
-        case '*': return Token(TokenType::MULTIPLY, "*", line, startColumn);
-        case '/': return Token(TokenType::DIVIDE, "/", line, startColumn);
-        case '%': return Token(TokenType::MODULO, "%", line, startColumn);
-        case '(': return Token(TokenType::LPAREN, "(", line, startColumn);
-        case ')': return Token(TokenType::RPAREN, ")", line, startColumn);
-        case '{': return Token(TokenType::LBRACE, "{", line, startColumn);
-        case '}': return Token(TokenType::RBRACE, "}", line, startColumn);
-        case ';': return Token(TokenType::SEMICOLON, ";", line, startColumn);
+        case '+': return makeToken(TokenType::PLUS, start, startColumn);
+        case '-': return makeToken(TokenType::MINUS, start, startColumn);
+        case '*': return makeToken(TokenType::MULTIPLY, start, startColumn);
+        case '/': return makeToken(TokenType::DIVIDE, start, startColumn);
+        case '%': return makeToken(TokenType::MODULO, start, startColumn);
+        case '(': return makeToken(TokenType::LPAREN, start, startColumn);
+        case ')': return makeToken(TokenType::RPAREN, start, startColumn);
+        case '{': return makeToken(TokenType::LBRACE, start, startColumn);
+        case '}': return makeToken(TokenType::RBRACE, start, startColumn);
+        case ';': return makeToken(TokenType::SEMICOLON, start, startColumn);
         
         // Two-character operators
         case '=':
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::EQUAL_EQUAL, "==", line, startColumn);
+                return makeToken(TokenType::EQUAL_EQUAL, start, startColumn);
             }
-            return Token(TokenType::ASSIGN, "=", line, startColumn);
+            return makeToken(TokenType::ASSIGN, start, startColumn);
         
         case '<':
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::LESS_EQUAL, "<=", line, startColumn);
+                return makeToken(TokenType::LESS_EQUAL, start, startColumn);
             }
-            return Token(TokenType::LESS_THAN, "<", line, startColumn);
+            return makeToken(TokenType::LESS_THAN, start, startColumn);
         
         case '>':
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::GREATER_EQUAL, ">=", line, startColumn);
+                return makeToken(TokenType::GREATER_EQUAL, start, startColumn);
             }
-            return Token(TokenType::GREATER_THAN, ">", line, startColumn);
+            return makeToken(TokenType::GREATER_THAN, start, startColumn);
         
         case '!':
             if (peek() == '=') {
                 advance();
-                return Token(TokenType::NOT_EQUAL, "!=", line, startColumn);
+                return makeToken(TokenType::NOT_EQUAL, start, startColumn);
             }
-            return Token(TokenType::NOT, "!", line, startColumn);
+            return makeToken(TokenType::NOT, start, startColumn);
         
         case '&':
             if (peek() == '&') {
                 advance();
-                return Token(TokenType::AND, "&&", line, startColumn);
+                return makeToken(TokenType::AND, start, startColumn);
             }
-            return Token(TokenType::INVALID, "&", line, startColumn);
+            return makeToken(TokenType::INVALID, start, startColumn);
         
         case '|':
             if (peek() == '|') {
                 advance();
-                return Token(TokenType::OR, "||", line, startColumn);
+                return makeToken(TokenType::OR, start, startColumn);
             }
-            return Token(TokenType::INVALID, "|", line, startColumn);
+            return makeToken(TokenType::INVALID, start, startColumn);
         
         default:
-            return Token(TokenType::INVALID, std::string(1, c), line, startColumn);
+            return makeToken(TokenType::INVALID, start, startColumn);
     }
 }
 
-Token Lexer::peekToken() {
-    // Save current state
-    size_t savedCurrent = current;
-    int savedLine = line;
-    int savedColumn = column;
-    
-    // Get next token
-    Token token = nextToken();
-    
-    // Restore state
-    current = savedCurrent;
-    line = savedLine;
-    column = savedColumn;
-    
-    return token;
+void Lexer::fillLookahead(size_t ahead) {
+    while (buffered <= ahead) {
+        lookahead[(head + buffered) & (LOOKAHEAD - 1)] = scanToken();
+        ++buffered;
+    }
 }
 
 std::vector<Token> Lexer::getAllTokens() {
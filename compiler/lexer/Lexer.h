@@ -3,26 +3,65 @@
 
 #include "Token.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
+class SourceBuffer;
+
+// Tokens point into the source text (see Token): the lexer's own copy of a
+// string, or a SourceBuffer lexed in place. The lexer (and the buffer) must
+// outlive every token it returns; the lexer cannot be copied or moved.
+//
+// Tokens are produced on demand: the Parser pulls them one at a time, and
+// peeking scans ahead into a small ring buffer, so memory for tokens stays
+// constant however long the source is.
 class Lexer {
 public:
-    explicit Lexer(const std::string& source);
+    static constexpr size_t LOOKAHEAD = 4;      // Ring buffer size
+    static_assert((LOOKAHEAD & (LOOKAHEAD - 1)) == 0, "LOOKAHEAD must be a power of two");
+    
+    explicit Lexer(std::string source);
+    explicit Lexer(const SourceBuffer& buffer);     // No copy of the text
+    Lexer(SourceBuffer&&) = delete;                 // Tokens would outlive a temporary buffer
+    Lexer(const Lexer&) = delete;
+    Lexer& operator=(const Lexer&) = delete;
     
-    // Get the next token from the source
+    // Get the next token from the source (END_OF_FILE repeats at the end)
     Token nextToken();
     
-    // Peek at the next token without consuming it
-    Token peekToken();
+    // Look at a token without consuming it (ahead < LOOKAHEAD); the
+    // reference is valid until the next nextToken()
+    const Token& peekToken(size_t ahead = 0);
     
-    // Get all tokens at once
+    // Get all remaining tokens at once (for token listings; the Parser streams)
     std::vector<Token> getAllTokens();
     
+    // Implementations for finding the end of whitespace, identifier and
+    // digit runs. The best one the CPU supports is chosen at startup;
+    // setScanner (for tests and benchmarks) affects Lexers created after it.
+    enum class Scanner { SCALAR, SSE2, AVX2 };
+    static bool isSupported(Scanner scanner);
+    static Scanner getScanner();
+    static bool setScanner(Scanner scanner);    // False if unsupported
+    static const char* scannerName(Scanner scanner);
+    
 private:
-    std::string source;
+    struct RunScanners;
+    static const RunScanners SCANNERS[];
+    
+    std::string owned;          // The copied text, when built from a string
+    std::string_view source;
     size_t current;
     int line;
     int column;
+    const RunScanners* scanners;
+    
+    Token lookahead[LOOKAHEAD];    // Scanned but not yet consumed, from head
+    size_t head = 0;
+    size_t buffered = 0;
+    
+    Token scanToken();
+    void fillLookahead(size_t ahead);
     
     // Helper methods
     bool isAtEnd() const;
@@ -32,10 +71,26 @@ private:
     void skipWhitespace();
     Token readNumber();
     Token readIdentifierOrKeyword();
-    Token makeToken(TokenType type, const std::string& lexeme);
-    bool isDigit(char c) const;
-    bool isAlpha(char c) const;
-    bool isAlphaNumeric(char c) const;
+    Token makeToken(TokenType type, size_t start, int startColumn) const;
 };
 
+// The lookahead accessors are called several times per token by the Parser,
+// so the buffered case stays inline
+inline Token Lexer::nextToken() {
+    if (buffered == 0) {
+        return scanToken();
+    }
+    Token token = lookahead[head];
+    head = (head + 1) & (LOOKAHEAD - 1);
+    --buffered;
+    return token;
+}
+
+inline const Token& Lexer::peekToken(size_t ahead) {
+    if (buffered <= ahead) {
+        fillLookahead(ahead);
+    }
+    return lookahead[(head + ahead) & (LOOKAHEAD - 1)];
+}
+
 #endif
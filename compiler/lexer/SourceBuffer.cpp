@@ -0,0 +1,159 @@
+#include "SourceBuffer.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_USE_MMAP 1
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SOURCE_USE_MMAP 0
+#endif
+
+namespace {
+
+// Reads grow one buffer in steps of at least this much
+constexpr size_t READ_CHUNK = 1 << 20;
+
+// Make room for at least READ_CHUNK more bytes after size, doubling so that
+// large inputs are not copied once per chunk
+void reserveChunk(std::string& text, size_t size) {
+    if (text.size() < size + READ_CHUNK) {
+        text.resize(std::max(text.size() * 2, size + READ_CHUNK));
+    }
+}
+
+#if SOURCE_USE_MMAP
+std::string readDescriptor(int fd) {
+    std::string text;
+    size_t size = 0;
+    while (true) {
+        reserveChunk(text, size);
+        ssize_t count = ::read(fd, &text[size], text.size() - size);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) break;
+        size += static_cast<size_t>(count);
+    }
+    text.resize(size);
+    return text;
+}
+#endif
+
+} // namespace
+
+SourceBuffer::SourceBuffer(std::string text)
+    : owned(std::move(text)), view(owned) {}
+
+SourceBuffer::SourceBuffer(SourceBuffer&& other) noexcept
+    : owned(std::move(other.owned)), mapping(other.mapping), mappedSize(other.mappedSize) {
+    view = mapping ? other.view : std::string_view(owned);
+    other.mapping = nullptr;
+    other.mappedSize = 0;
+    other.view = std::string_view();
+}
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        owned = std::move(other.owned);
+        mapping = other.mapping;
+        mappedSize = other.mappedSize;
+        view = mapping ? other.view : std::string_view(owned);
+        other.mapping = nullptr;
+        other.mappedSize = 0;
+        other.view = std::string_view();
+    }
+    return *this;
+}
+
+SourceBuffer::~SourceBuffer() {
+    unmap();
+}
+
+void SourceBuffer::unmap() {
+#if SOURCE_USE_MMAP
+    if (mapping) munmap(mapping, mappedSize);
+#endif
+    mapping = nullptr;
+    mappedSize = 0;
+}
+
+bool SourceBuffer::mapDescriptor(int fd) {
+#if SOURCE_USE_MMAP
+    // Only regular files can be mapped; pipes and terminals are read instead
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) return false;
+
+    // Start wherever the descriptor is positioned (stdin may be part-read)
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    if (offset < 0) offset = 0;
+    size_t size = static_cast<size_t>(info.st_size);
+    if (static_cast<size_t>(offset) >= size) {
+        view = std::string_view(owned);     // Empty; nothing to map
+        return true;
+    }
+
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) return false;
+    madvise(address, size, MADV_SEQUENTIAL);    // The lexer reads front to back
+
+    mapping = address;
+    mappedSize = size;
+    view = std::string_view(static_cast<const char*>(address) + offset, size - static_cast<size_t>(offset));
+    return true;
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+SourceBuffer SourceBuffer::mapFile(const std::string& path) {
+#if SOURCE_USE_MMAP
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    SourceBuffer buffer;
+    if (!buffer.mapDescriptor(fd)) {
+        buffer = SourceBuffer(readDescriptor(fd));
+    }
+    close(fd);      // The mapping stays valid without the descriptor
+    return buffer;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    return readStream(file);
+#endif
+}
+
+SourceBuffer SourceBuffer::readStdin() {
+#if SOURCE_USE_MMAP
+    SourceBuffer buffer;
+    if (!buffer.mapDescriptor(STDIN_FILENO)) {
+        buffer = SourceBuffer(readDescriptor(STDIN_FILENO));
+    }
+    return buffer;
+#else
+    return readStream(std::cin);
+#endif
+}
+
+SourceBuffer SourceBuffer::readStream(std::istream& in) {
+    std::string text;
+    size_t size = 0;
+    while (in) {
+        reserveChunk(text, size);
+        in.read(&text[size], static_cast<std::streamsize>(text.size() - size));
+        size += static_cast<size_t>(in.gcount());
+    }
+    text.resize(size);
+    return SourceBuffer(std::move(text));
+}
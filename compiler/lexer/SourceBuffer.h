@@ -0,0 +1,46 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <string_view>
+
+// Program text for the Lexer. A file is memory-mapped read-only where the
+// platform allows it, and other input is read in bulk into one buffer, so
+// the text is never copied line by line; a Lexer built from a SourceBuffer
+// lexes it in place. The buffer must outlive that Lexer and its tokens.
+class SourceBuffer {
+public:
+    // Map a file (or read it whole where mapping is unavailable); throws
+    // std::runtime_error if it cannot be opened
+    static SourceBuffer mapFile(const std::string& path);
+
+    // Read all of standard input: mapped if it is redirected from a file,
+    // otherwise read in large chunks
+    static SourceBuffer readStdin();
+
+    // Read the rest of a stream in large chunks
+    static SourceBuffer readStream(std::istream& in);
+
+    explicit SourceBuffer(std::string text = std::string());
+    SourceBuffer(SourceBuffer&& other) noexcept;
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    ~SourceBuffer();
+
+    std::string_view text() const { return view; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    std::string owned;          // Text read into memory, if not mapped
+    void* mapping = nullptr;    // Start of the mapping, if mapped
+    size_t mappedSize = 0;
+    std::string_view view;      // The program text, in owned or the mapping
+
+    void unmap();
+    bool mapDescriptor(int fd);     // False if fd cannot be mapped
+};
+
+#endif
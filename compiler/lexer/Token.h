@@ -1,7 +1,11 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <ostream>
 
 enum class TokenType {
@@ -50,18 +54,123 @@ enum class TokenType {
     INVALID
 };
 
+// A token's lexeme is a view into the Lexer's source buffer, so tokens are
+// cheap to copy but only valid while that Lexer is alive
 struct Token {
     TokenType type;
-    std::string lexeme;
+    std::string_view lexeme;
     int line;
     int column;
     
-    Token(TokenType t, const std::string& lex, int ln, int col)
+    Token(TokenType t, std::string_view lex, int ln, int col)
         : type(t), lexeme(lex), line(ln), column(col) {}
     
     Token() : type(TokenType::INVALID), lexeme(""), line(0), column(0) {}
 };
 
+// ===== Keywords =====
+
+struct Keyword {
+    std::string_view spelling;
+    TokenType type;
+};
+
+// To add a keyword, add its TokenType above and a row here; the hash table
+// below is regenerated at compile time
+inline constexpr Keyword KEYWORDS[] = {
+    {"let",   TokenType::LET},
+    {"print", TokenType::PRINT},
+    {"if",    TokenType::IF},
+    {"else",  TokenType::ELSE},
+    {"for",   TokenType::FOR},
+    {"to",    TokenType::TO},
+};
+
+// Perfect hash over KEYWORDS: a seeded FNV-1a hash indexes a table at least
+// four times the keyword count (so a collision-free seed turns up quickly),
+// and the first such seed is found at compile time. A lookup is a length
+// check, one hash and one string compare.
+namespace keyword_hash {
+
+constexpr size_t COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+
+constexpr size_t tableSize() {
+    size_t size = 1;
+    while (size < 4 * COUNT) size <<= 1;
+    return size;
+}
+constexpr size_t TABLE_SIZE = tableSize();
+
+constexpr size_t minLength() {
+    size_t length = KEYWORDS[0].spelling.size();
+    for (const Keyword& keyword : KEYWORDS) length = std::min(length, keyword.spelling.size());
+    return length;
+}
+constexpr size_t maxLength() {
+    size_t length = 0;
+    for (const Keyword& keyword : KEYWORDS) length = std::max(length, keyword.spelling.size());
+    return length;
+}
+constexpr size_t MIN_LENGTH = minLength();
+constexpr size_t MAX_LENGTH = maxLength();
+
+constexpr uint32_t hash(std::string_view word, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : word) {
+        h = (h ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return (h ^ (h >> 16)) & (TABLE_SIZE - 1);
+}
+
+struct Table {
+    uint32_t seed = 0;                      // 0 if no seed was found
+    std::array<uint8_t, TABLE_SIZE> slots{}; // Keyword index + 1, or 0 if empty
+};
+
+constexpr Table build() {
+    for (uint32_t seed = 1; seed < 100000; ++seed) {
+        Table table;
+        table.seed = seed;
+        bool collision = false;
+        for (size_t i = 0; i < COUNT && !collision; ++i) {
+            uint8_t& slot = table.slots[hash(KEYWORDS[i].spelling, seed)];
+            collision = slot != 0;
+            slot = static_cast<uint8_t>(i + 1);
+        }
+        if (!collision) return table;
+    }
+    return Table{};
+}
+
+inline constexpr Table TABLE = build();
+static_assert(TABLE.seed != 0, "No collision-free keyword hash; change hash() or enlarge TABLE_SIZE");
+static_assert(COUNT < 255, "Keyword slots are 8-bit");
+
+} // namespace keyword_hash
+
+// The keyword spelled by word, or IDENTIFIER
+constexpr TokenType lookupKeyword(std::string_view word) {
+    using namespace keyword_hash;
+    if (word.size() < MIN_LENGTH || word.size() > MAX_LENGTH) {
+        return TokenType::IDENTIFIER;
+    }
+    uint8_t slot = TABLE.slots[hash(word, TABLE.seed)];
+    if (slot != 0 && KEYWORDS[slot - 1].spelling == word) {
+        return KEYWORDS[slot - 1].type;
+    }
+    return TokenType::IDENTIFIER;
+}
+
+namespace keyword_hash {
+constexpr bool findsEveryKeyword() {
+    for (const Keyword& keyword : KEYWORDS) {
+        if (lookupKeyword(keyword.spelling) != keyword.type) return false;
+    }
+    return true;
+}
+static_assert(findsEveryKeyword(), "Keyword table lookup is broken");
+} // namespace keyword_hash
+
 inline std::string tokenTypeToString(TokenType type) {
     switch (type) {
         case TokenType::INTEGER:     return "INTEGER";
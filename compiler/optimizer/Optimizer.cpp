@@ -80,7 +80,7 @@ bool Optimizer::isConstant(Expression* expr) {
     return dynamic_cast<IntegerLiteral*>(expr) != nullptr;
 }
 
-int Optimizer::evaluateConstant(Expression* expr) {
+Value Optimizer::evaluateConstant(Expression* expr) {
     if (auto* intLit = dynamic_cast<IntegerLiteral*>(expr)) {
         return intLit->value;
     }
@@ -88,26 +88,25 @@ int Optimizer::evaluateConstant(Expression* expr) {
 }
 
 std::unique_ptr<Expression> Optimizer::foldConstants(BinaryOperation* expr) {
-    int left = evaluateConstant(expr->left.get());
-    int right = evaluateConstant(expr->right.get());
-    int result = 0;
+    Value left = evaluateConstant(expr->left.get());
+    Value right = evaluateConstant(expr->right.get());
+    Value result = 0;
     
-    // Evaluate the operation
+    // Evaluate the operation with the VM's checked arithmetic; an overflow
+    // is left unfolded so that it raises the same runtime error
     if (expr->op == "+") {
-        result = left + right;
+        if (addOverflows(left, right, result)) return nullptr;
     } else if (expr->op == "-") {
-        result = left - right;
+        if (subOverflows(left, right, result)) return nullptr;
     } else if (expr->op == "*") {
-        result = left * right;
+        if (mulOverflows(left, right, result)) return nullptr;
     } else if (expr->op == "/") {
-        if (right != 0) {
-            result = left / right;
-        } else {
-            return nullptr; // Don't optimize division by zero
+        if (right == 0 || divOverflows(left, right, result)) {
+            return nullptr; // Don't optimize division by zero or overflow
         }
     } else if (expr->op == "%") {
         if (right != 0) {
-            result = left % right;
+            result = checkedRemainder(left, right);
         } else {
             return nullptr;
         }
@@ -19,7 +19,7 @@ public:
     
 private:
     int optimizationCount = 0;
-    std::unordered_map<std::string, int> constantValues; // For constant propagation
+    std::unordered_map<std::string, Value> constantValues; // For constant propagation
     
     // Optimization passes
     void optimizeStatement(Statement* stmt);
@@ -32,7 +32,7 @@ private:
     
     // Helper functions
     bool isConstant(Expression* expr);
-    int evaluateConstant(Expression* expr);
+    Value evaluateConstant(Expression* expr);
     std::unique_ptr<Expression> foldConstants(BinaryOperation* expr);
 };
 
@@ -36,7 +36,7 @@ void PrintStatement::print(int indent) const {
 }
 
 // IntegerLiteral implementation
-IntegerLiteral::IntegerLiteral(int val) : value(val) {}
+IntegerLiteral::IntegerLiteral(Value val) : value(val) {}
 
 void IntegerLiteral::print(int indent) const {
     printIndent(indent);
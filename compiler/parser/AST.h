@@ -1,6 +1,7 @@
 #ifndef AST_H
 #define AST_H
 
+#include "../bytecode/Value.h"
 #include <string>
 #include <memory>
 #include <vector>
@@ -20,6 +21,8 @@ public:
 // Base class for statements
 class Statement : public ASTNode {
 public:
+    int startLine = 0;  // Source line of the statement's first token (0 = unknown)
+    
     virtual ~Statement() = default;
 };
 
@@ -34,7 +37,7 @@ class LetStatement : public Statement {
 public:
     std::string identifier;
     std::unique_ptr<Expression> expression;
-    int line;
+    int line;       // Position of the identifier
     int column;
     
     LetStatement(const std::string& id, std::unique_ptr<Expression> expr, int ln, int col);
@@ -53,9 +56,9 @@ public:
 // Expression: integer literal
 class IntegerLiteral : public Expression {
 public:
-    int value;
+    Value value;
     
-    explicit IntegerLiteral(int val);
+    explicit IntegerLiteral(Value val);
     void print(int indent = 0) const override;
 };
 
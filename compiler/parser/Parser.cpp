@@ -1,21 +1,34 @@
 #include "Parser.h"
 #include <sstream>
+#include <charconv>
+#include <utility>
 
-Parser::Parser(const std::vector<Token>& tokens) 
-    : tokens(tokens), current(0) {}
+Parser::Parser(Lexer& lexer) 
+    : lexer(&lexer) {}
+
+Parser::Parser(std::vector<Token> tokens) 
+    : tokens(std::move(tokens)) {}
 
 // ===== Helper Methods =====
 
-Token Parser::peek() const {
+const Token& Parser::peek() const {
+    if (lexer) return lexer->peekToken();
     return tokens[current];
 }
 
-Token Parser::previous() const {
+const Token& Parser::previous() const {
+    if (lexer) return last;
     return tokens[current - 1];
 }
 
-Token Parser::advance() {
-    if (!isAtEnd()) current++;
+const Token& Parser::advance() {
+    if (!isAtEnd()) {
+        if (lexer) {
+            last = lexer->nextToken();
+        } else {
+            current++;
+        }
+    }
     return previous();
 }
 
@@ -36,14 +49,14 @@ bool Parser::match(TokenType type) {
     return false;
 }
 
-Token Parser::expect(TokenType type, const std::string& message) {
+const Token& Parser::expect(TokenType type, const std::string& message) {
     if (check(type)) return advance();
     error(message);
     return peek(); // Never reached due to exception
 }
 
 void Parser::error(const std::string& message) {
-    Token current = peek();
+    const Token& current = peek();
     std::ostringstream oss;
     oss << message << " at line " << current.line << ", column " << current.column;
     throw ParserError(oss.str(), current.line, current.column);
@@ -64,21 +77,24 @@ std::vector<std::unique_ptr<Statement>> Parser::parse() {
 // ===== Statement Parsing =====
 
 std::unique_ptr<Statement> Parser::parseStatement() {
+    // Statements remember the line of their keyword (used for the bytecode line table)
+    int line = peek().line;
+    std::unique_ptr<Statement> stmt;
+    
     if (match(TokenType::LET)) {
-        return parseLetStatement();
-    }
-    if (match(TokenType::PRINT)) {
-        return parsePrintStatement();
-    }
-    if (match(TokenType::IF)) {
-        return parseIfStatement();
-    }
-    if (match(TokenType::FOR)) {
-        return parseForStatement();
+        stmt = parseLetStatement();
+    } else if (match(TokenType::PRINT)) {
+        stmt = parsePrintStatement();
+    } else if (match(TokenType::IF)) {
+        stmt = parseIfStatement();
+    } else if (match(TokenType::FOR)) {
+        stmt = parseForStatement();
+    } else {
+        error("Expected statement (let, print, if, or for)");
     }
     
-    error("Expected statement (let, print, if, or for)");
-    return nullptr; // Never reached
+    stmt->startLine = line;
+    return stmt;
 }
 
 std::unique_ptr<Statement> Parser::parseLetStatement() {
@@ -89,7 +105,7 @@ std::unique_ptr<Statement> Parser::parseLetStatement() {
     
     expect(TokenType::SEMICOLON, "Expected ';' after expression");
     
-    return std::make_unique<LetStatement>(identifier.lexeme, std::move(expression), 
+    return std::make_unique<LetStatement>(std::string(identifier.lexeme), std::move(expression), 
                                           identifier.line, identifier.column);
 }
 
@@ -111,7 +127,7 @@ std::unique_ptr<Expression> Parser::parseLogical() {
     auto expr = parseComparison();
     
     while (match(TokenType::AND) || match(TokenType::OR)) {
-        std::string op = previous().lexeme;
+        std::string op(previous().lexeme);
         auto right = parseComparison();
         expr = std::make_unique<LogicalExpression>(std::move(expr), op, std::move(right));
     }
@@ -126,7 +142,7 @@ std::unique_ptr<Expression> Parser::parseComparison() {
            match(TokenType::LESS_EQUAL) || match(TokenType::GREATER_EQUAL) ||
            match(TokenType::EQUAL_EQUAL) || match(TokenType::NOT_EQUAL)) {
         
-        std::string op = previous().lexeme;
+        std::string op(previous().lexeme);
         auto right = parseTerm();
         expr = std::make_unique<ComparisonExpression>(std::move(expr), op, std::move(right));
     }
@@ -138,7 +154,7 @@ std::unique_ptr<Expression> Parser::parseTerm() {
     auto expr = parseFactor();
     
     while (match(TokenType::PLUS) || match(TokenType::MINUS)) {
-        std::string op = previous().lexeme;
+        std::string op(previous().lexeme);
         auto right = parseFactor();
         expr = std::make_unique<BinaryOperation>(std::move(expr), op, std::move(right));
     }
@@ -150,7 +166,7 @@ std::unique_ptr<Expression> Parser::parseFactor() {
     auto expr = parseUnary();
     
     while (match(TokenType::MULTIPLY) || match(TokenType::DIVIDE) || match(TokenType::MODULO)) {
-        std::string op = previous().lexeme;
+        std::string op(previous().lexeme);
         auto right = parseUnary();
         expr = std::make_unique<BinaryOperation>(std::move(expr), op, std::move(right));
     }
@@ -161,21 +177,28 @@ std::unique_ptr<Expression> Parser::parseFactor() {
 std::unique_ptr<Expression> Parser::parseUnary() {
     // Unary NOT operator
     if (match(TokenType::NOT)) {
-        std::string op = previous().lexeme;
+        std::string op(previous().lexeme);
         auto operand = parseUnary();
         return std::make_unique<UnaryExpression>(op, std::move(operand));
     }
     
     // Integer literal
     if (match(TokenType::INTEGER)) {
-        int value = std::stoi(previous().lexeme);
+        const Token& literal = previous();
+        Value value = 0;
+        const char* end = literal.lexeme.data() + literal.lexeme.size();
+        if (std::from_chars(literal.lexeme.data(), end, value).ec != std::errc()) {
+            std::ostringstream oss;
+            oss << "Integer literal out of range at line " << literal.line << ", column " << literal.column;
+            throw ParserError(oss.str(), literal.line, literal.column);
+        }
         return std::make_unique<IntegerLiteral>(value);
     }
     
     // Variable
     if (match(TokenType::IDENTIFIER)) {
-        Token varToken = previous();
-        return std::make_unique<Variable>(varToken.lexeme, varToken.line, varToken.column);
+        const Token& varToken = previous();
+        return std::make_unique<Variable>(std::string(varToken.lexeme), varToken.line, varToken.column);
     }
     
     // Parenthesized expression
@@ -227,7 +250,7 @@ std::unique_ptr<Statement> Parser::parseIfStatement() {
 std::unique_ptr<Statement> Parser::parseForStatement() {
     // for variable = start to end { body }
     Token varToken = expect(TokenType::IDENTIFIER, "Expected variable name after 'for'");
-    std::string variable = varToken.lexeme;
+    std::string variable(varToken.lexeme);
     
     expect(TokenType::ASSIGN, "Expected '=' after for variable");
     
@@ -2,7 +2,7 @@
 #define PARSER_H
 
 #include "AST.h"
-#include "../lexer/Token.h"
+#include "../lexer/Lexer.h"
 #include <vector>
 #include <string>
 #include <stdexcept>
@@ -17,26 +17,32 @@ public:
         : std::runtime_error(message), line(ln), column(col) {}
 };
 
-// Recursive descent parser
+// Recursive descent parser. It normally pulls tokens from a Lexer as it
+// goes, one token of lookahead, so the whole token list never exists; a
+// token vector (from Lexer::getAllTokens, for callers that also display the
+// tokens) works too. Either way the Lexer must stay alive while parsing.
 class Parser {
 public:
-    explicit Parser(const std::vector<Token>& tokens);
+    explicit Parser(Lexer& lexer);
+    explicit Parser(std::vector<Token> tokens);
     
     // Parse the entire program
     std::vector<std::unique_ptr<Statement>> parse();
     
 private:
-    std::vector<Token> tokens;
-    size_t current;
+    Lexer* lexer = nullptr;        // Streaming source, or
+    std::vector<Token> tokens;     // pre-lexed tokens with the cursor in current
+    size_t current = 0;
+    Token last;                    // Last consumed token when streaming
     
     // Helper methods
-    Token peek() const;
-    Token previous() const;
-    Token advance();
+    const Token& peek() const;
+    const Token& previous() const;
+    const Token& advance();
     bool isAtEnd() const;
     bool check(TokenType type) const;
     bool match(TokenType type);
-    Token expect(TokenType type, const std::string& message);
+    const Token& expect(TokenType type, const std::string& message);
     void error(const std::string& message);
     
     // Parsing methods (in order of precedence, lowest to highest)
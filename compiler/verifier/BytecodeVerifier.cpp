@@ -0,0 +1,263 @@
+#include "BytecodeVerifier.h"
+#include <sstream>
+#include <algorithm>
+
+BytecodeVerifier::BytecodeVerifier(BytecodeProgram& program)
+    : program(program) {}
+
+void BytecodeVerifier::addError(const std::string& message, int instr) {
+    std::ostringstream oss;
+    oss << message << " at instruction " << instr;
+    errors.emplace_back(oss.str(), instr);
+}
+
+void BytecodeVerifier::addWarning(const std::string& message, int instr) {
+    std::ostringstream oss;
+    oss << message << " at instruction " << instr;
+    warnings.emplace_back(oss.str(), instr);
+}
+
+// ===== Opcode Classification =====
+
+static bool isBranch(OpCode opcode) {
+    return opcode == OpCode::JUMP_IF_FALSE || opcode == OpCode::JUMP_IF_TRUE ||
+           isCompareBranchOpcode(opcode) || isForLoopOpcode(opcode);
+}
+
+static bool endsBlock(OpCode opcode) {
+    return opcode == OpCode::JUMP || opcode == OpCode::HALT || isBranch(opcode);
+}
+
+static bool testBit(const std::vector<std::uint64_t>& bits, int slot) {
+    return (bits[slot / 64] >> (slot % 64)) & 1;
+}
+
+static void setBit(std::vector<std::uint64_t>& bits, int slot) {
+    bits[slot / 64] |= std::uint64_t(1) << (slot % 64);
+}
+
+// ===== Main Verify Method =====
+
+void BytecodeVerifier::verify() {
+    errors.clear();
+    warnings.clear();
+    maxStackDepth = 0;
+    program.setVerifiedStackDepth(-1);
+    program.setVerifiedEntryDepths({});
+
+    int n = static_cast<int>(program.size());
+    if (n == 0) {
+        addError("Program is empty", 0);
+        return;
+    }
+
+    buildBlocks();
+    entryDepths.assign(n, -1);
+
+    // Entry state: empty stack, nothing assigned
+    size_t words = (program.getSlotCount() + 63) / 64;
+    states.assign(blockStart.size(), BlockState());
+    mismatchReported.assign(blockStart.size(), false);
+    states[0].reached = true;
+    states[0].assigned.assign(words, 0);
+
+    // Propagate to a fixpoint (assigned sets only shrink, so this terminates)
+    std::vector<int> worklist{0};
+    while (!worklist.empty()) {
+        int block = worklist.back();
+        worklist.pop_back();
+        walkBlock(block, false, &worklist);
+    }
+
+    // Report findings once, from the final entry states
+    for (size_t block = 0; block < blockStart.size(); ++block) {
+        if (states[block].reached) {
+            walkBlock(static_cast<int>(block), true, nullptr);
+        }
+    }
+
+    if (isFastPathSafe()) {
+        program.setVerifiedStackDepth(maxStackDepth);
+        program.setVerifiedEntryDepths(std::move(entryDepths));
+    }
+}
+
+void BytecodeVerifier::buildBlocks() {
+    const auto& code = program.getInstructions();
+    int n = static_cast<int>(code.size());
+
+    // Leaders: entry, every in-range jump target, and whatever follows a jump/HALT
+    std::vector<bool> leader(n, false);
+    leader[0] = true;
+    for (int i = 0; i < n; ++i) {
+        OpCode op = code[i].opcode;
+        if ((op == OpCode::JUMP || isBranch(op)) && code[i].operand >= 0 && code[i].operand < n) {
+            leader[code[i].operand] = true;
+        }
+        if (endsBlock(op) && i + 1 < n) {
+            leader[i + 1] = true;
+        }
+    }
+
+    blockStart.clear();
+    blockOf.assign(n, 0);
+    for (int i = 0; i < n; ++i) {
+        if (leader[i]) blockStart.push_back(i);
+        blockOf[i] = static_cast<int>(blockStart.size()) - 1;
+    }
+}
+
+void BytecodeVerifier::mergeInto(int targetInstr, int fromInstr, int depth,
+                                 const std::vector<std::uint64_t>& assigned,
+                                 std::vector<int>* worklist) {
+    if (!worklist) return;  // Reporting pass: states are final
+
+    int block = blockOf[targetInstr];
+    BlockState& state = states[block];
+
+    if (!state.reached) {
+        state.reached = true;
+        state.depth = depth;
+        state.assigned = assigned;
+        worklist->push_back(block);
+        return;
+    }
+
+    if (state.depth != depth) {
+        if (!mismatchReported[block]) {
+            std::ostringstream oss;
+            oss << "Stack depth mismatch at join (" << state.depth << " vs " << depth
+                << " from instruction " << fromInstr << ")";
+            addError(oss.str(), targetInstr);
+            mismatchReported[block] = true;
+        }
+        return;
+    }
+
+    // Keep only slots assigned on every incoming path
+    bool changed = false;
+    for (size_t w = 0; w < state.assigned.size(); ++w) {
+        std::uint64_t merged = state.assigned[w] & assigned[w];
+        if (merged != state.assigned[w]) {
+            state.assigned[w] = merged;
+            changed = true;
+        }
+    }
+    if (changed) {
+        worklist->push_back(block);
+    }
+}
+
+void BytecodeVerifier::walkBlock(int block, bool report, std::vector<int>* worklist) {
+    const auto& code = program.getInstructions();
+    int n = static_cast<int>(code.size());
+    int slotCount = program.getSlotCount();
+
+    int depth = states[block].depth;
+    std::vector<std::uint64_t> assigned = states[block].assigned;
+
+    int i = blockStart[block];
+    int end = (block + 1 < static_cast<int>(blockStart.size())) ? blockStart[block + 1] : n;
+
+    for (; i < end; ++i) {
+        const Instruction& instr = code[i];
+        OpCode op = instr.opcode;
+
+        if (static_cast<int>(op) > static_cast<int>(OpCode::HALT)) {
+            if (report) addError("Unknown opcode", i);
+            return;
+        }
+
+        // Slot operands must name a slot in the program's table
+        bool slotInOperand = isVariableOpcode(op) || op == OpCode::STORE_LOAD_SLOT;
+        bool slotInAux = isFusedSlotOpcode(op);
+        if ((slotInOperand && (instr.operand < 0 || instr.operand >= slotCount)) ||
+            (slotInAux && instr.aux >= slotCount)) {
+            if (report) addError("Variable slot out of range", i);
+            return;
+        }
+
+        // Pool entries must exist; fused divisors must be safe for idiv
+        if (op == OpCode::LOAD_CONST_WIDE &&
+            (instr.operand < 0 || static_cast<size_t>(instr.operand) >= program.getConstants().size())) {
+            if (report) addError("Constant index out of range", i);
+            return;
+        }
+        if ((op == OpCode::SLOT_DIV_CONST || op == OpCode::SLOT_MOD_CONST) &&
+            (instr.operand == 0 || instr.operand == -1)) {
+            if (report) addError("Constant divisor must not be 0 or -1", i);
+            return;
+        }
+
+        if (report) {
+            entryDepths[i] = depth;
+        }
+
+        int pops = stackPops(op);
+        if (depth < pops) {
+            if (report) addError("Stack underflow", i);
+            return;
+        }
+
+        // Loads must be preceded by a store on every path
+        auto checkLoad = [&](int slot) {
+            if (report && !testBit(assigned, slot)) {
+                addWarning("Variable '" + program.getSlotName(slot) +
+                           "' may be loaded before it is stored", i);
+            }
+        };
+        switch (op) {
+            case OpCode::LOAD_VAR:
+            case OpCode::LOAD_SLOT:
+                checkLoad(instr.operand);
+                break;
+            case OpCode::STORE_VAR:
+            case OpCode::STORE_SLOT:
+                setBit(assigned, instr.operand);
+                break;
+            case OpCode::STORE_LOAD_SLOT:
+                setBit(assigned, instr.aux);
+                checkLoad(instr.operand);
+                break;
+            case OpCode::INC_SLOT:
+            case OpCode::SLOT_ADD_CONST:
+            case OpCode::SLOT_SUB_CONST:
+            case OpCode::SLOT_MUL_CONST:
+            case OpCode::SLOT_DIV_CONST:
+            case OpCode::SLOT_MOD_CONST:
+            case OpCode::FOR_PREP:
+            case OpCode::FOR_LOOP:
+                checkLoad(instr.aux);
+                break;
+            default:
+                break;
+        }
+
+        depth = depth - pops + stackPushes(op);
+        if (report) {
+            maxStackDepth = std::max(maxStackDepth, depth);
+        }
+
+        // Control flow
+        if (op == OpCode::HALT) {
+            return;
+        }
+        if (op == OpCode::JUMP || isBranch(op)) {
+            if (instr.operand < 0 || instr.operand >= n) {
+                if (report) addError("Jump target out of range", i);
+                return;
+            }
+            mergeInto(instr.operand, i, depth, assigned, worklist);
+            if (op == OpCode::JUMP) {
+                return;
+            }
+        }
+    }
+
+    // Fall through into the next block
+    if (i >= n) {
+        if (report) addError("Control falls off the end of the program", n - 1);
+        return;
+    }
+    mergeInto(i, i - 1, depth, assigned, worklist);
+}
@@ -0,0 +1,76 @@
+#ifndef BYTECODE_VERIFIER_H
+#define BYTECODE_VERIFIER_H
+
+#include "../bytecode/BytecodeProgram.h"
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+// Custom exception for verifier findings (index of the offending instruction)
+class VerifierError : public std::runtime_error {
+public:
+    int instruction;
+
+    VerifierError(const std::string& message, int instr)
+        : std::runtime_error(message), instruction(instr) {}
+};
+
+// Static bytecode verifier: abstract interpretation over the jump graph.
+//
+// Errors (program must not run):
+//   - jump targets and slot operands out of range, unknown opcodes
+//   - constant pool indices out of range, fused divisors of 0 or -1
+//   - stack underflow, or different stack depths meeting at a join point
+//   - control falling off the end of the program
+// Warnings (program runs, but only on the checked VM path):
+//   - a variable that may be loaded before it is stored on some path
+//
+// A program with neither is marked verified (see BytecodeProgram::getVerifiedStackDepth)
+// and the VM runs it on an unchecked fast path with an exactly-sized stack.
+class BytecodeVerifier {
+public:
+    explicit BytecodeVerifier(BytecodeProgram& program);
+
+    // Verify the program and mark it if it is safe for the unchecked path
+    void verify();
+
+    // Results
+    const std::vector<VerifierError>& getErrors() const { return errors; }
+    const std::vector<VerifierError>& getWarnings() const { return warnings; }
+    bool hasErrors() const { return !errors.empty(); }
+    bool isFastPathSafe() const { return errors.empty() && warnings.empty(); }
+    int getMaxStackDepth() const { return maxStackDepth; }
+
+private:
+    // Abstract state at the entry of a basic block
+    struct BlockState {
+        bool reached = false;
+        int depth = 0;                          // Operand stack depth
+        std::vector<std::uint64_t> assigned;    // Slots stored on every path (bitset)
+    };
+
+    BytecodeProgram& program;
+    std::vector<VerifierError> errors;
+    std::vector<VerifierError> warnings;
+    int maxStackDepth = 0;
+    std::vector<int> entryDepths;      // Instruction -> stack depth on entry (-1 if unreached)
+
+    std::vector<int> blockStart;       // First instruction of each block
+    std::vector<int> blockOf;          // Instruction -> block index
+    std::vector<BlockState> states;
+    std::vector<bool> mismatchReported;
+
+    void buildBlocks();
+
+    // Walk one block from its entry state; when report is set, record
+    // findings and stack depth, otherwise propagate state to successors
+    void walkBlock(int block, bool report, std::vector<int>* worklist);
+    void mergeInto(int targetInstr, int fromInstr, int depth,
+                   const std::vector<std::uint64_t>& assigned, std::vector<int>* worklist);
+
+    void addError(const std::string& message, int instr);
+    void addWarning(const std::string& message, int instr);
+};
+
+#endif
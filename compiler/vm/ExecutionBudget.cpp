@@ -0,0 +1,73 @@
+#include "ExecutionBudget.h"
+#include <algorithm>
+
+const char* budgetKindToString(BudgetKind kind) {
+    switch (kind) {
+        case BudgetKind::Instructions: return "instructions";
+        case BudgetKind::OutputBytes:  return "output";
+        case BudgetKind::WallTime:     return "time";
+        default:                       return "none";
+    }
+}
+
+void BudgetMonitor::beginRun(std::int64_t instructions) {
+    if (budget.maxWallTime.count() > 0) {
+        // A run that starts with the time already used up fails at its first check
+        runStart = std::chrono::steady_clock::now();
+        deadline = runStart + (budget.maxWallTime - spent);
+        running = true;
+    }
+    schedule(instructions);
+}
+
+void BudgetMonitor::endRun() {
+    spent = timeSpent();
+    running = false;
+}
+
+std::chrono::nanoseconds BudgetMonitor::timeSpent() const {
+    if (!running) return spent;
+    return spent + std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - runStart);
+}
+
+BudgetKind BudgetMonitor::check(std::int64_t instructions, const OutputSink& sink) {
+    if (budget.maxInstructions > 0 && instructions >= budget.maxInstructions) {
+        return BudgetKind::Instructions;
+    }
+    if (budget.maxOutputBytes > 0 && sink.getByteCount() - outputStart > budget.maxOutputBytes) {
+        return BudgetKind::OutputBytes;
+    }
+    if (budget.maxWallTime.count() > 0 && std::chrono::steady_clock::now() >= deadline) {
+        return BudgetKind::WallTime;
+    }
+    schedule(instructions);
+    return BudgetKind::None;
+}
+
+void BudgetMonitor::schedule(std::int64_t instructions) {
+    // Fuel alone needs no check before it is used up; output and time are sampled
+    std::int64_t next = INT64_MAX;
+    if (budget.maxOutputBytes > 0 || budget.maxWallTime.count() > 0) {
+        next = instructions + CHECK_INTERVAL;
+    }
+    if (budget.maxInstructions > 0) {
+        next = std::min(next, budget.maxInstructions);
+    }
+    checkpoint = next;
+}
+
+void BudgetMonitor::fail(BudgetKind kind, std::int64_t instructions, int pc) const {
+    std::string message = "Budget exceeded: ";
+    switch (kind) {
+        case BudgetKind::Instructions:
+            message += "instruction limit of " + std::to_string(budget.maxInstructions) + " reached";
+            break;
+        case BudgetKind::OutputBytes:
+            message += "output limit of " + std::to_string(budget.maxOutputBytes) + " bytes reached";
+            break;
+        default:
+            message += "time limit of " + std::to_string(budget.maxWallTime.count()) + " ms reached";
+            break;
+    }
+    throw BudgetExceededError(message, kind, instructions, pc);
+}
@@ -0,0 +1,94 @@
+#ifndef EXECUTION_BUDGET_H
+#define EXECUTION_BUDGET_H
+
+#include "OutputSink.h"
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Resource limits for one VM run; zero means unlimited.
+//
+// Budgets are checked at backward jumps only, so straight-line code never
+// pays for them and a run overshoots by at most one loop iteration (fuel)
+// or one check interval (output bytes, wall time).
+struct ExecutionBudget {
+    std::int64_t maxInstructions = 0;          // Instruction fuel for the whole execute()
+    std::uint64_t maxOutputBytes = 0;          // Bytes PRINTed since execute()
+    std::chrono::milliseconds maxWallTime{0};  // Time spent running since execute(), across
+                                               // resume() calls and restored snapshots
+
+    bool isUnlimited() const {
+        return maxInstructions <= 0 && maxOutputBytes == 0 && maxWallTime.count() <= 0;
+    }
+};
+
+enum class BudgetKind {
+    None,
+    Instructions,
+    OutputBytes,
+    WallTime
+};
+
+const char* budgetKindToString(BudgetKind kind);
+
+// Thrown by VirtualMachine::execute()/resume() when a budget runs out.
+// Output printed so far has been flushed to the VM's sink.
+class BudgetExceededError : public std::runtime_error {
+public:
+    BudgetKind kind;
+    std::int64_t instructionsExecuted;
+    int pc;                                    // Backward jump where the budget was checked
+
+    BudgetExceededError(const std::string& message, BudgetKind k, std::int64_t executed, int atPc)
+        : std::runtime_error(message), kind(k), instructionsExecuted(executed), pc(atPc) {}
+};
+
+// Tracks one program run against an ExecutionBudget. The interpreter loops
+// compare their instruction count with nextCheckpoint() at backward jumps and
+// call check() only when it has been reached.
+class BudgetMonitor {
+public:
+    static constexpr std::int64_t CHECK_INTERVAL = 4096;   // Output/time sampling period
+
+    void setBudget(const ExecutionBudget& newBudget) { budget = newBudget; }
+    const ExecutionBudget& getBudget() const { return budget; }
+
+    // At execute(): output is measured from the sink's current byte count and
+    // time from zero (less what a restored run had already written and run)
+    void beginExecute(const OutputSink& sink, std::uint64_t alreadyWritten = 0,
+                      std::chrono::nanoseconds alreadyRan = std::chrono::nanoseconds(0)) {
+        outputStart = sink.getByteCount() - alreadyWritten;
+        spent = alreadyRan;
+    }
+
+    // At every execute()/resume(): start the clock on the wall time left,
+    // schedule the first check
+    void beginRun(std::int64_t instructions);
+
+    // When a run returns or throws: add its time to the time spent
+    void endRun();
+
+    // Time spent running since execute() (only measured under a wall-time budget)
+    std::chrono::nanoseconds timeSpent() const;
+
+    std::int64_t nextCheckpoint() const { return checkpoint; }
+
+    // Which budget has run out; None schedules the next checkpoint
+    BudgetKind check(std::int64_t instructions, const OutputSink& sink);
+
+    [[noreturn]] void fail(BudgetKind kind, std::int64_t instructions, int pc) const;
+
+private:
+    ExecutionBudget budget;
+    std::int64_t checkpoint = INT64_MAX;
+    std::uint64_t outputStart = 0;
+    std::chrono::nanoseconds spent{0};                 // By runs that have ended
+    std::chrono::steady_clock::time_point runStart;
+    std::chrono::steady_clock::time_point deadline;
+    bool running = false;                              // Clock started and not yet stopped
+
+    void schedule(std::int64_t instructions);
+};
+
+#endif
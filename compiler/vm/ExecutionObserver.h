@@ -0,0 +1,201 @@
+#ifndef EXECUTION_OBSERVER_H
+#define EXECUTION_OBSERVER_H
+
+#include "../bytecode/Bytecode.h"
+#include "../bytecode/Value.h"
+#include "ExecutionProfile.h"
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+// Which observer the VM's interpreter loops are instantiated with.
+// Each mode is a separate compile-time specialization, so None carries
+// no per-instruction checks at all.
+enum class ObserverMode {
+    None,        // Plain execution
+    Trace,       // Record every instruction into the VM's TraceBuffer
+    Profile,     // Count and time every instruction into the VM's ExecutionProfile
+    TraceProfile, // Trace and Profile in one run (ticks include the cost of tracing)
+    Sample,      // Publish the running instruction for the VM's SamplingProfiler (statistical)
+    Breakpoint   // Pause before instructions marked with addBreakpoint()
+};
+
+// One executed instruction, captured before it runs
+struct TraceRecord {
+    std::uint64_t step;   // Position in execution order (0 = first instruction)
+    int pc;
+    Instruction instr;
+    int stackDepth;       // Values on the stack before the instruction
+    Value top[2];         // top[0] = top of stack, top[1] = below it (valid up to stackDepth)
+};
+
+// Fixed-capacity ring buffer of trace records. Storage is allocated once;
+// when full, the oldest records are overwritten and counted as dropped.
+class TraceBuffer {
+public:
+    explicit TraceBuffer(size_t capacity = 1024) { setCapacity(capacity); }
+
+    // Reallocate (rounded up to a power of two) and clear
+    void setCapacity(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        records.assign(rounded, TraceRecord());
+        mask = rounded - 1;
+        clear();
+    }
+    size_t capacity() const { return records.size(); }
+
+    void clear() { head = 0; tail = 0; overwritten = 0; }
+
+    void push(const TraceRecord& record) {
+        records[head & mask] = record;
+        ++head;
+        if (head - tail > records.size()) {
+            ++tail;
+            ++overwritten;
+        }
+    }
+
+    size_t size() const { return static_cast<size_t>(head - tail); }
+    bool empty() const { return head == tail; }
+
+    // Records pushed since the last clear, and how many were overwritten unread
+    std::uint64_t pushed() const { return head; }
+    std::uint64_t dropped() const { return overwritten; }
+
+    // Move the retained records, oldest first, into out. Draining empties
+    // the buffer but keeps the pushed/dropped totals until clear()
+    void drain(std::vector<TraceRecord>& out) {
+        out.reserve(out.size() + size());
+        for (; tail < head; ++tail) {
+            out.push_back(records[tail & mask]);
+        }
+    }
+
+private:
+    std::vector<TraceRecord> records;
+    std::uint64_t mask = 0;
+    std::uint64_t head = 0;   // Total records pushed
+    std::uint64_t tail = 0;   // Index of the oldest retained record
+    std::uint64_t overwritten = 0;
+};
+
+// ===== Observer Policies =====
+//
+// The interpreter loops call observer.before(...) ahead of every instruction
+// when Policy::enabled is true; returning false stops execution with the VM
+// paused at that instruction. Policies that define onBackEdge(header, pc) are
+// also called at every backward jump of the threaded loop; returning true
+// stops it before the loop header.
+
+struct NoObserver {
+    static constexpr bool enabled = false;
+    bool before(int, const Instruction&, const Value*, int) { return true; }
+};
+
+struct TraceObserver {
+    static constexpr bool enabled = true;
+    TraceBuffer& buffer;
+
+    bool before(int pc, const Instruction& instr, const Value* stackBase, int depth) {
+        TraceRecord record;
+        record.step = buffer.pushed();
+        record.pc = pc;
+        record.instr = instr;
+        record.stackDepth = depth;
+        record.top[0] = depth > 0 ? stackBase[depth - 1] : 0;
+        record.top[1] = depth > 1 ? stackBase[depth - 2] : 0;
+        buffer.push(record);
+        return true;
+    }
+};
+
+struct ProfileObserver {
+    static constexpr bool enabled = true;
+    ExecutionProfile& profile;
+    int lastPc = -1;              // Instruction whose time is still running
+    std::uint64_t lastTick = 0;
+
+    bool before(int pc, const Instruction&, const Value*, int) {
+        std::uint64_t now = ExecutionProfile::readTicks();
+        if (lastPc >= 0) profile.addTicks(lastPc, now - lastTick);
+        profile.count(pc);
+        lastPc = pc;
+        lastTick = now;
+        return true;
+    }
+
+    // Charge the last instruction (HALT or the one that threw)
+    void finish() {
+        if (lastPc >= 0) profile.addTicks(lastPc, ExecutionProfile::readTicks() - lastTick);
+        lastPc = -1;
+    }
+};
+
+// Trace and profile together, so a debugger view needs one run instead of two
+struct TraceProfileObserver {
+    static constexpr bool enabled = true;
+    TraceObserver trace;
+    ProfileObserver profile;
+
+    bool before(int pc, const Instruction& instr, const Value* stackBase, int depth) {
+        trace.before(pc, instr, stackBase, depth);
+        return profile.before(pc, instr, stackBase, depth);
+    }
+
+    void finish() { profile.finish(); }
+};
+
+struct SampleObserver {
+    static constexpr bool enabled = true;
+    std::atomic<const Instruction*>& current;   // Read by the profiling timer
+
+    bool before(int, const Instruction& instruction, const Value*, int) {
+        current.store(&instruction, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+struct BreakpointObserver {
+    static constexpr bool enabled = true;
+    const std::vector<unsigned char>& breakpoints;   // Indexed by pc
+    int resumePc;                                    // Breakpoint to step over once (-1 = none)
+
+    bool before(int pc, const Instruction&, const Value*, int) {
+        if (pc == resumePc) {
+            resumePc = -1;
+            return true;
+        }
+        return static_cast<size_t>(pc) >= breakpoints.size() || !breakpoints[pc];
+    }
+};
+
+// Loop counters for ExecutionEngine::Tiered: stops at the header of a loop
+// whose back edge has been taken `threshold` times, and on every later back
+// edge while its counter stays there (the VM parks loops it decided to keep
+// interpreting above the threshold)
+struct TierUpObserver {
+    static constexpr bool enabled = false;   // No per-instruction hook
+    std::uint32_t* backEdgeCounts;           // Indexed by loop header pc
+    std::uint32_t threshold;
+    int hotHeader = -1;                      // Loop the last run stopped at (-1 = none)
+    int hotBackEdge = -1;
+
+    bool onBackEdge(int header, int pc) {
+        std::uint32_t& counter = backEdgeCounts[header];
+        if (counter < threshold) ++counter;
+        if (counter != threshold) return false;
+        hotHeader = header;
+        hotBackEdge = pc;
+        return true;
+    }
+};
+
+template <class Policy, class = void>
+struct ObservesBackEdges : std::false_type {};
+template <class Policy>
+struct ObservesBackEdges<Policy, std::void_t<decltype(&Policy::onBackEdge)>> : std::true_type {};
+
+#endif
@@ -0,0 +1,130 @@
+#include "ExecutionProfile.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PROFILE_USE_TSC 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define PROFILE_USE_TSC 0
+#endif
+
+void ExecutionProfile::reset(size_t instructionCount) {
+    counts.assign(instructionCount, 0);
+    ticks.assign(instructionCount, 0);
+}
+
+void ExecutionProfile::release() {
+    std::vector<std::uint64_t>().swap(counts);
+    std::vector<std::uint64_t>().swap(ticks);
+}
+
+std::uint64_t ExecutionProfile::readTicks() {
+#if PROFILE_USE_TSC
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+const char* ExecutionProfile::getTickUnit() {
+    return PROFILE_USE_TSC ? "cycles" : "ns";
+}
+
+std::uint64_t ExecutionProfile::getTotalTicks() const {
+    std::uint64_t total = 0;
+    for (std::uint64_t t : ticks) total += t;
+    return total;
+}
+
+std::vector<ExecutionProfile::OpcodeStats> ExecutionProfile::byOpcode(const BytecodeProgram& program) const {
+    std::vector<OpcodeStats> stats;
+    for (int op = 0; op <= static_cast<int>(OpCode::HALT); ++op) {
+        stats.push_back({static_cast<OpCode>(op), 0, 0});
+    }
+    for (size_t pc = 0; pc < counts.size() && pc < program.size(); ++pc) {
+        OpcodeStats& entry = stats[static_cast<int>(program[pc].opcode)];
+        entry.count += counts[pc];
+        entry.ticks += ticks[pc];
+    }
+
+    stats.erase(std::remove_if(stats.begin(), stats.end(),
+                               [](const OpcodeStats& s) { return s.count == 0; }),
+                stats.end());
+    std::stable_sort(stats.begin(), stats.end(),
+                     [](const OpcodeStats& a, const OpcodeStats& b) { return a.ticks > b.ticks; });
+    return stats;
+}
+
+std::vector<ExecutionProfile::LineStats> ExecutionProfile::byLine(const BytecodeProgram& program) const {
+    std::map<int, LineStats> lines;
+    for (size_t pc = 0; pc < counts.size(); ++pc) {
+        if (counts[pc] == 0) continue;
+        int line = program.getLine(pc);
+        LineStats& entry = lines.emplace(line, LineStats{line, 0, 0}).first->second;
+        // A line's count is how often its first-executed instruction ran
+        entry.count = std::max(entry.count, counts[pc]);
+        entry.ticks += ticks[pc];
+    }
+
+    std::vector<LineStats> stats;
+    for (const auto& [line, entry] : lines) {
+        stats.push_back(entry);
+    }
+    std::stable_sort(stats.begin(), stats.end(),
+                     [](const LineStats& a, const LineStats& b) { return a.ticks > b.ticks; });
+    return stats;
+}
+
+void ExecutionProfile::printReport(std::ostream& out, const BytecodeProgram& program, size_t maxRows) const {
+    std::uint64_t total = getTotalTicks();
+    auto percent = [&](std::uint64_t t) { return total ? 100.0 * t / total : 0.0; };
+    const char* unit = getTickUnit();
+
+    out << std::fixed << std::setprecision(1);
+
+    out << "Hottest lines (" << total << " " << unit << " total):\n";
+    out << "  " << std::left << std::setw(8) << "line" << std::right << std::setw(12) << "executed"
+        << std::setw(16) << unit << std::setw(8) << "%" << "\n";
+    auto lines = byLine(program);
+    for (size_t i = 0; i < lines.size() && i < maxRows; ++i) {
+        std::string label = lines[i].line > 0 ? std::to_string(lines[i].line) : "-";
+        out << "  " << std::left << std::setw(8) << label << std::right << std::setw(12) << lines[i].count
+            << std::setw(16) << lines[i].ticks << std::setw(7) << percent(lines[i].ticks) << "%\n";
+    }
+
+    out << "\nHottest opcodes:\n";
+    out << "  " << std::left << std::setw(18) << "opcode" << std::right << std::setw(12) << "executed"
+        << std::setw(16) << unit << std::setw(8) << "%" << "\n";
+    auto opcodes = byOpcode(program);
+    for (size_t i = 0; i < opcodes.size() && i < maxRows; ++i) {
+        out << "  " << std::left << std::setw(18) << opcodeToString(opcodes[i].opcode) << std::right
+            << std::setw(12) << opcodes[i].count << std::setw(16) << opcodes[i].ticks
+            << std::setw(7) << percent(opcodes[i].ticks) << "%\n";
+    }
+
+    out << "\nHottest instructions:\n";
+    std::vector<size_t> order;
+    for (size_t pc = 0; pc < counts.size(); ++pc) {
+        if (counts[pc] > 0) order.push_back(pc);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ticks[a] > ticks[b]; });
+    for (size_t i = 0; i < order.size() && i < maxRows; ++i) {
+        size_t pc = order[i];
+        std::ostringstream text;
+        text << program[pc];
+        out << "  [" << std::setw(3) << pc << "] " << std::left << std::setw(22) << text.str() << std::right
+            << " line " << std::setw(4) << program.getLine(pc) << std::setw(12) << counts[pc]
+            << std::setw(16) << ticks[pc] << std::setw(7) << percent(ticks[pc]) << "%\n";
+    }
+
+    out << std::defaultfloat;
+}
@@ -0,0 +1,57 @@
+#ifndef EXECUTION_PROFILE_H
+#define EXECUTION_PROFILE_H
+
+#include "../bytecode/BytecodeProgram.h"
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+// Execution counts and cumulative time per instruction index, filled in by
+// the VM in ObserverMode::Profile. Time is measured in ticks: TSC cycles on
+// x86-64, steady_clock nanoseconds elsewhere (see getTickUnit()). An
+// instruction's ticks run from its dispatch to the next dispatch, so they
+// include the profiler's own overhead spread evenly over instructions.
+class ExecutionProfile {
+public:
+    struct OpcodeStats {
+        OpCode opcode;
+        std::uint64_t count;
+        std::uint64_t ticks;
+    };
+
+    struct LineStats {
+        int line;               // 0 = code outside any statement (the final HALT)
+        std::uint64_t count;
+        std::uint64_t ticks;
+    };
+
+    // Size for a program and zero all counters (keeps capacity)
+    void reset(size_t instructionCount);
+    size_t capacity() const { return counts.capacity(); }
+    void release();
+
+    // Recording (called by the profiling observer)
+    void count(int pc) { ++counts[pc]; }
+    void addTicks(int pc, std::uint64_t elapsed) { ticks[pc] += elapsed; }
+    static std::uint64_t readTicks();
+    static const char* getTickUnit();
+
+    // Per-instruction results
+    size_t size() const { return counts.size(); }
+    std::uint64_t getCount(size_t pc) const { return counts[pc]; }
+    std::uint64_t getTicks(size_t pc) const { return ticks[pc]; }
+    std::uint64_t getTotalTicks() const;
+
+    // Aggregates, hottest (by ticks) first; opcodes that never ran are omitted
+    std::vector<OpcodeStats> byOpcode(const BytecodeProgram& program) const;
+    std::vector<LineStats> byLine(const BytecodeProgram& program) const;
+
+    // Flat text report: hottest lines, opcodes and instructions
+    void printReport(std::ostream& out, const BytecodeProgram& program, size_t maxRows = 10) const;
+
+private:
+    std::vector<std::uint64_t> counts;
+    std::vector<std::uint64_t> ticks;
+};
+
+#endif
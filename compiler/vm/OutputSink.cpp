@@ -0,0 +1,104 @@
+#include "OutputSink.h"
+#include <stdexcept>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// ===== BufferSink =====
+
+BufferSink::BufferSink(size_t initialCapacity)
+    : storage(initialCapacity < MAX_LINE ? MAX_LINE : initialCapacity) {
+    begin = cursor = storage.data();
+    end = begin + storage.size();
+}
+
+void BufferSink::makeRoom(size_t needed) {
+    size_t used = cursor - begin;
+    size_t capacity = storage.size();
+    while (capacity - used < needed) {
+        capacity *= 2;
+    }
+    storage.resize(capacity);
+    begin = storage.data();
+    cursor = begin + used;
+    end = begin + capacity;
+}
+
+// ===== FdSink =====
+
+FdSink::FdSink(int fd, size_t bufferSize)
+    : fd(fd), storage(bufferSize < MAX_LINE ? MAX_LINE : bufferSize) {
+    begin = cursor = storage.data();
+    end = begin + storage.size();
+}
+
+FdSink::~FdSink() {
+    try {
+        flush();
+    } catch (...) {
+        // Destructors must not throw; output is lost if the fd is gone
+    }
+}
+
+void FdSink::flush() {
+    const char* data = begin;
+    size_t remaining = cursor - begin;
+    while (remaining > 0) {
+#ifdef _WIN32
+        int n = _write(fd, data, static_cast<unsigned>(remaining));
+#else
+        ssize_t n = ::write(fd, data, remaining);
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            cursor = begin;
+            throw std::runtime_error("Output error: write failed");
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+        retired += static_cast<std::uint64_t>(n);
+    }
+    cursor = begin;
+}
+
+void FdSink::makeRoom(size_t) {
+    flush();
+}
+
+// ===== StreamSink =====
+
+StreamSink::StreamSink(std::ostream& out, size_t bufferSize)
+    : out(out), storage(bufferSize < MAX_LINE ? MAX_LINE : bufferSize) {
+    begin = cursor = storage.data();
+    end = begin + storage.size();
+}
+
+StreamSink::~StreamSink() {
+    flush();
+}
+
+void StreamSink::flush() {
+    out.write(begin, cursor - begin);
+    retired += cursor - begin;
+    cursor = begin;
+}
+
+void StreamSink::makeRoom(size_t) {
+    flush();
+}
+
+// ===== CountingSink =====
+
+CountingSink::CountingSink() {
+    begin = cursor = scratch;
+    end = scratch + sizeof(scratch);
+}
+
+void CountingSink::makeRoom(size_t) {
+    retired += cursor - begin;
+    cursor = begin;
+}
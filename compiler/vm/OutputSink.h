@@ -0,0 +1,120 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <charconv>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Destination for PRINT output. Values are formatted with std::to_chars
+// straight into the sink's buffer; subclasses decide what happens when the
+// buffer fills up (grow, write out, or just count and discard).
+class OutputSink {
+public:
+    OutputSink() = default;
+    virtual ~OutputSink() = default;
+
+    // Not copyable: begin/cursor/end point into the subclass's own storage,
+    // so a copy would keep writing into the original's buffer
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    // Write one value followed by a newline
+    void printInt(std::int64_t value) {
+        if (static_cast<size_t>(end - cursor) < MAX_LINE) {
+            makeRoom(MAX_LINE);
+        }
+        cursor = std::to_chars(cursor, end, value).ptr;
+        *cursor++ = '\n';
+        ++lines;
+    }
+
+    // Push buffered bytes to the destination (no-op for in-memory sinks)
+    virtual void flush() {}
+
+    // Lines and bytes written since construction or the last reset
+    std::uint64_t getLineCount() const { return lines; }
+    std::uint64_t getByteCount() const { return retired + (cursor - begin); }
+
+protected:
+    // Longest line printInt() can produce: "-9223372036854775808\n"
+    static constexpr size_t MAX_LINE = 24;
+
+    // Make at least `needed` bytes available at cursor
+    virtual void makeRoom(size_t needed) = 0;
+
+    char* begin = nullptr;    // Start of the current buffer
+    char* cursor = nullptr;   // Next byte to write
+    char* end = nullptr;      // One past the buffer
+    std::uint64_t lines = 0;
+    std::uint64_t retired = 0;   // Bytes already moved out of the buffer
+};
+
+// Collects output in memory; capacity is kept across clear() so a reused
+// sink stops allocating once it has seen its largest output
+class BufferSink : public OutputSink {
+public:
+    explicit BufferSink(size_t initialCapacity = 4096);
+
+    std::string_view view() const { return std::string_view(begin, cursor - begin); }
+    std::string str() const { return std::string(view()); }
+    size_t size() const { return static_cast<size_t>(cursor - begin); }
+    void clear() { cursor = begin; lines = 0; }
+
+protected:
+    void makeRoom(size_t needed) override;
+
+private:
+    std::vector<char> storage;
+};
+
+// Writes to a file descriptor in large batches (one write() per buffer)
+class FdSink : public OutputSink {
+public:
+    explicit FdSink(int fd, size_t bufferSize = 64 * 1024);
+    ~FdSink() override;
+
+    void flush() override;
+
+protected:
+    void makeRoom(size_t needed) override;
+
+private:
+    int fd;
+    std::vector<char> storage;
+};
+
+// Batches output for a std::ostream (the VM's default sink wraps std::cout)
+class StreamSink : public OutputSink {
+public:
+    explicit StreamSink(std::ostream& out, size_t bufferSize = 16 * 1024);
+    ~StreamSink() override;
+
+    void flush() override;
+
+protected:
+    void makeRoom(size_t needed) override;
+
+private:
+    std::ostream& out;
+    std::vector<char> storage;
+};
+
+// Formats into a small scratch buffer and discards it, keeping only totals
+// (for benchmarks that should not measure I/O)
+class CountingSink : public OutputSink {
+public:
+    CountingSink();
+
+    void reset() { retired = 0; cursor = begin; lines = 0; }
+
+protected:
+    void makeRoom(size_t needed) override;
+
+private:
+    char scratch[4096];
+};
+
+#endif
@@ -0,0 +1,259 @@
+#include "RegisterVM.h"
+#include <stdexcept>
+#include <algorithm>
+
+void RegisterVM::execute(const RegisterProgram& program) {
+    validate(program);
+
+    // Registers start at zero; variables are the low registers
+    registers.assign(std::max(program.getRegisterCount(), 1), Value(0));
+    slotCount = program.getSlotCount();
+    instructionCount = 0;
+    budget.beginExecute(getOutput());
+    budget.beginRun(instructionCount);
+
+    // Output reaches its destination even when the program fails part-way
+    OutputSink& sink = getOutput();
+    try {
+        run(program);
+    } catch (...) {
+        sink.flush();
+        throw;
+    }
+    sink.flush();
+}
+
+void RegisterVM::validate(const RegisterProgram& program) {
+    const auto& instructions = program.getInstructions();
+    int registerCount = program.getRegisterCount();
+
+    auto fail = [](size_t pc, const std::string& message) {
+        throw std::runtime_error("Invalid register program: " + message + " at instruction " +
+                                 std::to_string(pc));
+    };
+
+    if (instructions.empty() || instructions.back().opcode != RegOpCode::HALT) {
+        throw std::runtime_error("Invalid register program: missing trailing HALT");
+    }
+    if (program.getSlotCount() > registerCount) {
+        throw std::runtime_error("Invalid register program: fewer registers than variables");
+    }
+
+    for (size_t pc = 0; pc < instructions.size(); ++pc) {
+        const RegInstruction& instr = instructions[pc];
+        if (instr.opcode > RegOpCode::HALT) {
+            fail(pc, "unknown opcode");
+        }
+        unsigned used = regOperands(instr.opcode);
+        if (((used & REG_A) && instr.a >= registerCount) ||
+            ((used & REG_B) && instr.b >= registerCount) ||
+            ((used & REG_C) && instr.c >= registerCount)) {
+            fail(pc, "register out of range");
+        }
+        if (isRegJumpOpcode(instr.opcode) &&
+            (instr.imm < 0 || static_cast<size_t>(instr.imm) >= instructions.size())) {
+            fail(pc, "jump target " + std::to_string(instr.imm) + " out of range");
+        }
+        if ((instr.opcode == RegOpCode::DIVI || instr.opcode == RegOpCode::MODI) &&
+            (instr.imm == 0 || instr.imm == -1)) {
+            fail(pc, "constant divisor is 0 or -1");
+        }
+        if (instr.opcode == RegOpCode::LOADK &&
+            (instr.imm < 0 || static_cast<size_t>(instr.imm) >= program.getConstants().size())) {
+            fail(pc, "constant index out of range");
+        }
+    }
+}
+
+// Same structure as VirtualMachine::runThreaded: one function, locals kept in
+// machine registers, computed goto on GCC/Clang and a switch loop elsewhere.
+// validate() has already established every bound the loop relies on.
+#if defined(__GNUC__) || defined(__clang__)
+#define RVM_COMPUTED_GOTO 1
+#else
+#define RVM_COMPUTED_GOTO 0
+#endif
+
+void RegisterVM::run(const RegisterProgram& program) {
+    const RegInstruction* const code = program.getInstructions().data();
+    const RegInstruction* ip = code;
+    Value* const r = registers.data();
+    const Value* const constants = program.getConstants().data();
+    OutputSink* const out = &getOutput();
+
+    std::int64_t count = instructionCount;
+    std::int64_t checkpoint = budget.nextCheckpoint();
+
+#define RVM_FAIL(message) \
+    do { instructionCount = count; throw std::runtime_error(message); } while (0)
+// Budgets are checked on backward jumps once count reaches the checkpoint
+#define RVM_CHECK_BUDGET() \
+    do { \
+        BudgetKind exceeded = budget.check(count, *out); \
+        if (exceeded != BudgetKind::None) { \
+            instructionCount = count; \
+            budget.fail(exceeded, count, static_cast<int>(ip - code)); \
+        } \
+        checkpoint = budget.nextCheckpoint(); \
+    } while (0)
+#define RVM_JUMP() \
+    do { \
+        const RegInstruction* dest = code + ip->imm; \
+        if (dest <= ip && count >= checkpoint) RVM_CHECK_BUDGET(); \
+        ip = dest; \
+    } while (0)
+#define RVM_BINARY(expr) \
+    do { Value a = r[ip->b]; Value b = r[ip->c]; r[ip->a] = (expr); } while (0)
+#define RVM_IMMEDIATE(expr) \
+    do { Value a = r[ip->b]; Value b = ip->imm; r[ip->a] = (expr); } while (0)
+// Checked arithmetic (see Value.h); the destination keeps its value on overflow
+#define RVM_CHECKED(checkedOp, right) \
+    do { \
+        Value result; \
+        if (checkedOp(r[ip->b], (right), result)) RVM_FAIL(OVERFLOW_ERROR); \
+        r[ip->a] = result; \
+    } while (0)
+// Plain block (not do/while) so RVM_CONTINUE/RVM_NEXT still reach the switch loop
+#define RVM_COMPARE_BRANCH(cond) \
+    { \
+        Value a = r[ip->b]; \
+        Value b = r[ip->c]; \
+        if (!(cond)) { \
+            RVM_JUMP(); \
+            RVM_CONTINUE(); \
+        } \
+        RVM_NEXT(); \
+    }
+
+#if RVM_COMPUTED_GOTO
+    // Must list every opcode in RegOpCode declaration order
+    static const void* const dispatchTable[] = {
+        &&op_LOADI, &&op_LOADK, &&op_MOVE,
+        &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD,
+        &&op_ADDI, &&op_SUBI, &&op_MULI, &&op_DIVI, &&op_MODI,
+        &&op_LT, &&op_GT, &&op_LTE, &&op_GTE, &&op_EQ, &&op_NEQ,
+        &&op_AND, &&op_OR, &&op_NOT,
+        &&op_JUMP, &&op_JUMP_IF_FALSE, &&op_JUMP_IF_TRUE,
+        &&op_JUMP_IF_NOT_LT, &&op_JUMP_IF_NOT_GT, &&op_JUMP_IF_NOT_LTE,
+        &&op_JUMP_IF_NOT_GTE, &&op_JUMP_IF_NOT_EQ, &&op_JUMP_IF_NOT_NEQ,
+        &&op_PRINT, &&op_HALT
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) ==
+                  static_cast<size_t>(RegOpCode::HALT) + 1,
+                  "dispatchTable must cover every opcode");
+#define RVM_CASE(name) op_##name
+#define RVM_DISPATCH() goto *dispatchTable[static_cast<int>(ip->opcode)]
+#define RVM_NEXT() do { ++count; ++ip; RVM_DISPATCH(); } while (0)
+#define RVM_CONTINUE() do { ++count; RVM_DISPATCH(); } while (0)
+    RVM_DISPATCH();
+#else
+#define RVM_CASE(name) case RegOpCode::name
+#define RVM_NEXT() { ++count; ++ip; continue; }
+#define RVM_CONTINUE() { ++count; continue; }
+    for (;;) {
+    switch (ip->opcode) {
+#endif
+
+    RVM_CASE(LOADI):
+        r[ip->a] = ip->imm;
+        RVM_NEXT();
+
+    RVM_CASE(LOADK):
+        r[ip->a] = constants[ip->imm];
+        RVM_NEXT();
+
+    RVM_CASE(MOVE):
+        r[ip->a] = r[ip->b];
+        RVM_NEXT();
+
+    RVM_CASE(ADD): RVM_CHECKED(addOverflows, r[ip->c]); RVM_NEXT();
+    RVM_CASE(SUB): RVM_CHECKED(subOverflows, r[ip->c]); RVM_NEXT();
+    RVM_CASE(MUL): RVM_CHECKED(mulOverflows, r[ip->c]); RVM_NEXT();
+
+    RVM_CASE(DIV):
+        if (r[ip->c] == 0) RVM_FAIL("Runtime error: Division by zero");
+        RVM_CHECKED(divOverflows, r[ip->c]);
+        RVM_NEXT();
+
+    RVM_CASE(MOD):
+        if (r[ip->c] == 0) RVM_FAIL("Runtime error: Modulo by zero");
+        RVM_BINARY(checkedRemainder(a, b));
+        RVM_NEXT();
+
+    RVM_CASE(ADDI): RVM_CHECKED(addOverflows, ip->imm); RVM_NEXT();
+    RVM_CASE(SUBI): RVM_CHECKED(subOverflows, ip->imm); RVM_NEXT();
+    RVM_CASE(MULI): RVM_CHECKED(mulOverflows, ip->imm); RVM_NEXT();
+    RVM_CASE(DIVI): RVM_IMMEDIATE(a / b); RVM_NEXT();
+    RVM_CASE(MODI): RVM_IMMEDIATE(a % b); RVM_NEXT();
+
+    RVM_CASE(LT):  RVM_BINARY((a < b) ? 1 : 0);  RVM_NEXT();
+    RVM_CASE(GT):  RVM_BINARY((a > b) ? 1 : 0);  RVM_NEXT();
+    RVM_CASE(LTE): RVM_BINARY((a <= b) ? 1 : 0); RVM_NEXT();
+    RVM_CASE(GTE): RVM_BINARY((a >= b) ? 1 : 0); RVM_NEXT();
+    RVM_CASE(EQ):  RVM_BINARY((a == b) ? 1 : 0); RVM_NEXT();
+    RVM_CASE(NEQ): RVM_BINARY((a != b) ? 1 : 0); RVM_NEXT();
+
+    RVM_CASE(AND): RVM_BINARY((a && b) ? 1 : 0); RVM_NEXT();
+    RVM_CASE(OR):  RVM_BINARY((a || b) ? 1 : 0); RVM_NEXT();
+
+    RVM_CASE(NOT):
+        r[ip->a] = (r[ip->b] == 0) ? 1 : 0;
+        RVM_NEXT();
+
+    RVM_CASE(JUMP):
+        RVM_JUMP();
+        RVM_CONTINUE();
+
+    RVM_CASE(JUMP_IF_FALSE):
+        if (r[ip->a] == 0) {
+            RVM_JUMP();
+            RVM_CONTINUE();
+        }
+        RVM_NEXT();
+
+    RVM_CASE(JUMP_IF_TRUE):
+        if (r[ip->a] != 0) {
+            RVM_JUMP();
+            RVM_CONTINUE();
+        }
+        RVM_NEXT();
+
+    RVM_CASE(JUMP_IF_NOT_LT):  RVM_COMPARE_BRANCH(a < b);
+    RVM_CASE(JUMP_IF_NOT_GT):  RVM_COMPARE_BRANCH(a > b);
+    RVM_CASE(JUMP_IF_NOT_LTE): RVM_COMPARE_BRANCH(a <= b);
+    RVM_CASE(JUMP_IF_NOT_GTE): RVM_COMPARE_BRANCH(a >= b);
+    RVM_CASE(JUMP_IF_NOT_EQ):  RVM_COMPARE_BRANCH(a == b);
+    RVM_CASE(JUMP_IF_NOT_NEQ): RVM_COMPARE_BRANCH(a != b);
+
+    RVM_CASE(PRINT):
+        instructionCount = count;   // Stays accurate if the sink throws
+        out->printInt(r[ip->a]);
+        RVM_NEXT();
+
+    RVM_CASE(HALT):
+        goto rvm_done;
+
+#if !RVM_COMPUTED_GOTO
+    default:
+        RVM_FAIL("Unknown opcode");
+    }
+    }
+#endif
+
+rvm_done:
+    instructionCount = count;
+
+#undef RVM_FAIL
+#undef RVM_CHECK_BUDGET
+#undef RVM_JUMP
+#undef RVM_BINARY
+#undef RVM_IMMEDIATE
+#undef RVM_CHECKED
+#undef RVM_COMPARE_BRANCH
+#undef RVM_CASE
+#undef RVM_NEXT
+#undef RVM_CONTINUE
+#if RVM_COMPUTED_GOTO
+#undef RVM_DISPATCH
+#endif
+}
@@ -0,0 +1,64 @@
+#ifndef REGISTER_VM_H
+#define REGISTER_VM_H
+
+#include "../bytecode/RegisterProgram.h"
+#include "ExecutionBudget.h"
+#include "OutputSink.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iostream>
+
+// Interpreter for register bytecode (RegisterProgram, see RegisterCodeGenerator).
+//
+// Each instruction names its operand registers, so a source-level operation
+// like "let x = x + 1" is one dispatch instead of the stack VM's
+// load/load/op/store. The program is validated once before it runs (register
+// indices, jump targets, trailing HALT), after which the loop does no bounds
+// checks. Reads of variables that were never assigned are not detected here;
+// the semantic analyzer rejects them before code generation. Arithmetic is
+// checked for overflow as in VirtualMachine (see Value.h).
+class RegisterVM {
+public:
+    RegisterVM() = default;
+    RegisterVM(const RegisterVM&) = delete;   // Owns an OutputSink
+    RegisterVM& operator=(const RegisterVM&) = delete;
+
+    // Execute a register program; throws std::runtime_error on invalid programs
+    // and runtime errors, BudgetExceededError when a budget runs out
+    void execute(const RegisterProgram& program);
+
+    // Get execution statistics
+    std::int64_t getInstructionCount() const { return instructionCount; }
+
+    // Limits for later runs (unlimited by default), as on VirtualMachine
+    void setBudget(const ExecutionBudget& newBudget) { budget.setBudget(newBudget); }
+    const ExecutionBudget& getBudget() const { return budget.getBudget(); }
+
+    // Where PRINT writes (not owned; nullptr = the VM's own buffered std::cout sink).
+    // Output is flushed when execute() returns or throws.
+    void setOutput(OutputSink* sink) { output = sink; }
+    OutputSink& getOutput() { return output ? *output : defaultOutput; }
+
+    // Inspect registers after execution; variables are registers 0..getSlotCount()-1
+    int getSlotCount() const { return slotCount; }
+    Value getSlotValue(int slot) const { return registers[slot]; }
+    int getRegisterCount() const { return static_cast<int>(registers.size()); }
+    Value getRegisterValue(int reg) const { return registers[reg]; }
+
+private:
+    std::vector<Value> registers;
+    int slotCount = 0;
+    std::int64_t instructionCount = 0;
+    StreamSink defaultOutput{std::cout};
+    OutputSink* output = nullptr;
+
+    BudgetMonitor budget;
+
+    // Reject programs the unchecked loop cannot run safely
+    static void validate(const RegisterProgram& program);
+
+    void run(const RegisterProgram& program);
+};
+
+#endif
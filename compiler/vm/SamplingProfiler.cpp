@@ -0,0 +1,239 @@
+#include "SamplingProfiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SAMPLER_USE_SIGPROF 1
+#include <signal.h>
+#include <sys/time.h>
+#include <cerrno>
+#else
+#define SAMPLER_USE_SIGPROF 0
+#endif
+
+namespace {
+
+#if SAMPLER_USE_SIGPROF
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+              std::atomic<const Instruction*>::is_always_lock_free,
+              "The SIGPROF handler may only touch lock-free atomics");
+
+// Sampler running on this thread. ITIMER_PROF fires in the thread whose CPU
+// time expired it, so each sample lands in the VM that was running.
+thread_local SamplingProfiler* threadSampler = nullptr;
+
+std::mutex timerMutex;                 // Guards the fields below
+int armedSamplers = 0;
+struct sigaction previousAction;
+struct itimerval previousTimer;
+
+void onProfilingSignal(int) {
+    int savedErrno = errno;
+    if (SamplingProfiler* sampler = threadSampler) {
+        sampler->takeSample();
+    }
+    errno = savedErrno;
+}
+#endif
+
+bool isBranch(OpCode opcode) {
+    return opcode == OpCode::JUMP || opcode == OpCode::JUMP_IF_FALSE || opcode == OpCode::JUMP_IF_TRUE ||
+           isCompareBranchOpcode(opcode) || isForLoopOpcode(opcode);
+}
+
+std::string lineFrame(int line) {
+    return line > 0 ? "line " + std::to_string(line) : "(no line)";
+}
+
+} // namespace
+
+void SamplingProfiler::reset(size_t instructionCount) {
+    if (instructionCount > countCapacity) {
+        counts.reset(new std::atomic<std::uint64_t>[instructionCount]);
+        countCapacity = instructionCount;
+    }
+    for (size_t pc = 0; pc < instructionCount; ++pc) {
+        counts[pc].store(0, std::memory_order_relaxed);
+    }
+    countSize = instructionCount;
+    outside.store(0, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::release() {
+    counts.reset();
+    countSize = 0;
+    countCapacity = 0;
+}
+
+void SamplingProfiler::start(const Instruction* code) {
+    if (running) {
+        return;
+    }
+    codeBegin = code;
+    current.store(nullptr, std::memory_order_relaxed);
+
+#if SAMPLER_USE_SIGPROF
+    if (threadSampler) {
+        throw std::runtime_error("A sampling profiler is already running on this thread");
+    }
+    threadSampler = this;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    std::lock_guard<std::mutex> lock(timerMutex);
+    if (armedSamplers++ == 0) {
+        struct sigaction action {};
+        action.sa_handler = onProfilingSignal;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;   // Output writes are not cut short by a sample
+        sigaction(SIGPROF, &action, &previousAction);
+
+        long micros = std::max<long>(static_cast<long>(interval.count()), 1);
+        struct itimerval timer {};
+        timer.it_interval.tv_sec = micros / 1000000;
+        timer.it_interval.tv_usec = micros % 1000000;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_PROF, &timer, &previousTimer);
+    }
+#else
+    stopRequested.store(false);
+    samplerThread = std::thread([this] {
+        while (!stopRequested.load()) {
+            std::this_thread::sleep_for(interval);
+            takeSample();
+        }
+    });
+#endif
+    running = true;
+}
+
+void SamplingProfiler::stop() {
+    if (!running) {
+        return;
+    }
+    running = false;
+
+#if SAMPLER_USE_SIGPROF
+    {
+        std::lock_guard<std::mutex> lock(timerMutex);
+        if (--armedSamplers == 0) {
+            setitimer(ITIMER_PROF, &previousTimer, nullptr);
+            // A SIGPROF may still be pending: keep our handler (which ignores
+            // it) rather than restoring the default action, which terminates
+            if (previousAction.sa_handler != SIG_DFL) {
+                sigaction(SIGPROF, &previousAction, nullptr);
+            }
+        }
+    }
+    threadSampler = nullptr;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#else
+    stopRequested.store(true);
+    samplerThread.join();
+#endif
+    current.store(nullptr, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::takeSample() {
+    const Instruction* instruction = current.load(std::memory_order_relaxed);
+    if (instruction && instruction >= codeBegin && instruction < codeBegin + countSize) {
+        counts[instruction - codeBegin].fetch_add(1, std::memory_order_relaxed);
+    } else {
+        outside.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool SamplingProfiler::usesProfilingSignal() {
+    return SAMPLER_USE_SIGPROF;
+}
+
+std::uint64_t SamplingProfiler::getTotalSamples() const {
+    std::uint64_t total = getOutsideSamples();
+    for (size_t pc = 0; pc < countSize; ++pc) total += getSamples(pc);
+    return total;
+}
+
+std::vector<SamplingProfiler::LineSamples> SamplingProfiler::byLine(const BytecodeProgram& program) const {
+    std::map<int, std::uint64_t> lines;
+    for (size_t pc = 0; pc < countSize && pc < program.size(); ++pc) {
+        if (std::uint64_t samples = getSamples(pc)) {
+            lines[program.getLine(pc)] += samples;
+        }
+    }
+
+    std::vector<LineSamples> stats;
+    for (const auto& [line, samples] : lines) {
+        stats.push_back({line, samples});
+    }
+    std::stable_sort(stats.begin(), stats.end(),
+                     [](const LineSamples& a, const LineSamples& b) { return a.samples > b.samples; });
+    return stats;
+}
+
+void SamplingProfiler::printHistogram(std::ostream& out, const BytecodeProgram& program, size_t maxRows) const {
+    std::uint64_t total = getTotalSamples();
+    auto percent = [&](std::uint64_t s) { return total ? 100.0 * s / total : 0.0; };
+    const int barWidth = 40;
+
+    out << std::fixed << std::setprecision(1);
+    out << "Samples by line (" << total << " samples, one per " << interval.count() << " us of "
+        << (usesProfilingSignal() ? "CPU" : "wall") << " time):\n";
+    out << "  " << std::left << std::setw(8) << "line" << std::right << std::setw(10) << "samples"
+        << std::setw(8) << "%" << "\n";
+
+    auto row = [&](const std::string& label, std::uint64_t samples) {
+        int bar = total ? static_cast<int>(barWidth * samples / total) : 0;
+        out << "  " << std::left << std::setw(8) << label << std::right << std::setw(10) << samples
+            << std::setw(7) << percent(samples) << "%  " << std::string(bar, '#') << "\n";
+    };
+    auto lines = byLine(program);
+    for (size_t i = 0; i < lines.size() && i < maxRows; ++i) {
+        row(lines[i].line > 0 ? std::to_string(lines[i].line) : "-", lines[i].samples);
+    }
+    if (getOutsideSamples() > 0) {
+        row("(other)", getOutsideSamples());   // Setup and teardown around the dispatch loop
+    }
+    out << std::defaultfloat;
+}
+
+void SamplingProfiler::writeCollapsedStacks(std::ostream& out, const BytecodeProgram& program,
+                                            const std::string& root) const {
+    // Loops are the code ranges [target, branch] closed by backward branches,
+    // named after the loop statement's line (where its back edge lives)
+    struct Loop { size_t begin; size_t end; int line; };
+    std::vector<Loop> loops;
+    const auto& code = program.getInstructions();
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        if (isBranch(code[pc].opcode) && code[pc].operand >= 0 &&
+            static_cast<size_t>(code[pc].operand) <= pc) {
+            loops.push_back({static_cast<size_t>(code[pc].operand), pc, program.getLine(pc)});
+        }
+    }
+    // Outermost first
+    std::sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+        return a.begin != b.begin ? a.begin < b.begin : a.end > b.end;
+    });
+
+    std::map<std::string, std::uint64_t> stacks;
+    for (size_t pc = 0; pc < countSize && pc < code.size(); ++pc) {
+        std::uint64_t samples = getSamples(pc);
+        if (samples == 0) continue;
+        std::string stack = root;
+        for (const Loop& loop : loops) {
+            if (loop.begin <= pc && pc <= loop.end) {
+                stack += ";loop (" + lineFrame(loop.line) + ")";
+            }
+        }
+        stack += ";" + lineFrame(program.getLine(pc)) + ";" + opcodeToString(code[pc].opcode);
+        stacks[stack] += samples;
+    }
+    if (getOutsideSamples() > 0) {
+        stacks[root + ";(other)"] += getOutsideSamples();
+    }
+
+    for (const auto& [stack, samples] : stacks) {
+        out << stack << " " << samples << "\n";
+    }
+}
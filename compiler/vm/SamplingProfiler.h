@@ -0,0 +1,104 @@
+#ifndef SAMPLING_PROFILER_H
+#define SAMPLING_PROFILER_H
+
+#include "../bytecode/BytecodeProgram.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Statistical profiler for long runs, filled in by the VM in
+// ObserverMode::Sample. The interpreter only publishes the instruction it is
+// about to dispatch (one relaxed pointer store); a profiling timer reads it
+// every interval and counts a sample for that instruction. On POSIX the timer is
+// setitimer(ITIMER_PROF), so samples follow the CPU time of the thread
+// running the VM; elsewhere a sampler thread wakes up every interval.
+//
+// The SIGPROF timer is process-wide: the first running sampler arms it with
+// its interval and the last one to stop disarms it (restoring any previous
+// handler). Each thread runs at most one sampler at a time.
+class SamplingProfiler {
+public:
+    struct LineSamples {
+        int line;               // 0 = code outside any statement (the final HALT)
+        std::uint64_t samples;
+    };
+
+    SamplingProfiler() = default;
+    ~SamplingProfiler() { stop(); }
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    static constexpr std::chrono::microseconds defaultInterval{1000};
+
+    // Time between samples
+    void setInterval(std::chrono::microseconds newInterval) { interval = newInterval; }
+    std::chrono::microseconds getInterval() const { return interval; }
+
+    // Size for a program and zero all counts (keeps capacity)
+    void reset(size_t instructionCount);
+    size_t capacity() const { return countCapacity; }
+    void release();
+
+    // The instruction the interpreter is running (null = not inside the dispatch loop)
+    std::atomic<const Instruction*>& instructionCell() { return current; }
+
+    // Take samples of instructions in code[0, size()) on the calling thread until stop()
+    void start(const Instruction* code);
+    void stop();
+    bool isRunning() const { return running; }
+
+    // Keeps a sampler running for one scope
+    class Session {
+    public:
+        Session(SamplingProfiler& owner, const Instruction* code) : profiler(owner) { profiler.start(code); }
+        ~Session() { profiler.stop(); }
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+    private:
+        SamplingProfiler& profiler;
+    };
+
+    // Record one sample of the published instruction (called by the timer; async-signal-safe)
+    void takeSample();
+
+    // Results
+    size_t size() const { return countSize; }
+    std::uint64_t getSamples(size_t pc) const { return counts[pc].load(std::memory_order_relaxed); }
+    std::uint64_t getOutsideSamples() const { return outside.load(std::memory_order_relaxed); }
+    std::uint64_t getTotalSamples() const;
+
+    // Samples per source line, hottest first; lines without samples are omitted
+    std::vector<LineSamples> byLine(const BytecodeProgram& program) const;
+
+    // Per-line histogram as text
+    void printHistogram(std::ostream& out, const BytecodeProgram& program, size_t maxRows = 10) const;
+
+    // Folded stacks for flame graph tools ("root;loop (line 2);line 4;MUL 17"):
+    // enclosing loops (from backward branches), the sampled line and the opcode
+    void writeCollapsedStacks(std::ostream& out, const BytecodeProgram& program,
+                              const std::string& root = "program") const;
+
+    // Whether samples come from SIGPROF (false = sampler thread)
+    static bool usesProfilingSignal();
+
+private:
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+    size_t countSize = 0;
+    size_t countCapacity = 0;
+    const Instruction* codeBegin = nullptr;
+    std::atomic<const Instruction*> current{nullptr};
+    std::atomic<std::uint64_t> outside{0};   // Samples taken outside the dispatch loop
+    std::chrono::microseconds interval = defaultInterval;
+    bool running = false;
+
+    // Sampler thread (platforms without SIGPROF)
+    std::thread samplerThread;
+    std::atomic<bool> stopRequested{false};
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "TieredExecution.h"
+#include "../codegen/CodeGenerator.h"
+#include <map>
+
+static bool isBranch(OpCode opcode) {
+    return opcode == OpCode::JUMP || opcode == OpCode::JUMP_IF_FALSE || opcode == OpCode::JUMP_IF_TRUE ||
+           isCompareBranchOpcode(opcode) || isForLoopOpcode(opcode);
+}
+
+const char* loopTierName(LoopTier tier) {
+    switch (tier) {
+        case LoopTier::Interpreter: return "interpreter";
+        case LoopTier::Fused:       return "fused";
+        default:                    return "native";
+    }
+}
+
+CompiledLoop::CompiledLoop(const BytecodeProgram& program, int header, int backEdge, int entryDepth,
+                           LoopTier preferred, bool budgetChecks) {
+    const auto& instructions = program.getInstructions();
+    int length = backEdge - header + 1;
+
+    // One HALT stub per place the loop can leave to, after the loop body
+    std::map<int, int> stubFor;   // Resume pc -> stub index
+    auto stub = [&](int resumePc) {
+        auto found = stubFor.find(resumePc);
+        if (found != stubFor.end()) return found->second;
+        int index = length + static_cast<int>(stubFor.size());
+        stubFor.emplace(resumePc, index);
+        return index;
+    };
+    stub(backEdge + 1);   // Falling off the end
+
+    std::vector<Instruction> loop;
+    std::vector<int> pcs;         // Program pc of each loop instruction
+    for (int pc = header; pc <= backEdge; ++pc) {
+        Instruction instr = instructions[pc];
+        if (isBranch(instr.opcode)) {
+            int target = instr.operand;
+            instr.operand = target >= header && target <= backEdge ? target - header : stub(target);
+        } else if (instr.opcode == OpCode::HALT) {
+            instr.operand = pc;
+        }
+        loop.push_back(instr);
+        pcs.push_back(pc);
+    }
+    std::vector<int> resumePcs(stubFor.size());
+    for (const auto& [resumePc, index] : stubFor) {
+        resumePcs[index - length] = resumePc;
+    }
+    for (int resumePc : resumePcs) {
+        loop.emplace_back(OpCode::HALT, resumePc);
+        pcs.push_back(resumePc);
+    }
+
+    std::vector<int> lines;
+    lines.reserve(pcs.size());
+    for (int pc : pcs) {
+        lines.push_back(program.getLine(pc));
+    }
+    code.setInstructions(std::move(loop), std::move(lines));
+    code.setConstants(program.getConstants());
+
+    // The loop needs no more stack than the verified program it came from
+    // (fusion never deepens it)
+    if (preferred == LoopTier::Native) {
+        code.setVerifiedStackDepth(program.getVerifiedStackDepth());
+        JitCompiler compiler;
+        compiler.setBudgetChecks(budgetChecks);
+        native = compiler.compile(code, entryDepth);
+    }
+    if (native) {
+        programPcs = std::move(pcs);
+        return;
+    }
+
+    // A fused instruction reports the program pc of its first part
+    std::vector<int> newIndex = CodeGenerator::fuseSuperinstructions(code, FUSE_ALL);
+    code.setVerifiedStackDepth(program.getVerifiedStackDepth());
+    fused = code.size() < pcs.size();
+    programPcs.assign(code.size(), -1);
+    for (size_t loopPc = 0; loopPc < pcs.size(); ++loopPc) {
+        int& programPc = programPcs[newIndex[loopPc]];
+        if (programPc < 0) programPc = pcs[loopPc];
+    }
+}
+
+LoopTier CompiledLoop::getTier() const {
+    if (native) return LoopTier::Native;
+    return fused ? LoopTier::Fused : LoopTier::Interpreter;
+}
+
+int CompiledLoop::programPc(int loopPc) const {
+    return loopPc >= 0 && static_cast<size_t>(loopPc) < programPcs.size() ? programPcs[loopPc] : -1;
+}
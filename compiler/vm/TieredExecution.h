@@ -0,0 +1,62 @@
+#ifndef TIERED_EXECUTION_H
+#define TIERED_EXECUTION_H
+
+#include "../bytecode/BytecodeProgram.h"
+#include "../jit/JitCompiler.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Back edges a loop takes in the interpreter before ExecutionEngine::Tiered recompiles it
+const std::uint32_t DEFAULT_TIER_UP_THRESHOLD = 1000;
+
+// What a hot loop is recompiled into
+enum class LoopTier {
+    Interpreter,   // Nothing: fusion found nothing to improve, the loop stays interpreted
+    Fused,         // Superinstruction-fused bytecode on the unchecked threaded loop
+    Native         // x86-64 machine code from JitCompiler (where supported)
+};
+
+const char* loopTierName(LoopTier tier);
+
+// One tier-up decision of a tiered run
+struct TierUp {
+    int header;                  // Loop header (back-edge target), where execution switches over
+    int backEdge;                // Backward branch closing the loop
+    int line;                    // Source line of the back edge
+    LoopTier tier;
+    std::int64_t promotedAt;     // Instructions executed when the loop got hot
+    std::uint64_t entries;       // Times execution entered the compiled loop
+    size_t codeSize;             // Instructions (Fused) or bytes of executable memory (Native)
+};
+
+// A loop's bytecode range [header, backEdge] recompiled as a standalone
+// program, entered at its first instruction with the stack depth the verifier
+// proved at the header (on-stack replacement). Branches that leave the range,
+// and falling off its end, reach HALT stubs whose operand is the program pc
+// to resume the interpreter at; HALTs inside the range resume at themselves.
+class CompiledLoop {
+public:
+    // The program must be verified. Native falls back to Fused when the JIT
+    // is unavailable; budgetChecks is passed on to the JIT.
+    CompiledLoop(const BytecodeProgram& program, int header, int backEdge, int entryDepth,
+                 LoopTier preferred, bool budgetChecks);
+
+    // Interpreter when the fused form is no better than the original range
+    LoopTier getTier() const;
+    const BytecodeProgram& getCode() const { return code; }
+    const JitCode* getNative() const { return native.get(); }
+    size_t codeSize() const { return native ? native->size() : code.size(); }
+
+    // Program pc of an instruction of the compiled loop (for error reports)
+    int programPc(int loopPc) const;
+
+private:
+    BytecodeProgram code;
+    std::vector<int> programPcs;     // Loop pc -> program pc
+    std::unique_ptr<JitCode> native;
+    bool fused = false;              // Fusion shortened the loop
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "VMPool.h"
+#include <utility>
+
+VMPool::Lease::Lease(Lease&& other) noexcept
+    : pool(std::exchange(other.pool, nullptr)), vm(std::exchange(other.vm, nullptr)) {}
+
+VMPool::Lease& VMPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = std::exchange(other.pool, nullptr);
+        vm = std::exchange(other.vm, nullptr);
+    }
+    return *this;
+}
+
+void VMPool::Lease::release() {
+    if (pool && vm) {
+        pool->giveBack(vm);
+    }
+    pool = nullptr;
+    vm = nullptr;
+}
+
+VMPool::VMPool(size_t size, int slots, int stackDepth) {
+    machines.reserve(size);
+    freeList.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        machines.push_back(std::make_unique<VirtualMachine>());
+        machines.back()->reserve(slots, stackDepth);
+        freeList.push_back(machines.back().get());
+    }
+}
+
+VMPool::Lease VMPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    returned.wait(lock, [this] { return !freeList.empty(); });
+    VirtualMachine* vm = freeList.back();
+    freeList.pop_back();
+    ++checkouts;
+    return Lease(this, vm);
+}
+
+VMPool::Lease VMPool::tryAcquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeList.empty()) {
+        return Lease();
+    }
+    VirtualMachine* vm = freeList.back();
+    freeList.pop_back();
+    ++checkouts;
+    return Lease(this, vm);
+}
+
+size_t VMPool::available() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return freeList.size();
+}
+
+std::uint64_t VMPool::getCheckoutCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return checkouts;
+}
+
+void VMPool::giveBack(VirtualMachine* vm) {
+    // Reset outside the lock; the VM is not reachable by anyone else yet
+    vm->reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(vm);
+    }
+    returned.notify_one();
+}
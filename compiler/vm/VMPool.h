@@ -0,0 +1,65 @@
+#ifndef VM_POOL_H
+#define VM_POOL_H
+
+#include "VirtualMachine.h"
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// A fixed set of ready VirtualMachine instances for a long-lived server loop.
+// Each VM is reserved once at construction; a returned VM is reset() (clean
+// state, default configuration, memory bounded by its retained-memory limit)
+// before anyone else gets it, so steady-state checkouts do not allocate.
+// Thread-safe: workers may acquire and return VMs concurrently.
+class VMPool {
+public:
+    // Checked-out VM; goes back to the pool when the lease is destroyed or released
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        VirtualMachine& operator*() const { return *vm; }
+        VirtualMachine* operator->() const { return vm; }
+        explicit operator bool() const { return vm != nullptr; }
+
+        void release();
+
+    private:
+        friend class VMPool;
+        Lease(VMPool* owner, VirtualMachine* machine) : pool(owner), vm(machine) {}
+
+        VMPool* pool = nullptr;
+        VirtualMachine* vm = nullptr;
+    };
+
+    // size VMs, each reserved for programs up to slots variables and stackDepth values
+    explicit VMPool(size_t size, int slots = 64, int stackDepth = 64);
+
+    // Wait for a free VM
+    Lease acquire();
+
+    // A free VM, or an empty lease if all are checked out
+    Lease tryAcquire();
+
+    size_t size() const { return machines.size(); }
+    size_t available() const;
+    std::uint64_t getCheckoutCount() const;
+
+private:
+    std::vector<std::unique_ptr<VirtualMachine>> machines;
+    std::vector<VirtualMachine*> freeList;   // Capacity = size(), so returns never allocate
+    std::uint64_t checkouts = 0;
+    mutable std::mutex mutex;
+    std::condition_variable returned;
+
+    void giveBack(VirtualMachine* vm);
+};
+
+#endif
@@ -0,0 +1,130 @@
+#include "VMScheduler.h"
+#include <algorithm>
+
+VMScheduler::VMScheduler(unsigned threads, std::int64_t slice) : timeSlice(slice > 0 ? slice : DEFAULT_SCHEDULER_SLICE) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+VMScheduler::~VMScheduler() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+std::uint64_t VMScheduler::submit(BytecodeProgram program, Callback onDone, const ExecutionBudget& budget) {
+    auto task = std::make_unique<Task>();
+    task->program = std::move(program);
+    task->budget = budget;
+    task->onDone = std::move(onDone);
+    task->submitted = std::chrono::steady_clock::now();
+    std::uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = task->id = nextId++;
+        fresh.push_back(std::move(task));
+        ++pending;
+    }
+    workReady.notify_one();
+    return id;
+}
+
+void VMScheduler::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+}
+
+size_t VMScheduler::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending;
+}
+
+std::uint64_t VMScheduler::getSliceCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sliceCount;
+}
+
+// Caller holds the lock and has checked that a queue is non-empty
+std::unique_ptr<VMScheduler::Task> VMScheduler::take(std::int64_t& freshWork) {
+    bool takeFresh = !fresh.empty() && (parked.empty() || freshWork < timeSlice);
+    std::deque<std::unique_ptr<Task>>& queue = takeFresh ? fresh : parked;
+    if (!takeFresh) freshWork = 0;
+    std::unique_ptr<Task> task = std::move(queue.front());
+    queue.pop_front();
+    ++sliceCount;
+    return task;
+}
+
+void VMScheduler::work() {
+    VirtualMachine vm;
+    std::int64_t freshWork = 0;   // Instructions spent on new programs since the last parked one
+    for (;;) {
+        std::unique_ptr<Task> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this] { return stopping || !fresh.empty() || !parked.empty(); });
+            if (fresh.empty() && parked.empty()) {
+                return;   // Stopping
+            }
+            task = take(freshWork);
+        }
+
+        ScheduledResult result;
+        bool finished = runSlice(vm, *task, result);
+        if (task->slices == 1) freshWork += vm.getInstructionCount();
+        if (!finished) {
+            std::lock_guard<std::mutex> lock(mutex);
+            parked.push_back(std::move(task));
+            workReady.notify_one();
+            continue;
+        }
+
+        result.id = task->id;
+        result.slices = task->slices;
+        result.output = std::string(task->output.view());
+        result.latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - task->submitted).count();
+        if (task->onDone) task->onDone(result);
+        task.reset();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) allDone.notify_all();
+    }
+}
+
+// One slice of a task on this worker's VM; returns true when the program finished
+bool VMScheduler::runSlice(VirtualMachine& vm, Task& task, ScheduledResult& result) {
+    vm.setOutput(&task.output);
+    vm.setBudget(task.budget);
+    vm.setTimeSlice(timeSlice);
+    ++task.slices;
+    try {
+        if (task.slices == 1) {
+            vm.execute(task.program);
+        } else {
+            vm.restore(task.program, task.parked);
+            vm.resume();
+        }
+        if (vm.isPaused()) {
+            task.parked = vm.checkpoint();
+            return false;
+        }
+        result.success = true;
+    } catch (const BudgetExceededError& e) {
+        result.error = e.what();
+        result.budgetExceeded = true;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    result.instructions = vm.getInstructionCount();
+    task.parked = VMSnapshot();
+    return true;
+}
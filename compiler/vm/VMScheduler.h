@@ -0,0 +1,93 @@
+#ifndef VM_SCHEDULER_H
+#define VM_SCHEDULER_H
+
+#include "VirtualMachine.h"
+#include "VMSnapshot.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Instructions a scheduled program runs before it yields (about 0.1-0.5 ms)
+const std::int64_t DEFAULT_SCHEDULER_SLICE = 100000;
+
+// Outcome of one scheduled program
+struct ScheduledResult {
+    std::uint64_t id = 0;                    // As returned by submit()
+    bool success = false;
+    std::string error;                       // Runtime or budget error message
+    bool budgetExceeded = false;
+    std::string output;
+    std::int64_t instructions = 0;
+    int slices = 0;                          // Times it was given a thread
+    double latency = 0;                      // Seconds from submit() to completion
+};
+
+// Runs many programs concurrently on a fixed set of threads by time slicing:
+// each program runs for one slice (see VirtualMachine::setTimeSlice), is
+// parked as a VMSnapshot, and goes to the back of the run queue. Workers own
+// one VirtualMachine each, so a parked program costs only its snapshot and
+// output. Programs that have not had a slice yet go first, so short programs
+// finish in their first slice even while long ones are queued; once a worker
+// has spent a slice's worth of instructions on new programs it takes one
+// parked program, so long programs keep at least half of the time.
+class VMScheduler {
+public:
+    using Callback = std::function<void(const ScheduledResult&)>;
+
+    // 0 threads = one per hardware thread
+    explicit VMScheduler(unsigned threads = 0, std::int64_t timeSlice = DEFAULT_SCHEDULER_SLICE);
+
+    // Finishes everything submitted, then stops the threads
+    ~VMScheduler();
+
+    VMScheduler(const VMScheduler&) = delete;
+    VMScheduler& operator=(const VMScheduler&) = delete;
+
+    // Queue a program; onDone is called on a worker thread when it finishes
+    std::uint64_t submit(BytecodeProgram program, Callback onDone,
+                         const ExecutionBudget& budget = ExecutionBudget());
+
+    // Block until every program submitted so far has finished
+    void wait();
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+    size_t getPendingCount() const;
+    std::uint64_t getSliceCount() const;
+
+private:
+    struct Task {
+        std::uint64_t id;
+        BytecodeProgram program;
+        ExecutionBudget budget;
+        Callback onDone;
+        BufferSink output;
+        VMSnapshot parked;                   // State between slices
+        int slices = 0;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    std::int64_t timeSlice;
+    std::vector<std::thread> workers;
+    std::deque<std::unique_ptr<Task>> fresh;     // Not started yet
+    std::deque<std::unique_ptr<Task>> parked;    // Waiting for their next slice
+    size_t pending = 0;                          // Submitted and not finished
+    std::uint64_t nextId = 1;
+    std::uint64_t sliceCount = 0;
+    bool stopping = false;
+    mutable std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable allDone;
+
+    void work();
+    std::unique_ptr<Task> take(std::int64_t& freshWork);
+    bool runSlice(VirtualMachine& vm, Task& task, ScheduledResult& result);
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "VMSnapshot.h"
+#include <stdexcept>
+#include <string>
+
+static const std::uint8_t SNAPSHOT_MAGIC[4] = {'V', 'M', 'S', 'S'};
+static const std::uint8_t SNAPSHOT_VERSION = 3;   // 2: 64-bit values, 3: wall time
+
+// LEB128: 7 bits per byte, high bit set on all but the last
+static void writeUnsigned(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// Zigzag keeps small negative values short
+static void writeSigned(std::vector<std::uint8_t>& out, std::int64_t value) {
+    writeUnsigned(out, (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+}
+
+namespace {
+
+class SnapshotReader {
+public:
+    SnapshotReader(const std::uint8_t* data, size_t size) : cursor(data), end(data + size) {}
+
+    std::uint8_t readByte() {
+        if (cursor == end) fail("truncated");
+        return *cursor++;
+    }
+
+    std::uint64_t readUnsigned() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            std::uint8_t byte = readByte();
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                if (shift == 63 && byte > 1) fail("value out of range");
+                return value;
+            }
+        }
+        fail("integer too long");
+    }
+
+    std::int64_t readSigned() {
+        std::uint64_t value = readUnsigned();
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // An element count, bounded by the bits left so bad input cannot
+    // trigger a huge allocation
+    size_t readCount(size_t minBitsPerElement) {
+        std::uint64_t count = readUnsigned();
+        if (count > static_cast<std::uint64_t>(end - cursor) * 8 / minBitsPerElement) fail("bad length");
+        return static_cast<size_t>(count);
+    }
+
+    bool atEnd() const { return cursor == end; }
+
+    [[noreturn]] static void fail(const char* reason) {
+        throw std::runtime_error(std::string("Malformed VM snapshot: ") + reason);
+    }
+
+private:
+    const std::uint8_t* cursor;
+    const std::uint8_t* end;
+};
+
+}
+
+void VMSnapshot::encode(std::vector<std::uint8_t>& out) const {
+    out.assign(SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 4);
+    out.push_back(SNAPSHOT_VERSION);
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<std::uint8_t>(programFingerprint >> shift));
+    }
+    writeUnsigned(out, static_cast<std::uint64_t>(pc));
+    writeUnsigned(out, static_cast<std::uint64_t>(instructionCount));
+    writeUnsigned(out, outputBytes);
+    writeUnsigned(out, outputLines);
+    writeUnsigned(out, wallTimeNanos);
+
+    writeUnsigned(out, stack.size());
+    for (Value value : stack) writeSigned(out, value);
+
+    // Assigned flags as a bitset, then the values of assigned slots only
+    writeUnsigned(out, frame.size());
+    for (size_t slot = 0; slot < frame.size(); slot += 8) {
+        std::uint8_t bits = 0;
+        for (size_t bit = 0; bit < 8 && slot + bit < frame.size(); ++bit) {
+            if (assigned[slot + bit]) bits |= static_cast<std::uint8_t>(1u << bit);
+        }
+        out.push_back(bits);
+    }
+    for (size_t slot = 0; slot < frame.size(); ++slot) {
+        if (assigned[slot]) writeSigned(out, frame[slot]);
+    }
+}
+
+VMSnapshot VMSnapshot::decode(const std::uint8_t* data, size_t size) {
+    SnapshotReader reader(data, size);
+    for (std::uint8_t expected : SNAPSHOT_MAGIC) {
+        if (reader.readByte() != expected) SnapshotReader::fail("not a snapshot");
+    }
+    if (reader.readByte() != SNAPSHOT_VERSION) SnapshotReader::fail("unsupported version");
+
+    VMSnapshot snapshot;
+    for (int shift = 0; shift < 64; shift += 8) {
+        snapshot.programFingerprint |= static_cast<std::uint64_t>(reader.readByte()) << shift;
+    }
+    std::uint64_t pc = reader.readUnsigned();
+    std::uint64_t instructionCount = reader.readUnsigned();
+    if (pc > INT32_MAX || instructionCount > INT64_MAX) SnapshotReader::fail("value out of range");
+    snapshot.pc = static_cast<int>(pc);
+    snapshot.instructionCount = static_cast<std::int64_t>(instructionCount);
+    snapshot.outputBytes = reader.readUnsigned();
+    snapshot.outputLines = reader.readUnsigned();
+    snapshot.wallTimeNanos = reader.readUnsigned();
+    if (snapshot.wallTimeNanos > INT64_MAX) SnapshotReader::fail("value out of range");
+
+    snapshot.stack.resize(reader.readCount(8));
+    for (Value& value : snapshot.stack) value = reader.readSigned();
+
+    size_t slots = reader.readCount(1);
+    snapshot.frame.assign(slots, 0);
+    snapshot.assigned.assign(slots, 0);
+    for (size_t slot = 0; slot < slots; slot += 8) {
+        std::uint8_t bits = reader.readByte();
+        for (size_t bit = 0; bit < 8 && slot + bit < slots; ++bit) {
+            snapshot.assigned[slot + bit] = (bits >> bit) & 1;
+        }
+    }
+    for (size_t slot = 0; slot < slots; ++slot) {
+        if (snapshot.assigned[slot]) snapshot.frame[slot] = reader.readSigned();
+    }
+    if (!reader.atEnd()) SnapshotReader::fail("trailing bytes");
+    return snapshot;
+}
+
+std::uint64_t fingerprintProgram(const BytecodeProgram& program) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            hash ^= (value >> (8 * i)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+    };
+    mix(static_cast<std::uint64_t>(program.getSlotCount()), 4);
+    for (const Instruction& instr : program.getInstructions()) {
+        mix(static_cast<std::uint8_t>(instr.opcode), 1);
+        mix(instr.aux, 2);
+        mix(static_cast<std::uint32_t>(instr.operand), 4);
+    }
+    for (Value constant : program.getConstants()) {
+        mix(static_cast<std::uint64_t>(constant), 8);
+    }
+    return hash;
+}
@@ -0,0 +1,35 @@
+#ifndef VM_SNAPSHOT_H
+#define VM_SNAPSHOT_H
+
+#include "../bytecode/BytecodeProgram.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// The run state of a VirtualMachine between two instructions: enough to
+// resume the same program later, in the same VM or another one (see
+// VirtualMachine::restore)
+struct VMSnapshot {
+    std::uint64_t programFingerprint = 0;    // fingerprintProgram() of the program it came from
+    int pc = 0;                              // Next instruction to execute
+    std::int64_t instructionCount = 0;       // Instructions executed before pc
+    std::uint64_t outputBytes = 0;           // Output written since execute()
+    std::uint64_t outputLines = 0;
+    std::uint64_t wallTimeNanos = 0;         // Time spent running (under a wall-time budget)
+    std::vector<Value> stack;                // Bottom first
+    std::vector<Value> frame;                // Variable slots
+    std::vector<unsigned char> assigned;     // Whether each slot has been stored
+
+    // Compact binary form: a "VMSS" header and version byte, then
+    // variable-length integers; only assigned slots store a value.
+    // decode() throws std::runtime_error on truncated or malformed input.
+    void encode(std::vector<std::uint8_t>& out) const;
+    static VMSnapshot decode(const std::uint8_t* data, size_t size);
+    static VMSnapshot decode(const std::vector<std::uint8_t>& bytes) { return decode(bytes.data(), bytes.size()); }
+};
+
+// Hash of a program's instructions, constants and slot count (FNV-1a), so a
+// snapshot is never restored into a program it was not taken from
+std::uint64_t fingerprintProgram(const BytecodeProgram& program);
+
+#endif
@@ -1,26 +1,513 @@
 #include "VirtualMachine.h"
+#include "../jit/JitCompiler.h"
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
+
+// Condition tested by the fused JUMP_IF_NOT_* instructions
+static bool compareForBranch(OpCode opcode, Value a, Value b) {
+    switch (opcode) {
+        case OpCode::JUMP_IF_NOT_LT:  return a < b;
+        case OpCode::JUMP_IF_NOT_GT:  return a > b;
+        case OpCode::JUMP_IF_NOT_LTE: return a <= b;
+        case OpCode::JUMP_IF_NOT_GTE: return a >= b;
+        case OpCode::JUMP_IF_NOT_EQ:  return a == b;
+        case OpCode::JUMP_IF_NOT_NEQ: return a != b;
+        default:                      return false;
+    }
+}
+
+// Resize a run buffer, counting an allocation when it has to grow
+template <class T>
+static void assignCounted(std::vector<T>& buffer, size_t size, T value, std::uint64_t& allocations) {
+    if (size > buffer.capacity()) ++allocations;
+    buffer.assign(size, value);
+}
+
+template <class T>
+static void resizeCounted(std::vector<T>& buffer, size_t size, std::uint64_t& allocations) {
+    if (size > buffer.capacity()) ++allocations;
+    buffer.resize(size);
+}
 
 void VirtualMachine::execute(const BytecodeProgram& program) {
-    // Reset state
+    // Reset state (one preallocated slot per variable)
+    allocations = 0;
+    stack.clear();
+    assignCounted(frame, program.getSlotCount(), Value(0), allocations);
+    assignCounted(assigned, program.getSlotCount(), static_cast<unsigned char>(0), allocations);
+    instructionCount = 0;
+    paused = false;
+    pausedPc = -1;
+    budget.beginExecute(getOutput());
+    outputStartBytes = getOutput().getByteCount();
+    outputStartLines = getOutput().getLineCount();
+    beginProgram(program);
+    
+    run(0);
+}
+
+void VirtualMachine::beginProgram(const BytecodeProgram& program) {
+    slotNames = &program.getSlotNames();
+    this->program = &program;
+    pauseReason = PauseReason::None;
+    traceBuffer.clear();
+    bool profiling = observerMode == ObserverMode::Profile || observerMode == ObserverMode::TraceProfile;
+    size_t profileSize = profiling ? program.size() : 0;
+    if (profileSize > profile.capacity()) ++allocations;
+    profile.reset(profileSize);
+    size_t sampleSize = observerMode == ObserverMode::Sample ? program.size() : 0;
+    if (sampleSize > sampler.capacity()) ++allocations;
+    sampler.reset(sampleSize);
+    compiledLoops.clear();
+    tierUps.clear();
+    if (checkpointInterval > 0) {
+        programFingerprint = fingerprintProgram(program);
+        snapshotAt = instructionCount + checkpointInterval;
+    } else {
+        snapshotAt = INT64_MAX;
+    }
+}
+
+void VirtualMachine::setCheckpointInterval(std::int64_t instructions,
+                                           std::function<void(const VMSnapshot&)> callback) {
+    checkpointInterval = instructions > 0 ? instructions : 0;
+    onCheckpoint = std::move(callback);
+}
+
+VMSnapshot VirtualMachine::checkpoint() const {
+    if (!paused) {
+        throw std::runtime_error("VM is not paused");
+    }
+    VMSnapshot out;
+    fillSnapshot(out, pausedPc, instructionCount, stack.data(), static_cast<int>(stack.size()));
+    out.programFingerprint = fingerprintProgram(*program);
+    return out;
+}
+
+void VirtualMachine::restore(const BytecodeProgram& program, const VMSnapshot& snapshot) {
+    if (snapshot.programFingerprint != fingerprintProgram(program)) {
+        throw std::runtime_error("Snapshot was taken from a different program");
+    }
+    // Verified programs run unchecked, so the snapshot stack must be exactly
+    // as deep as the verifier proved it is on entry to the resume pc
+    size_t slots = program.getSlotCount();
+    bool fits = snapshot.pc >= 0 && static_cast<size_t>(snapshot.pc) < program.size() &&
+                snapshot.instructionCount >= 0 && snapshot.frame.size() == slots &&
+                snapshot.assigned.size() == slots &&
+                (!program.isVerified() ||
+                 static_cast<int>(snapshot.stack.size()) == program.getVerifiedEntryDepth(snapshot.pc));
+    if (!fits) {
+        throw std::runtime_error("Snapshot does not fit the program");
+    }
+    
+    allocations = 0;
+    assignCounted(stack, snapshot.stack.size(), Value(0), allocations);
+    std::copy(snapshot.stack.begin(), snapshot.stack.end(), stack.begin());
+    assignCounted(frame, slots, Value(0), allocations);
+    std::copy(snapshot.frame.begin(), snapshot.frame.end(), frame.begin());
+    assignCounted(assigned, slots, static_cast<unsigned char>(0), allocations);
+    std::copy(snapshot.assigned.begin(), snapshot.assigned.end(), assigned.begin());
+    instructionCount = snapshot.instructionCount;
+    budget.beginExecute(getOutput(), snapshot.outputBytes,
+                        std::chrono::nanoseconds(static_cast<std::int64_t>(snapshot.wallTimeNanos)));
+    outputStartBytes = getOutput().getByteCount() - snapshot.outputBytes;
+    outputStartLines = getOutput().getLineCount() - snapshot.outputLines;
+    beginProgram(program);
+    
+    paused = true;
+    pausedPc = snapshot.pc;
+    pauseReason = PauseReason::Restored;
+}
+
+void VirtualMachine::fillSnapshot(VMSnapshot& out, int pc, std::int64_t executed,
+                                  const Value* values, int depth) const {
+    out.programFingerprint = programFingerprint;
+    out.pc = pc;
+    out.instructionCount = executed;
+    out.outputBytes = getOutput().getByteCount() - outputStartBytes;
+    out.outputLines = getOutput().getLineCount() - outputStartLines;
+    out.wallTimeNanos = static_cast<std::uint64_t>(budget.timeSpent().count());
+    out.stack.assign(values, values + depth);
+    out.frame.assign(frame.begin(), frame.end());
+    out.assigned.assign(assigned.begin(), assigned.end());
+}
+
+void VirtualMachine::saveCheckpoint(int pc, std::int64_t executed, const Value* values, int depth) {
+    fillSnapshot(snapshot, pc, executed, values, depth);
+    snapshotAt = executed + checkpointInterval;
+    if (onCheckpoint) onCheckpoint(snapshot);
+}
+
+void VirtualMachine::reserve(int slots, int stackDepth) {
+    reservedSlots = std::max(reservedSlots, slots);
+    reservedStackDepth = std::max(reservedStackDepth, stackDepth);
+    frame.reserve(reservedSlots);
+    assigned.reserve(reservedSlots);
+    // Room for the cached loop's slack slot and the checked loop's initial 64 entries
+    stack.reserve(std::max(reservedStackDepth + 1, 64));
+}
+
+void VirtualMachine::reset() {
+    // Run state
     stack.clear();
-    variables.clear();
+    frame.clear();
+    assigned.clear();
+    slotNames = nullptr;
+    program = nullptr;
     instructionCount = 0;
+    allocations = 0;
+    traceBuffer.clear();
+    profile.reset(0);
+    sampler.reset(0);
+    compiledLoops.clear();
+    tierUps.clear();
+    breakpoints.clear();
+    paused = false;
+    pausedPc = -1;
+    resumePausedAt = -1;
+    pauseReason = PauseReason::None;
+    snapshotAt = INT64_MAX;
+    yieldAt = INT64_MAX;
+    
+    // Configuration
+    dispatchMode = DispatchMode::Threaded;
+    observerMode = ObserverMode::None;
+    sampler.setInterval(SamplingProfiler::defaultInterval);
+    engine = ExecutionEngine::Interpreter;
+    tierUpThreshold = DEFAULT_TIER_UP_THRESHOLD;
+    nativeTier = true;
+    lastEngine = ExecutionEngine::Interpreter;
+    output = nullptr;
+    budget.setBudget(ExecutionBudget());
+    checkpointInterval = 0;
+    onCheckpoint = nullptr;
+    timeSlice = 0;
+    
+    // Give back what a large program grew beyond the limit, keeping the reservation
+    if (getRetainedMemory() > retainedMemoryLimit) {
+        std::vector<Value>().swap(stack);
+        std::vector<Value>().swap(frame);
+        std::vector<unsigned char>().swap(assigned);
+        std::vector<unsigned char>().swap(breakpoints);
+        std::vector<std::uint32_t>().swap(backEdgeCounts);
+        std::vector<int>().swap(loopAt);
+        snapshot = VMSnapshot();
+        profile.release();
+        sampler.release();
+        reserve(reservedSlots, reservedStackDepth);
+    }
+}
+
+size_t VirtualMachine::getRetainedMemory() const {
+    return stack.capacity() * sizeof(Value) + frame.capacity() * sizeof(Value) + assigned.capacity() +
+           breakpoints.capacity() + profile.capacity() * 2 * sizeof(std::uint64_t) +
+           sampler.capacity() * sizeof(std::uint64_t) + backEdgeCounts.capacity() * sizeof(std::uint32_t) +
+           loopAt.capacity() * sizeof(int) +
+           (snapshot.stack.capacity() + snapshot.frame.capacity()) * sizeof(Value) + snapshot.assigned.capacity();
+}
+
+void VirtualMachine::resume() {
+    if (!paused) {
+        throw std::runtime_error("VM is not paused");
+    }
+    run(pausedPc);
+}
+
+std::uint64_t VirtualMachine::getOpcodeCount(OpCode opcode) const {
+    std::uint64_t total = 0;
+    for (size_t pc = 0; pc < profile.size(); ++pc) {
+        if ((*program)[pc].opcode == opcode) {
+            total += profile.getCount(pc);
+        }
+    }
+    return total;
+}
+
+void VirtualMachine::addBreakpoint(int pc) {
+    if (pc < 0) return;
+    if (static_cast<size_t>(pc) >= breakpoints.size()) {
+        breakpoints.resize(pc + 1, 0);
+    }
+    breakpoints[pc] = 1;
+}
+
+void VirtualMachine::removeBreakpoint(int pc) {
+    if (pc >= 0 && static_cast<size_t>(pc) < breakpoints.size()) {
+        breakpoints[pc] = 0;
+    }
+}
+
+void VirtualMachine::run(int startPc) {
+    // A resumed run steps over the breakpoint it stopped at
+    resumePausedAt = paused && pauseReason == PauseReason::Breakpoint ? startPc : -1;
+    paused = false;
+    pausedPc = -1;
+    pauseReason = PauseReason::None;
+    
+    budget.beginRun(instructionCount);
+    yieldAt = timeSlice > 0 ? instructionCount + timeSlice : INT64_MAX;
+    
+    // Output reaches its destination even when the program fails part-way
+    OutputSink& sink = getOutput();
+    try {
+        // The JIT and the tiered engine have no observer hooks, checkpoints or
+        // time slices and only start programs from the top
+        lastEngine = ExecutionEngine::Interpreter;
+        bool plain = observerMode == ObserverMode::None && !interruptible() && startPc == 0;
+        bool jitted = engine == ExecutionEngine::Jit && plain && runJit();
+        bool tiered = engine == ExecutionEngine::Tiered && plain && program->isVerified();
+        if (tiered) {
+            runTiered();
+        } else if (!jitted) {
+            runObserved(startPc);
+        }
+    } catch (...) {
+        budget.endRun();
+        sink.flush();
+        throw;
+    }
+    budget.endRun();
+    sink.flush();
+}
+
+bool VirtualMachine::runJit() {
+    JitCompiler compiler;
+    compiler.setBudgetChecks(!budget.getBudget().isUnlimited());
+    std::unique_ptr<JitCode> code = compiler.compile(*program);
+    if (!code) {
+        return false;
+    }
+    lastEngine = ExecutionEngine::Jit;
+    ++allocations;
+    stack.clear();
+    runNative(*code);
+    return true;
+}
+
+void VirtualMachine::runNative(const JitCode& code) {
+    // Generated code works directly on the frame and uses the stack vector,
+    // sized by the verifier, as its spill area: the values on the stack are
+    // there when it starts and when it reaches a HALT
+    resizeCounted(stack, std::max(program->getVerifiedStackDepth(), 1), allocations);
+    std::int64_t base = instructionCount;   // The generated code counts from 0
+    JitRuntime runtime;
+    runtime.output = &getOutput();
+    BudgetKind exceeded = BudgetKind::None;
+    runtime.budgetCheck = [&](JitContext& context) {
+        instructionCount = base + context.instructionCount;
+        exceeded = checkBudget();
+        context.checkpoint = budget.nextCheckpoint() - base;
+        return exceeded != BudgetKind::None;
+    };
+    JitContext context{frame.data(), assigned.data(), stack.data(), &runtime, 0, JIT_OK, -1,
+                       budget.nextCheckpoint() - base, 0, 0};
+    
+    code.run(context);
+    instructionCount = base + context.instructionCount;
+    
+    if (context.error != JIT_OK) {
+        stack.clear();
+    }
+    switch (context.error) {
+        case JIT_DIVISION_BY_ZERO:
+            throw std::runtime_error("Runtime error: Division by zero");
+        case JIT_MODULO_BY_ZERO:
+            throw std::runtime_error("Runtime error: Modulo by zero");
+        case JIT_OVERFLOW:
+            throw std::runtime_error(OVERFLOW_ERROR);
+        case JIT_PRINT_FAILED:
+            std::rethrow_exception(runtime.printError);
+        case JIT_BUDGET_EXCEEDED:
+            throwBudgetExceeded(exceeded, context.errorPc);
+        default:
+            stack.resize(context.exitDepth);
+            exitPc = context.exitPc;
+            break;
+    }
+}
+
+// A loop runs in the interpreter until its back edge has been taken
+// tierUpThreshold times; the interpreter then stops at the loop header, the
+// loop is compiled for the stack depth it has there, and it runs until it
+// branches out. Later entries switch over on their first back edge.
+void VirtualMachine::runTiered() {
+    lastEngine = ExecutionEngine::Tiered;
+    const auto& instructions = program->getInstructions();
+    assignCounted(backEdgeCounts, instructions.size(), 0u, allocations);
+    assignCounted(loopAt, instructions.size(), -1, allocations);
+    
+    TierUpObserver observer{backEdgeCounts.data(), tierUpThreshold};
+    int pc = 0;
+    for (;;) {
+        observer.hotHeader = -1;
+        runThreaded<false>(instructions, pc, program->getVerifiedStackDepth(), observer);
+        if (observer.hotHeader < 0) {
+            return;   // HALT
+        }
+        pc = runCompiledLoop(observer.hotHeader, observer.hotBackEdge);
+    }
+}
+
+int VirtualMachine::runCompiledLoop(int header, int backEdge) {
+    int index = loopAt[header];
+    if (index < 0) {
+        ++allocations;   // A compile counts as one allocation
+        auto compiled = std::make_unique<CompiledLoop>(
+            *program, header, backEdge, static_cast<int>(stack.size()),
+            nativeTier ? LoopTier::Native : LoopTier::Fused, !budget.getBudget().isUnlimited());
+        LoopTier tier = compiled->getTier();
+        tierUps.push_back({header, backEdge, program->getLine(backEdge), tier, instructionCount, 0,
+                           tier == LoopTier::Interpreter ? 0 : compiled->codeSize()});
+        if (tier == LoopTier::Interpreter) {
+            // Switching to an identical copy would only add entry costs: park
+            // the counter above the threshold and carry on at the header
+            compiledLoops.push_back(nullptr);
+            backEdgeCounts[header] = tierUpThreshold + 1;
+            return header;
+        }
+        compiledLoops.push_back(std::move(compiled));
+        index = static_cast<int>(compiledLoops.size()) - 1;
+        loopAt[header] = index;
+    }
+    const CompiledLoop& loop = *compiledLoops[index];
+    ++tierUps[index].entries;
+    
+    runningLoop = &loop;
+    try {
+        if (loop.getNative()) {
+            runNative(*loop.getNative());
+        } else {
+            NoObserver observer;
+            runThreaded<false>(loop.getCode().getInstructions(), 0, loop.getCode().getVerifiedStackDepth(),
+                               observer);
+        }
+    } catch (...) {
+        runningLoop = nullptr;
+        throw;
+    }
+    runningLoop = nullptr;
+    return exitPc;
+}
+
+void VirtualMachine::runObserved(int startPc) {
+    switch (observerMode) {
+        case ObserverMode::None: {
+            NoObserver observer;
+            runWith(startPc, observer);
+            break;
+        }
+        case ObserverMode::Trace: {
+            TraceObserver observer{traceBuffer};
+            runWith(startPc, observer);
+            break;
+        }
+        case ObserverMode::Profile: {
+            ProfileObserver observer{profile};
+            try {
+                runWith(startPc, observer);
+            } catch (...) {
+                observer.finish();
+                throw;
+            }
+            observer.finish();
+            break;
+        }
+        case ObserverMode::TraceProfile: {
+            TraceProfileObserver observer{TraceObserver{traceBuffer}, ProfileObserver{profile}};
+            try {
+                runWith(startPc, observer);
+            } catch (...) {
+                observer.finish();
+                throw;
+            }
+            observer.finish();
+            break;
+        }
+        case ObserverMode::Sample: {
+            SampleObserver observer{sampler.instructionCell()};
+            SamplingProfiler::Session session(sampler, program->getInstructions().data());
+            runWith(startPc, observer);
+            break;
+        }
+        case ObserverMode::Breakpoint: {
+            BreakpointObserver observer{breakpoints, resumePausedAt};
+            runWith(startPc, observer);
+            break;
+        }
+    }
+}
+
+template <class Observer>
+void VirtualMachine::runWith(int startPc, Observer& observer) {
+    const auto& instructions = program->getInstructions();
+    
+    // The threaded loop relies on a trailing HALT instead of checking for the
+    // end of the program on every instruction
+    bool endsWithHalt = !instructions.empty() && instructions.back().opcode == OpCode::HALT;
     
-    const auto& instructions = program.getInstructions();
-    int pc = 0; // Program counter (changed to int to allow modification by jumps)
+    bool threaded = dispatchMode == DispatchMode::Threaded || dispatchMode == DispatchMode::Cached;
     
-    if (traceMode) {
-        std::cout << "\n=== VM Execution Trace ===\n";
+    if constexpr (!Observer::enabled) {
+        // The cached loop relies on verification and has no observer hook,
+        // checkpoints or time slices; other programs and modes run on the
+        // plain threaded loop
+        if (dispatchMode == DispatchMode::Cached && program->isVerified() && startPc == 0 &&
+            !interruptible()) {
+            runCached(instructions, program->getVerifiedStackDepth());
+            return;
+        }
     }
     
+    if (threaded && program->isVerified()) {
+        // BytecodeVerifier proved stack bounds, jump targets and stores before loads
+        runThreaded<false>(instructions, startPc, program->getVerifiedStackDepth(), observer);
+    } else if (threaded && endsWithHalt) {
+        runThreaded<true>(instructions, startPc, 0, observer);
+    } else {
+        runClassic(instructions, startPc, observer);
+    }
+}
+
+template <class Observer>
+void VirtualMachine::runClassic(const std::vector<Instruction>& instructions, int startPc,
+                                Observer& observer) {
+    int pc = startPc; // Program counter (changed to int to allow modification by jumps)
+    
+    // Budgets, checkpoints and slice ends are checked on backward jumps only;
+    // a slice ends once the jump has been taken
+    bool sliceEnded = false;
+    auto backEdge = [&](int target) {
+        if (target <= pc && instructionCount >= nextCheckpoint()) {
+            BudgetKind exceeded = checkBudget();
+            if (exceeded != BudgetKind::None) {
+                throwBudgetExceeded(exceeded, pc);
+            }
+            if (instructionCount >= snapshotAt) {
+                saveCheckpoint(target, instructionCount + 1, stack.data(), static_cast<int>(stack.size()));
+            }
+            sliceEnded = instructionCount >= yieldAt;
+        }
+    };
+    
     // Execute until HALT or end of program
     while (pc >= 0 && pc < static_cast<int>(instructions.size())) {
         const Instruction& instr = instructions[pc];
         
-        if (traceMode) {
-            printTrace(pc, instr);
+        if (sliceEnded) {
+            paused = true;
+            pausedPc = pc;
+            pauseReason = PauseReason::TimeSlice;
+            return;
+        }
+        
+        if constexpr (Observer::enabled) {
+            if (!observer.before(pc, instr, stack.data(), static_cast<int>(stack.size()))) {
+                paused = true;
+                pausedPc = pc;
+                pauseReason = PauseReason::Breakpoint;
+                return;
+            }
         }
         
         // Check for HALT
@@ -30,22 +517,55 @@ void VirtualMachine::execute(const BytecodeProgram& program) {
         
         // Handle jump instructions specially (they modify pc)
         if (instr.opcode == OpCode::JUMP) {
-            pc = instr.intOperand;
+            backEdge(instr.operand);
+            pc = instr.operand;
             instructionCount++;
             continue;
         } else if (instr.opcode == OpCode::JUMP_IF_FALSE) {
-            int condition = pop();
+            Value condition = pop();
             if (condition == 0) {
-                pc = instr.intOperand;
+                backEdge(instr.operand);
+                pc = instr.operand;
             } else {
                 pc++;
             }
             instructionCount++;
             continue;
         } else if (instr.opcode == OpCode::JUMP_IF_TRUE) {
-            int condition = pop();
+            Value condition = pop();
             if (condition != 0) {
-                pc = instr.intOperand;
+                backEdge(instr.operand);
+                pc = instr.operand;
+            } else {
+                pc++;
+            }
+            instructionCount++;
+            continue;
+        } else if (isCompareBranchOpcode(instr.opcode)) {
+            Value b = pop();
+            Value a = pop();
+            if (!compareForBranch(instr.opcode, a, b)) {
+                backEdge(instr.operand);
+                pc = instr.operand;
+            } else {
+                pc++;
+            }
+            instructionCount++;
+            continue;
+        } else if (isForLoopOpcode(instr.opcode)) {
+            Value limit = peek();
+            Value counter = loadSlot(instr.aux);
+            if (instr.opcode == OpCode::FOR_LOOP) {
+                if (addOverflows(counter, 1, counter)) {
+                    throw std::runtime_error(OVERFLOW_ERROR);
+                }
+                frame[instr.aux] = counter;
+            }
+            // FOR_PREP skips an empty loop, FOR_LOOP repeats while in range
+            bool taken = instr.opcode == OpCode::FOR_PREP ? counter > limit : counter <= limit;
+            if (taken) {
+                backEdge(instr.operand);
+                pc = instr.operand;
             } else {
                 pc++;
             }
@@ -57,136 +577,825 @@ void VirtualMachine::execute(const BytecodeProgram& program) {
         instructionCount++;
         pc++;
     }
+}
+
+// Threaded interpreter: fetch, decode and execute live in one function so the
+// compiler can keep pc, the stack pointer and the counter in registers. With
+// GCC/Clang each handler jumps straight to the next one through a label table
+// (computed goto); other compilers get an equivalent switch loop.
+//
+// Checked = false is only used for verified programs: stack underflow/overflow,
+// jump range and unassigned-slot checks compile away, and the stack is
+// allocated once at exactly the verified depth.
+//
+// The Observer policy is called before each dispatch only when
+// Observer::enabled, so the NoObserver instantiation has no hook at all.
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_COMPUTED_GOTO 1
+#else
+#define VM_COMPUTED_GOTO 0
+#endif
+
+// GCC merges identical handler tails (cross-jumping), which funnels several
+// opcodes through one shared indirect jump and costs the branch predictor
+// its per-opcode history; the checked arithmetic handlers are prone to it
+#if defined(__GNUC__) && !defined(__clang__)
+#define VM_DISPATCH_LOOP __attribute__((optimize("no-crossjumping")))
+#else
+#define VM_DISPATCH_LOOP
+#endif
+
+template <bool Checked, class Observer>
+VM_DISPATCH_LOOP void VirtualMachine::runThreaded(const std::vector<Instruction>& instructions, int startPc,
+                                                  int stackDepth, Observer& observer) {
+    const Instruction* const code = instructions.data();
+    const unsigned codeSize = static_cast<unsigned>(instructions.size());
+    const Instruction* ip = code + startPc;
+    const Value* const constants = program->getConstants().data();   // Compiled loops share the program's pool
+    const unsigned constantCount = static_cast<unsigned>(program->getConstants().size());
+    
+    Value* const slots = frame.data();
+    unsigned char* const slotSet = assigned.data();
+    OutputSink* const out = &getOutput();
+    
+    // Raw stack pointer over the stack vector (which holds any values left
+    // by a paused run); grows on demand when checked
+    size_t depth = stack.size();
+    if (!Checked) {
+        resizeCounted(stack, stackDepth, allocations);
+    } else if (stack.size() < 64) {
+        resizeCounted(stack, 64, allocations);
+    }
+    Value* base = stack.data();
+    Value* limit = base + stack.size();
+    Value* sp = base + depth;
+    
+    std::int64_t count = instructionCount;
+    std::int64_t checkpoint = nextCheckpoint();
+    
+    // Publish the local state before leaving the loop (normally or by error)
+#define VM_SYNC() \
+    do { instructionCount = count; stack.resize(sp - base); } while (0)
+#define VM_FAIL(message) \
+    do { VM_SYNC(); throw std::runtime_error(message); } while (0)
+#define VM_NEED(n) \
+    do { if (Checked && sp - base < (n)) VM_FAIL("Stack underflow"); } while (0)
+#define VM_PUSH(value) \
+    do { \
+        if (Checked && sp == limit) { \
+            size_t used = sp - base; \
+            resizeCounted(stack, stack.size() * 2, allocations); \
+            base = stack.data(); \
+            limit = base + stack.size(); \
+            sp = base + used; \
+        } \
+        *sp++ = (value); \
+    } while (0)
+// Budgets, checkpoints and slice ends are checked on backward jumps once
+// count reaches the checkpoint; a snapshot or a slice end records the state
+// after the jump to dest
+#define VM_CHECK_BUDGET(dest) \
+    do { \
+        instructionCount = count; \
+        BudgetKind exceeded = checkBudget(); \
+        if (exceeded != BudgetKind::None) { \
+            VM_SYNC(); \
+            throwBudgetExceeded(exceeded, static_cast<int>(ip - code)); \
+        } \
+        if (count >= snapshotAt) { \
+            saveCheckpoint(static_cast<int>(dest), count + 1, base, static_cast<int>(sp - base)); \
+        } \
+        if (count >= yieldAt) { \
+            ++count; \
+            ip = code + (dest); \
+            paused = true; \
+            pausedPc = static_cast<int>(dest); \
+            pauseReason = PauseReason::TimeSlice; \
+            goto vm_done; \
+        } \
+        checkpoint = nextCheckpoint(); \
+    } while (0)
+#define VM_JUMP(target) \
+    do { \
+        unsigned dest = static_cast<unsigned>(target); \
+        if (Checked && dest >= codeSize) { ++count; goto vm_done; } \
+        if (code + dest <= ip && count >= checkpoint) VM_CHECK_BUDGET(dest); \
+        if constexpr (ObservesBackEdges<Observer>::value) { \
+            if (code + dest <= ip && observer.onBackEdge(static_cast<int>(dest), static_cast<int>(ip - code))) { \
+                ++count; \
+                ip = code + dest; \
+                goto vm_done; \
+            } \
+        } \
+        ip = code + dest; \
+    } while (0)
+#define VM_BINARY(expr) \
+    do { VM_NEED(2); Value b = *--sp; Value a = sp[-1]; sp[-1] = (expr); } while (0)
+// Checked arithmetic (see Value.h): the operands stay on the stack on overflow
+#define VM_CHECKED(checkedOp) \
+    do { \
+        VM_NEED(2); \
+        Value result; \
+        if (checkedOp(sp[-2], sp[-1], result)) goto vm_overflow; \
+        --sp; \
+        sp[-1] = result; \
+    } while (0)
+// slot[aux] op operand, pushed (SLOT_*_CONST)
+#define VM_SLOT_CHECKED(checkedOp) \
+    do { \
+        VM_CHECK_SLOT(ip->aux); \
+        Value result; \
+        if (checkedOp(slots[ip->aux], ip->operand, result)) goto vm_overflow; \
+        VM_PUSH(result); \
+    } while (0)
+#define VM_OBSERVE() \
+    do { \
+        if (!observer.before(static_cast<int>(ip - code), *ip, base, static_cast<int>(sp - base))) { \
+            paused = true; \
+            pausedPc = static_cast<int>(ip - code); \
+            pauseReason = PauseReason::Breakpoint; \
+            goto vm_done; \
+        } \
+    } while (0)
+#define VM_CHECK_SLOT(slot) \
+    do { \
+        if (Checked && !slotSet[slot]) { \
+            VM_FAIL("Runtime error: Variable '" + (*slotNames)[slot] + "' not found"); \
+        } \
+    } while (0)
+// Plain block (not do/while) so VM_CONTINUE/VM_NEXT still reach the switch loop
+#define VM_COMPARE_BRANCH(cond) \
+    { \
+        VM_NEED(2); \
+        Value b = sp[-1]; \
+        Value a = sp[-2]; \
+        sp -= 2; \
+        if (!(cond)) { \
+            VM_JUMP(ip->operand); \
+            VM_CONTINUE(); \
+        } \
+        VM_NEXT(); \
+    }
+
+#if VM_COMPUTED_GOTO
+    // Must list every opcode in OpCode declaration order
+    static const void* const dispatchTable[] = {
+        &&op_LOAD_CONST, &&op_LOAD_CONST_WIDE, &&op_LOAD_VAR, &&op_STORE_VAR, &&op_LOAD_SLOT, &&op_STORE_SLOT,
+        &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD,
+        &&op_CMP_LT, &&op_CMP_GT, &&op_CMP_LTE, &&op_CMP_GTE, &&op_CMP_EQ, &&op_CMP_NEQ,
+        &&op_AND, &&op_OR, &&op_NOT,
+        &&op_JUMP, &&op_JUMP_IF_FALSE, &&op_JUMP_IF_TRUE,
+        &&op_POP, &&op_DUP,
+        &&op_INC_SLOT, &&op_SLOT_ADD_CONST, &&op_SLOT_SUB_CONST, &&op_SLOT_MUL_CONST,
+        &&op_SLOT_DIV_CONST, &&op_SLOT_MOD_CONST,
+        &&op_JUMP_IF_NOT_LT, &&op_JUMP_IF_NOT_GT, &&op_JUMP_IF_NOT_LTE,
+        &&op_JUMP_IF_NOT_GTE, &&op_JUMP_IF_NOT_EQ, &&op_JUMP_IF_NOT_NEQ,
+        &&op_STORE_LOAD_SLOT,
+        &&op_FOR_PREP, &&op_FOR_LOOP,
+        &&op_PRINT, &&op_HALT
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) ==
+                  static_cast<size_t>(OpCode::HALT) + 1,
+                  "dispatchTable must cover every opcode");
+#define VM_CASE(name) op_##name
+#define VM_DISPATCH() \
+    do { \
+        if constexpr (Observer::enabled) VM_OBSERVE(); \
+        goto *dispatchTable[static_cast<int>(ip->opcode)]; \
+    } while (0)
+#define VM_NEXT() do { ++count; ++ip; VM_DISPATCH(); } while (0)
+#define VM_CONTINUE() do { ++count; VM_DISPATCH(); } while (0)
+    VM_DISPATCH();
+#else
+#define VM_CASE(name) case OpCode::name
+#define VM_NEXT() { ++count; ++ip; continue; }
+#define VM_CONTINUE() { ++count; continue; }
+    for (;;) {
+    if constexpr (Observer::enabled) VM_OBSERVE();
+    switch (ip->opcode) {
+#endif
+    
+    VM_CASE(LOAD_CONST):
+        VM_PUSH(ip->operand);
+        VM_NEXT();
+    
+    VM_CASE(LOAD_CONST_WIDE):
+        if (Checked && static_cast<unsigned>(ip->operand) >= constantCount) VM_FAIL("Constant index out of range");
+        VM_PUSH(constants[ip->operand]);
+        VM_NEXT();
+    
+    VM_CASE(LOAD_VAR):
+    VM_CASE(LOAD_SLOT):
+        VM_CHECK_SLOT(ip->operand);
+        VM_PUSH(slots[ip->operand]);
+        VM_NEXT();
+    
+    VM_CASE(STORE_VAR):
+    VM_CASE(STORE_SLOT):
+        VM_NEED(1);
+        slots[ip->operand] = *--sp;
+        slotSet[ip->operand] = 1;
+        VM_NEXT();
+    
+    VM_CASE(ADD): VM_CHECKED(addOverflows); VM_NEXT();
+    VM_CASE(SUB): VM_CHECKED(subOverflows); VM_NEXT();
+    VM_CASE(MUL): VM_CHECKED(mulOverflows); VM_NEXT();
+    
+    VM_CASE(DIV):
+        VM_NEED(2);
+        if (sp[-1] == 0) VM_FAIL("Runtime error: Division by zero");
+        VM_CHECKED(divOverflows);
+        VM_NEXT();
+    
+    VM_CASE(MOD):
+        VM_NEED(2);
+        if (sp[-1] == 0) VM_FAIL("Runtime error: Modulo by zero");
+        VM_BINARY(checkedRemainder(a, b));
+        VM_NEXT();
+    
+    VM_CASE(CMP_LT):  VM_BINARY((a < b) ? 1 : 0);  VM_NEXT();
+    VM_CASE(CMP_GT):  VM_BINARY((a > b) ? 1 : 0);  VM_NEXT();
+    VM_CASE(CMP_LTE): VM_BINARY((a <= b) ? 1 : 0); VM_NEXT();
+    VM_CASE(CMP_GTE): VM_BINARY((a >= b) ? 1 : 0); VM_NEXT();
+    VM_CASE(CMP_EQ):  VM_BINARY((a == b) ? 1 : 0); VM_NEXT();
+    VM_CASE(CMP_NEQ): VM_BINARY((a != b) ? 1 : 0); VM_NEXT();
+    
+    VM_CASE(AND): VM_BINARY((a && b) ? 1 : 0); VM_NEXT();
+    VM_CASE(OR):  VM_BINARY((a || b) ? 1 : 0); VM_NEXT();
+    
+    VM_CASE(NOT):
+        VM_NEED(1);
+        sp[-1] = !sp[-1] ? 1 : 0;
+        VM_NEXT();
+    
+    VM_CASE(JUMP):
+        VM_JUMP(ip->operand);
+        VM_CONTINUE();
+    
+    VM_CASE(JUMP_IF_FALSE):
+        VM_NEED(1);
+        if (*--sp == 0) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    
+    VM_CASE(JUMP_IF_TRUE):
+        VM_NEED(1);
+        if (*--sp != 0) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    
+    VM_CASE(POP):
+        VM_NEED(1);
+        --sp;
+        VM_NEXT();
+    
+    VM_CASE(DUP): {
+        if (Checked && sp == base) VM_FAIL("Stack is empty");
+        Value value = sp[-1];
+        VM_PUSH(value);
+        VM_NEXT();
+    }
+    
+    VM_CASE(INC_SLOT): {
+        VM_CHECK_SLOT(ip->aux);
+        Value result;
+        if (addOverflows(slots[ip->aux], ip->operand, result)) goto vm_overflow;
+        slots[ip->aux] = result;
+        VM_NEXT();
+    }
+    
+    VM_CASE(SLOT_ADD_CONST): VM_SLOT_CHECKED(addOverflows); VM_NEXT();
+    VM_CASE(SLOT_SUB_CONST): VM_SLOT_CHECKED(subOverflows); VM_NEXT();
+    VM_CASE(SLOT_MUL_CONST): VM_SLOT_CHECKED(mulOverflows); VM_NEXT();
+    VM_CASE(SLOT_DIV_CONST): VM_SLOT_CHECKED(divOverflows); VM_NEXT();
+    
+    VM_CASE(SLOT_MOD_CONST):
+        VM_CHECK_SLOT(ip->aux);
+        VM_PUSH(checkedRemainder(slots[ip->aux], ip->operand));
+        VM_NEXT();
+    
+    VM_CASE(JUMP_IF_NOT_LT):  VM_COMPARE_BRANCH(a < b);
+    VM_CASE(JUMP_IF_NOT_GT):  VM_COMPARE_BRANCH(a > b);
+    VM_CASE(JUMP_IF_NOT_LTE): VM_COMPARE_BRANCH(a <= b);
+    VM_CASE(JUMP_IF_NOT_GTE): VM_COMPARE_BRANCH(a >= b);
+    VM_CASE(JUMP_IF_NOT_EQ):  VM_COMPARE_BRANCH(a == b);
+    VM_CASE(JUMP_IF_NOT_NEQ): VM_COMPARE_BRANCH(a != b);
+    
+    VM_CASE(STORE_LOAD_SLOT):
+        VM_NEED(1);
+        slots[ip->aux] = sp[-1];
+        slotSet[ip->aux] = 1;
+        VM_CHECK_SLOT(ip->operand);
+        sp[-1] = slots[ip->operand];
+        VM_NEXT();
+    
+    VM_CASE(FOR_PREP):
+        VM_NEED(1);
+        VM_CHECK_SLOT(ip->aux);
+        if (slots[ip->aux] > sp[-1]) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    
+    VM_CASE(FOR_LOOP): {
+        VM_NEED(1);
+        VM_CHECK_SLOT(ip->aux);
+        Value counter;
+        if (addOverflows(slots[ip->aux], 1, counter)) goto vm_overflow;
+        slots[ip->aux] = counter;
+        if (counter <= sp[-1]) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    }
+    
+    VM_CASE(PRINT):
+        VM_NEED(1);
+        instructionCount = count;   // Stays accurate if the sink throws
+        out->printInt(*--sp);
+        VM_NEXT();
+    
+    VM_CASE(HALT):
+        exitPc = ip->operand;   // Where a compiled loop's exit resumes
+        goto vm_done;
     
-    if (traceMode) {
-        std::cout << "=== Execution Complete ===\n";
-        std::cout << "Instructions executed: " << instructionCount << "\n\n";
+#if !VM_COMPUTED_GOTO
+    default:
+        VM_FAIL("Unknown opcode");
     }
+    }
+#endif
+
+vm_done:
+    VM_SYNC();
+    return;
+
+// One shared exit keeps the throw out of the arithmetic handlers
+vm_overflow:
+    VM_FAIL(OVERFLOW_ERROR);
+
+#undef VM_SYNC
+#undef VM_FAIL
+#undef VM_NEED
+#undef VM_PUSH
+#undef VM_CHECK_BUDGET
+#undef VM_JUMP
+#undef VM_BINARY
+#undef VM_CHECKED
+#undef VM_SLOT_CHECKED
+#undef VM_OBSERVE
+#undef VM_CHECK_SLOT
+#undef VM_COMPARE_BRANCH
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_CONTINUE
+#if VM_COMPUTED_GOTO
+#undef VM_DISPATCH
+#endif
+}
+
+// Top-of-stack cached loop for verified programs without an observer. The
+// top value lives in the local `tos` instead of memory, so a binary operation
+// reads one operand from memory and writes none (the threaded loop reads two
+// and writes one), and pushes/pops move one value between `tos` and memory.
+//
+// Invariant: the logical stack is base[0 .. sp-base-1] followed by tos, i.e.
+// depth = sp - base + 1. An empty stack has sp == base - 1; the vector keeps
+// one slack slot below base so spilling or refilling an empty cache stays in
+// bounds. Verification guarantees the program never pops an empty stack, so
+// the value in tos is only ever read when it is real.
+VM_DISPATCH_LOOP void VirtualMachine::runCached(const std::vector<Instruction>& instructions, int stackDepth) {
+    const Instruction* const code = instructions.data();
+    const Instruction* ip = code;
+    const Value* const constants = program->getConstants().data();
+    
+    Value* const slots = frame.data();
+    unsigned char* const slotSet = assigned.data();
+    OutputSink* const out = &getOutput();
+    
+    assignCounted(stack, stackDepth + 1, Value(0), allocations);
+    Value* const base = stack.data() + 1;
+    Value* sp = base - 1;
+    Value tos = 0;
+    
+    std::int64_t count = instructionCount;
+    std::int64_t checkpoint = budget.nextCheckpoint();
+    
+    // Spill the cached value and publish the stack before leaving the loop
+#define VM_SYNC() \
+    do { \
+        instructionCount = count; \
+        *sp = tos; \
+        size_t depth = sp - base + 1; \
+        stack.erase(stack.begin()); \
+        stack.resize(depth); \
+    } while (0)
+#define VM_FAIL(message) \
+    do { VM_SYNC(); throw std::runtime_error(message); } while (0)
+#define VM_PUSH(value) \
+    do { Value pushed = (value); *sp++ = tos; tos = pushed; } while (0)
+#define VM_POP() (tos = *--sp)
+#define VM_CHECK_BUDGET() \
+    do { \
+        instructionCount = count; \
+        BudgetKind exceeded = checkBudget(); \
+        if (exceeded != BudgetKind::None) { \
+            VM_SYNC(); \
+            throwBudgetExceeded(exceeded, static_cast<int>(ip - code)); \
+        } \
+        checkpoint = budget.nextCheckpoint(); \
+    } while (0)
+#define VM_JUMP(target) \
+    do { \
+        const Instruction* dest = code + (target); \
+        if (dest <= ip && count >= checkpoint) VM_CHECK_BUDGET(); \
+        ip = dest; \
+    } while (0)
+#define VM_BINARY(expr) \
+    do { Value b = tos; Value a = *--sp; tos = (expr); } while (0)
+// Checked arithmetic (see Value.h): the operands stay on the stack on overflow
+#define VM_CHECKED(checkedOp) \
+    do { \
+        Value result; \
+        if (checkedOp(sp[-1], tos, result)) goto vm_overflow; \
+        --sp; \
+        tos = result; \
+    } while (0)
+// slot[aux] op operand, pushed (SLOT_*_CONST)
+#define VM_SLOT_CHECKED(checkedOp) \
+    do { \
+        Value result; \
+        if (checkedOp(slots[ip->aux], ip->operand, result)) goto vm_overflow; \
+        VM_PUSH(result); \
+    } while (0)
+// Plain block (not do/while) so VM_CONTINUE/VM_NEXT still reach the switch loop
+#define VM_COMPARE_BRANCH(cond) \
+    { \
+        Value b = tos; \
+        Value a = sp[-1]; \
+        tos = sp[-2]; \
+        sp -= 2; \
+        if (!(cond)) { \
+            VM_JUMP(ip->operand); \
+            VM_CONTINUE(); \
+        } \
+        VM_NEXT(); \
+    }
+
+#if VM_COMPUTED_GOTO
+    // Must list every opcode in OpCode declaration order
+    static const void* const dispatchTable[] = {
+        &&op_LOAD_CONST, &&op_LOAD_CONST_WIDE, &&op_LOAD_VAR, &&op_STORE_VAR, &&op_LOAD_SLOT, &&op_STORE_SLOT,
+        &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD,
+        &&op_CMP_LT, &&op_CMP_GT, &&op_CMP_LTE, &&op_CMP_GTE, &&op_CMP_EQ, &&op_CMP_NEQ,
+        &&op_AND, &&op_OR, &&op_NOT,
+        &&op_JUMP, &&op_JUMP_IF_FALSE, &&op_JUMP_IF_TRUE,
+        &&op_POP, &&op_DUP,
+        &&op_INC_SLOT, &&op_SLOT_ADD_CONST, &&op_SLOT_SUB_CONST, &&op_SLOT_MUL_CONST,
+        &&op_SLOT_DIV_CONST, &&op_SLOT_MOD_CONST,
+        &&op_JUMP_IF_NOT_LT, &&op_JUMP_IF_NOT_GT, &&op_JUMP_IF_NOT_LTE,
+        &&op_JUMP_IF_NOT_GTE, &&op_JUMP_IF_NOT_EQ, &&op_JUMP_IF_NOT_NEQ,
+        &&op_STORE_LOAD_SLOT,
+        &&op_FOR_PREP, &&op_FOR_LOOP,
+        &&op_PRINT, &&op_HALT
+    };
+    static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) ==
+                  static_cast<size_t>(OpCode::HALT) + 1,
+                  "dispatchTable must cover every opcode");
+#define VM_CASE(name) op_##name
+#define VM_DISPATCH() goto *dispatchTable[static_cast<int>(ip->opcode)]
+#define VM_NEXT() do { ++count; ++ip; VM_DISPATCH(); } while (0)
+#define VM_CONTINUE() do { ++count; VM_DISPATCH(); } while (0)
+    VM_DISPATCH();
+#else
+#define VM_CASE(name) case OpCode::name
+#define VM_NEXT() { ++count; ++ip; continue; }
+#define VM_CONTINUE() { ++count; continue; }
+    for (;;) {
+    switch (ip->opcode) {
+#endif
+
+    VM_CASE(LOAD_CONST):
+        VM_PUSH(ip->operand);
+        VM_NEXT();
+    
+    VM_CASE(LOAD_CONST_WIDE):
+        VM_PUSH(constants[ip->operand]);
+        VM_NEXT();
+    
+    VM_CASE(LOAD_VAR):
+    VM_CASE(LOAD_SLOT):
+        VM_PUSH(slots[ip->operand]);
+        VM_NEXT();
+    
+    VM_CASE(STORE_VAR):
+    VM_CASE(STORE_SLOT):
+        slots[ip->operand] = tos;
+        slotSet[ip->operand] = 1;
+        VM_POP();
+        VM_NEXT();
+    
+    VM_CASE(ADD): VM_CHECKED(addOverflows); VM_NEXT();
+    VM_CASE(SUB): VM_CHECKED(subOverflows); VM_NEXT();
+    VM_CASE(MUL): VM_CHECKED(mulOverflows); VM_NEXT();
+    
+    VM_CASE(DIV):
+        if (tos == 0) VM_FAIL("Runtime error: Division by zero");
+        VM_CHECKED(divOverflows);
+        VM_NEXT();
+    
+    VM_CASE(MOD):
+        if (tos == 0) VM_FAIL("Runtime error: Modulo by zero");
+        VM_BINARY(checkedRemainder(a, b));
+        VM_NEXT();
+    
+    VM_CASE(CMP_LT):  VM_BINARY((a < b) ? 1 : 0);  VM_NEXT();
+    VM_CASE(CMP_GT):  VM_BINARY((a > b) ? 1 : 0);  VM_NEXT();
+    VM_CASE(CMP_LTE): VM_BINARY((a <= b) ? 1 : 0); VM_NEXT();
+    VM_CASE(CMP_GTE): VM_BINARY((a >= b) ? 1 : 0); VM_NEXT();
+    VM_CASE(CMP_EQ):  VM_BINARY((a == b) ? 1 : 0); VM_NEXT();
+    VM_CASE(CMP_NEQ): VM_BINARY((a != b) ? 1 : 0); VM_NEXT();
+    
+    VM_CASE(AND): VM_BINARY((a && b) ? 1 : 0); VM_NEXT();
+    VM_CASE(OR):  VM_BINARY((a || b) ? 1 : 0); VM_NEXT();
+    
+    VM_CASE(NOT):
+        tos = (tos == 0) ? 1 : 0;
+        VM_NEXT();
+    
+    VM_CASE(JUMP):
+        VM_JUMP(ip->operand);
+        VM_CONTINUE();
+    
+    VM_CASE(JUMP_IF_FALSE): {
+        Value condition = tos;
+        VM_POP();
+        if (condition == 0) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    }
+    
+    VM_CASE(JUMP_IF_TRUE): {
+        Value condition = tos;
+        VM_POP();
+        if (condition != 0) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    }
+    
+    VM_CASE(POP):
+        VM_POP();
+        VM_NEXT();
+    
+    VM_CASE(DUP):
+        *sp++ = tos;
+        VM_NEXT();
+    
+    VM_CASE(INC_SLOT): {
+        Value result;
+        if (addOverflows(slots[ip->aux], ip->operand, result)) goto vm_overflow;
+        slots[ip->aux] = result;
+        VM_NEXT();
+    }
+    
+    VM_CASE(SLOT_ADD_CONST): VM_SLOT_CHECKED(addOverflows); VM_NEXT();
+    VM_CASE(SLOT_SUB_CONST): VM_SLOT_CHECKED(subOverflows); VM_NEXT();
+    VM_CASE(SLOT_MUL_CONST): VM_SLOT_CHECKED(mulOverflows); VM_NEXT();
+    VM_CASE(SLOT_DIV_CONST): VM_SLOT_CHECKED(divOverflows); VM_NEXT();
+    VM_CASE(SLOT_MOD_CONST): VM_PUSH(checkedRemainder(slots[ip->aux], ip->operand)); VM_NEXT();
+    
+    VM_CASE(JUMP_IF_NOT_LT):  VM_COMPARE_BRANCH(a < b);
+    VM_CASE(JUMP_IF_NOT_GT):  VM_COMPARE_BRANCH(a > b);
+    VM_CASE(JUMP_IF_NOT_LTE): VM_COMPARE_BRANCH(a <= b);
+    VM_CASE(JUMP_IF_NOT_GTE): VM_COMPARE_BRANCH(a >= b);
+    VM_CASE(JUMP_IF_NOT_EQ):  VM_COMPARE_BRANCH(a == b);
+    VM_CASE(JUMP_IF_NOT_NEQ): VM_COMPARE_BRANCH(a != b);
+    
+    VM_CASE(STORE_LOAD_SLOT):
+        slots[ip->aux] = tos;
+        slotSet[ip->aux] = 1;
+        tos = slots[ip->operand];
+        VM_NEXT();
+    
+    // The loop limit is the cached top of stack
+    VM_CASE(FOR_PREP):
+        if (slots[ip->aux] > tos) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    
+    VM_CASE(FOR_LOOP): {
+        Value counter;
+        if (addOverflows(slots[ip->aux], 1, counter)) goto vm_overflow;
+        slots[ip->aux] = counter;
+        if (counter <= tos) {
+            VM_JUMP(ip->operand);
+            VM_CONTINUE();
+        }
+        VM_NEXT();
+    }
+    
+    VM_CASE(PRINT): {
+        Value value = tos;
+        VM_POP();
+        instructionCount = count;   // Stays accurate if the sink throws
+        out->printInt(value);
+        VM_NEXT();
+    }
+    
+    VM_CASE(HALT):
+        goto vm_done;
+    
+#if !VM_COMPUTED_GOTO
+    default:
+        VM_FAIL("Unknown opcode");
+    }
+    }
+#endif
+
+vm_done:
+    VM_SYNC();
+    return;
+
+// One shared exit keeps the throw out of the arithmetic handlers
+vm_overflow:
+    VM_FAIL(OVERFLOW_ERROR);
+
+#undef VM_SYNC
+#undef VM_FAIL
+#undef VM_PUSH
+#undef VM_POP
+#undef VM_CHECK_BUDGET
+#undef VM_JUMP
+#undef VM_BINARY
+#undef VM_CHECKED
+#undef VM_SLOT_CHECKED
+#undef VM_COMPARE_BRANCH
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_CONTINUE
+#if VM_COMPUTED_GOTO
+#undef VM_DISPATCH
+#endif
 }
 
 void VirtualMachine::executeInstruction(const Instruction& instr) {
     switch (instr.opcode) {
         // Load/Store operations
         case OpCode::LOAD_CONST:
-            push(instr.intOperand);
+            push(instr.operand);
             break;
             
-        case OpCode::LOAD_VAR: {
-            if (variables.find(instr.strOperand) == variables.end()) {
-                throw std::runtime_error("Runtime error: Variable '" + instr.strOperand + "' not found");
+        case OpCode::LOAD_CONST_WIDE:
+            if (instr.operand < 0 || static_cast<size_t>(instr.operand) >= program->getConstants().size()) {
+                throw std::runtime_error("Constant index out of range");
             }
-            push(variables[instr.strOperand]);
+            push(program->getConstant(instr.operand));
+            break;
+            
+        // Name-based instructions index the same slot table (see BytecodeProgram::emit)
+        case OpCode::LOAD_VAR:
+        case OpCode::LOAD_SLOT:
+            push(loadSlot(instr.operand));
             break;
-        }
             
-        case OpCode::STORE_VAR: {
-            int value = pop();
-            variables[instr.strOperand] = value;
+        case OpCode::STORE_VAR:
+        case OpCode::STORE_SLOT: {
+            Value value = pop();
+            frame[instr.operand] = value;
+            assigned[instr.operand] = 1;
             break;
         }
         
         // Arithmetic operations
         case OpCode::ADD: {
-            int b = pop();
-            int a = pop();
-            push(a + b);
+            Value b = pop();
+            Value a = pop();
+            Value result;
+            if (addOverflows(a, b, result)) {
+                throw std::runtime_error(OVERFLOW_ERROR);
+            }
+            push(result);
             break;
         }
         
         case OpCode::SUB: {
-            int b = pop();
-            int a = pop();
-            push(a - b);
+            Value b = pop();
+            Value a = pop();
+            Value result;
+            if (subOverflows(a, b, result)) {
+                throw std::runtime_error(OVERFLOW_ERROR);
+            }
+            push(result);
             break;
         }
         
         case OpCode::MUL: {
-            int b = pop();
-            int a = pop();
-            push(a * b);
+            Value b = pop();
+            Value a = pop();
+            Value result;
+            if (mulOverflows(a, b, result)) {
+                throw std::runtime_error(OVERFLOW_ERROR);
+            }
+            push(result);
             break;
         }
         
         case OpCode::DIV: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             if (b == 0) {
                 throw std::runtime_error("Runtime error: Division by zero");
             }
-            push(a / b);
+            Value result;
+            if (divOverflows(a, b, result)) {
+                throw std::runtime_error(OVERFLOW_ERROR);
+            }
+            push(result);
             break;
         }
         
         case OpCode::MOD: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             if (b == 0) {
                 throw std::runtime_error("Runtime error: Modulo by zero");
             }
-            push(a % b);
+            push(checkedRemainder(a, b));
             break;
         }
         
         // Comparison operations
         case OpCode::CMP_LT: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a < b) ? 1 : 0);
             break;
         }
         
         case OpCode::CMP_GT: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a > b) ? 1 : 0);
             break;
         }
         
         case OpCode::CMP_LTE: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a <= b) ? 1 : 0);
             break;
         }
         
         case OpCode::CMP_GTE: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a >= b) ? 1 : 0);
             break;
         }
         
         case OpCode::CMP_EQ: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a == b) ? 1 : 0);
             break;
         }
         
         case OpCode::CMP_NEQ: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a != b) ? 1 : 0);
             break;
         }
         
         // Logical operations (NEW)
         case OpCode::AND: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a && b) ? 1 : 0);
             break;
         }
         
         case OpCode::OR: {
-            int b = pop();
-            int a = pop();
+            Value b = pop();
+            Value a = pop();
             push((a || b) ? 1 : 0);
             break;
         }
         
         case OpCode::NOT: {
-            int a = pop();
+            Value a = pop();
             push(!a ? 1 : 0);
             break;
         }
@@ -198,23 +1407,70 @@ void VirtualMachine::executeInstruction(const Instruction& instr) {
         }
         
         case OpCode::DUP: {
-            int value = peek();
+            Value value = peek();
             push(value);
             break;
         }
         
+        // Superinstructions
+        case OpCode::INC_SLOT:
+        case OpCode::SLOT_ADD_CONST:
+        case OpCode::SLOT_SUB_CONST:
+        case OpCode::SLOT_MUL_CONST:
+        case OpCode::SLOT_DIV_CONST: {
+            // Codegen only fuses divisors other than 0 and -1
+            Value a = loadSlot(instr.aux);
+            Value result;
+            bool overflowed;
+            switch (instr.opcode) {
+                case OpCode::SLOT_SUB_CONST: overflowed = subOverflows(a, instr.operand, result); break;
+                case OpCode::SLOT_MUL_CONST: overflowed = mulOverflows(a, instr.operand, result); break;
+                case OpCode::SLOT_DIV_CONST: overflowed = divOverflows(a, instr.operand, result); break;
+                default:                     overflowed = addOverflows(a, instr.operand, result); break;
+            }
+            if (overflowed) {
+                throw std::runtime_error(OVERFLOW_ERROR);
+            }
+            if (instr.opcode == OpCode::INC_SLOT) {
+                frame[instr.aux] = result;
+            } else {
+                push(result);
+            }
+            break;
+        }
+        
+        case OpCode::SLOT_MOD_CONST:
+            push(checkedRemainder(loadSlot(instr.aux), instr.operand));
+            break;
+        
+        case OpCode::STORE_LOAD_SLOT: {
+            Value value = pop();
+            frame[instr.aux] = value;
+            assigned[instr.aux] = 1;
+            push(loadSlot(instr.operand));
+            break;
+        }
+        
         // Jump instructions handled in main loop
         case OpCode::JUMP:
         case OpCode::JUMP_IF_FALSE:
         case OpCode::JUMP_IF_TRUE:
+        case OpCode::JUMP_IF_NOT_LT:
+        case OpCode::JUMP_IF_NOT_GT:
+        case OpCode::JUMP_IF_NOT_LTE:
+        case OpCode::JUMP_IF_NOT_GTE:
+        case OpCode::JUMP_IF_NOT_EQ:
+        case OpCode::JUMP_IF_NOT_NEQ:
+        case OpCode::FOR_PREP:
+        case OpCode::FOR_LOOP:
             // These are handled in execute() loop
             throw std::runtime_error("Jump instructions should be handled in main loop");
             break;
         
         // I/O operations
         case OpCode::PRINT: {
-            int value = pop();
-            std::cout << value << "\n";
+            Value value = pop();
+            getOutput().printInt(value);
             break;
         }
         
@@ -227,48 +1483,65 @@ void VirtualMachine::executeInstruction(const Instruction& instr) {
     }
 }
 
-void VirtualMachine::push(int value) {
+void VirtualMachine::push(Value value) {
+    if (stack.size() == stack.capacity()) ++allocations;
     stack.push_back(value);
 }
 
-int VirtualMachine::pop() {
+Value VirtualMachine::pop() {
     if (stack.empty()) {
         throw std::runtime_error("Stack underflow");
     }
-    int value = stack.back();
+    Value value = stack.back();
     stack.pop_back();
     return value;
 }
 
-int VirtualMachine::peek() const {
+Value VirtualMachine::loadSlot(int slot) const {
+    if (!assigned[slot]) {
+        throw std::runtime_error("Runtime error: Variable '" + (*slotNames)[slot] + "' not found");
+    }
+    return frame[slot];
+}
+
+Value VirtualMachine::peek() const {
     if (stack.empty()) {
         throw std::runtime_error("Stack is empty");
     }
     return stack.back();
 }
 
-void VirtualMachine::printTrace(int pc, const Instruction& instr) {
-    std::cout << "[" << pc << "] " << instr;
+void VirtualMachine::printTrace(std::ostream& out) {
+    std::vector<TraceRecord> records;
+    traceBuffer.drain(records);
     
-    // Show stack state
-    std::cout << " | Stack: [";
-    for (size_t i = 0; i < stack.size(); ++i) {
-        std::cout << stack[i];
-        if (i < stack.size() - 1) std::cout << ", ";
+    out << "\n=== VM Execution Trace ===\n";
+    if (traceBuffer.dropped() > 0) {
+        out << "(" << traceBuffer.dropped() << " earlier steps dropped)\n";
     }
-    std::cout << "]";
     
-    // Show variables if any
-    if (!variables.empty()) {
-        std::cout << " | Vars: {";
-        bool first = true;
-        for (const auto& pair : variables) {
-            if (!first) std::cout << ", ";
-            std::cout << pair.first << ":" << pair.second;
-            first = false;
+    for (const auto& record : records) {
+        const Instruction& instr = record.instr;
+        out << "[" << record.pc << "] " << instr;
+        if (isVariableOpcode(instr.opcode)) {
+            out << " (" << (*slotNames)[instr.operand] << ")";
+        } else if (instr.opcode == OpCode::STORE_LOAD_SLOT) {
+            out << " (" << (*slotNames)[instr.aux] << ", " << (*slotNames)[instr.operand] << ")";
+        } else if (isFusedSlotOpcode(instr.opcode)) {
+            out << " (" << (*slotNames)[instr.aux] << ")";
         }
-        std::cout << "}";
+        
+        // Show the top of the stack as it was before the instruction
+        out << " | Stack: [";
+        if (record.stackDepth > 2) out << "..., ";
+        if (record.stackDepth > 1) out << record.top[1] << ", ";
+        if (record.stackDepth > 0) out << record.top[0];
+        out << "]";
+        if (record.stackDepth > 2) out << " (depth " << record.stackDepth << ")";
+        
+        out << "\n";
     }
     
-    std::cout << "\n";
+    out << "=== Execution Complete ===\n";
+    out << "Instructions executed: " << instructionCount << "\n\n";
 }
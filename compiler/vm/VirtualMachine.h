@@ -2,39 +2,286 @@
 #define VIRTUAL_MACHINE_H
 
 #include "../bytecode/BytecodeProgram.h"
+#include "ExecutionObserver.h"
+#include "ExecutionBudget.h"
+#include "SamplingProfiler.h"
+#include "TieredExecution.h"
+#include "VMSnapshot.h"
+#include "OutputSink.h"
 #include <vector>
-#include <unordered_map>
 #include <string>
+#include <cstdint>
+#include <climits>
+#include <ostream>
+#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <functional>
+
+// Interpreter loop used by execute()
+enum class DispatchMode {
+    Classic,    // Fetch loop + executeInstruction() switch
+    Threaded,   // Single-function loop: computed goto on GCC/Clang, switch elsewhere
+    Cached      // Threaded loop keeping the top of stack in a local; verified programs
+                // without an observer (others run as Threaded)
+};
+
+// What runs the program
+enum class ExecutionEngine {
+    Interpreter,   // One of the dispatch loops above
+    Jit,           // Native x86-64 code for verified programs (see JitCompiler);
+                   // falls back to the interpreter when unavailable
+    Tiered         // Verified programs start on the threaded loop and hot loops are
+                   // recompiled, then entered at their header (see setTierUpThreshold)
+};
+
+// Why a VM is paused (see VirtualMachine::isPaused)
+enum class PauseReason {
+    None,
+    Breakpoint,   // Before a breakpoint; resume() steps over it
+    Restored,     // At a restored snapshot's pc
+    TimeSlice     // At a back edge after the time slice ran out
+};
+
+// Memory a VirtualMachine keeps between runs by default (see setRetainedMemoryLimit)
+const size_t DEFAULT_RETAINED_MEMORY = 1 << 20;
 
 class VirtualMachine {
 public:
     VirtualMachine() = default;
+    VirtualMachine(const VirtualMachine&) = delete;   // Owns an OutputSink
+    VirtualMachine& operator=(const VirtualMachine&) = delete;
     
-    // Execute a bytecode program
+    // Execute a bytecode program (verified programs take the unchecked fast path).
+    // Every call starts from a clean run state, so one VM can run any number of
+    // programs back to back; its buffers keep their capacity between runs.
+    // Values are 64-bit; arithmetic that overflows throws "Runtime error:
+    // Integer overflow" in every loop and engine (see Value.h).
     void execute(const BytecodeProgram& program);
     
+    // Continue a program paused at a breakpoint, restored from a snapshot or
+    // at the end of a time slice (the program must still be alive)
+    void resume();
+    
+    // Time slicing: with a slice set, every execute()/resume() call returns at
+    // the first loop back edge after `instructions` instructions (0 = run to
+    // the end), paused with PauseReason::TimeSlice; resume() continues. Sliced
+    // runs use the threaded or classic loop whatever the engine and dispatch
+    // mode. Budgets count from execute() across slices, as in an unsliced run.
+    void setTimeSlice(std::int64_t instructions) { timeSlice = instructions > 0 ? instructions : 0; }
+    std::int64_t getTimeSlice() const { return timeSlice; }
+    
+    // Checkpoints: with an interval set, runs capture a VMSnapshot at the first
+    // loop back edge after every `instructions` instructions (0 = never) and
+    // pass it to onCheckpoint. The snapshot object is reused between calls;
+    // copy or encode() it to keep it. Checkpointed runs use the threaded or
+    // classic loop whatever the engine and dispatch mode.
+    void setCheckpointInterval(std::int64_t instructions,
+                               std::function<void(const VMSnapshot&)> onCheckpoint);
+    
+    // Snapshot of a paused VM (breakpoint, restore or time slice)
+    VMSnapshot checkpoint() const;
+    
+    // Load a snapshot taken from `program` and pause before its pc; resume()
+    // continues the run there. Instruction and output budgets carry on from
+    // the snapshot's counts. Throws std::runtime_error if the snapshot does
+    // not fit the program.
+    void restore(const BytecodeProgram& program, const VMSnapshot& snapshot);
+    
     // Get execution statistics
-    int getInstructionCount() const { return instructionCount; }
+    std::int64_t getInstructionCount() const { return instructionCount; }
+    
+    // Reuse: reserve() sizes the run buffers for programs up to the given slot
+    // count and stack depth; reset() clears the run state and restores the
+    // default configuration (engine, loop, observer, output, budget,
+    // breakpoints), keeping capacity up to the retained-memory limit. The
+    // trace buffer keeps its capacity (see setTraceCapacity).
+    void reserve(int slots, int stackDepth);
+    void reset();
+    void setRetainedMemoryLimit(size_t bytes) { retainedMemoryLimit = bytes; }
+    size_t getRetainedMemory() const;
+    
+    // Buffers the last run had to allocate or grow (0 once reserved capacity
+    // covers the programs being run; a JIT compile counts as one)
+    std::uint64_t getAllocationCount() const { return allocations; }
+    
+    // Limits for later runs (unlimited by default); exceeding one throws BudgetExceededError
+    void setBudget(const ExecutionBudget& newBudget) { budget.setBudget(newBudget); }
+    const ExecutionBudget& getBudget() const { return budget.getBudget(); }
+    
+    // Select the interpreter loop
+    void setDispatchMode(DispatchMode mode) { dispatchMode = mode; }
+    DispatchMode getDispatchMode() const { return dispatchMode; }
+    
+    // Select the engine; getLastEngine() reports which one the last run used
+    void setEngine(ExecutionEngine newEngine) { engine = newEngine; }
+    ExecutionEngine getEngine() const { return engine; }
+    ExecutionEngine getLastEngine() const { return lastEngine; }
+    
+    // Tiered engine: a loop whose back edge has been taken `iterations` times
+    // is recompiled to native code (when allowed and supported) or fused
+    // superinstructions, unless fusion finds nothing to improve. A fused loop
+    // counts each superinstruction as one instruction, like a program
+    // generated with setSuperinstructions().
+    void setTierUpThreshold(std::uint32_t iterations) {
+        tierUpThreshold = std::clamp<std::uint32_t>(iterations, 1, UINT32_MAX - 1);
+    }
+    void setNativeTier(bool enabled) { nativeTier = enabled; }
+    
+    // Loops that got hot in the last tiered run, in that order, with what
+    // each was recompiled into
+    const std::vector<TierUp>& getTierUps() const { return tierUps; }
+    
+    // Where PRINT writes (not owned; nullptr = the VM's own buffered std::cout sink).
+    // Output is flushed when execute()/resume() return or throw.
+    void setOutput(OutputSink* sink) { output = sink; }
+    OutputSink& getOutput() { return output ? *output : defaultOutput; }
+    const OutputSink& getOutput() const { return output ? *output : static_cast<const OutputSink&>(defaultOutput); }
+    
+    // Select the observer the interpreter loop is specialized for
+    void setObserverMode(ObserverMode mode) { observerMode = mode; }
+    ObserverMode getObserverMode() const { return observerMode; }
     
-    // Enable/disable step-by-step trace
-    void setTraceMode(bool enabled) { traceMode = enabled; }
+    // Enable/disable step-by-step trace (shorthand for ObserverMode::Trace)
+    void setTraceMode(bool enabled) { observerMode = enabled ? ObserverMode::Trace : ObserverMode::None; }
+    
+    // Trace records of the last run; the buffer is cleared by execute()
+    void setTraceCapacity(size_t capacity) { traceBuffer.setCapacity(capacity); }
+    TraceBuffer& getTraceBuffer() { return traceBuffer; }
+    void drainTrace(std::vector<TraceRecord>& out) { traceBuffer.drain(out); }
+    
+    // Drain the trace buffer and print it as text
+    void printTrace(std::ostream& out);
+    
+    // Per-instruction counts and ticks of the last ObserverMode::Profile or
+    // TraceProfile run (empty after runs in other modes)
+    const ExecutionProfile& getProfile() const { return profile; }
+    std::uint64_t getOpcodeCount(OpCode opcode) const;
+    
+    // Per-instruction samples of the last ObserverMode::Sample run (empty after
+    // runs in other modes); getSampler().printHistogram()/writeCollapsedStacks()
+    // attribute them to source lines
+    void setSampleInterval(std::chrono::microseconds interval) { sampler.setInterval(interval); }
+    const SamplingProfiler& getSampler() const { return sampler; }
+    
+    // Breakpoints (ObserverMode::Breakpoint): execution pauses before the instruction
+    void addBreakpoint(int pc);
+    void removeBreakpoint(int pc);
+    void clearBreakpoints() { breakpoints.clear(); }
+    bool isPaused() const { return paused; }
+    PauseReason getPauseReason() const { return pauseReason; }
+    int getPausedPc() const { return pausedPc; }
+    
+    // Inspect variable slots after execution (names come from BytecodeProgram::getSlotName)
+    int getSlotCount() const { return static_cast<int>(frame.size()); }
+    bool isSlotAssigned(int slot) const { return assigned[slot] != 0; }
+    Value getSlotValue(int slot) const { return frame[slot]; }
     
 private:
-    std::vector<int> stack;                          // Value stack
-    std::unordered_map<std::string, int> variables;  // Variable storage
-    int instructionCount = 0;                        // Instructions executed
-    bool traceMode = false;                          // Show execution trace
+    std::vector<Value> stack;                        // Value stack
+    std::vector<Value> frame;                        // Variable storage, indexed by slot
+    std::vector<unsigned char> assigned;             // Whether each slot has been stored yet
+    const std::vector<std::string>* slotNames = nullptr;  // Slot names of the running program
+    const BytecodeProgram* program = nullptr;        // Program being executed
+    std::int64_t instructionCount = 0;               // Instructions executed
+    DispatchMode dispatchMode = DispatchMode::Threaded;
+    ObserverMode observerMode = ObserverMode::None;
+    ExecutionEngine engine = ExecutionEngine::Interpreter;
+    ExecutionEngine lastEngine = ExecutionEngine::Interpreter;
+    StreamSink defaultOutput{std::cout};
+    OutputSink* output = nullptr;
+    
+    BudgetMonitor budget;
+    
+    // Reuse bookkeeping
+    std::uint64_t allocations = 0;
+    int reservedSlots = 0;
+    int reservedStackDepth = 0;
+    size_t retainedMemoryLimit = DEFAULT_RETAINED_MEMORY;
+    
+    // Observer state
+    TraceBuffer traceBuffer;
+    ExecutionProfile profile;
+    SamplingProfiler sampler;
+    std::vector<unsigned char> breakpoints;          // Indexed by pc
+    bool paused = false;
+    int pausedPc = -1;
+    int resumePausedAt = -1;                         // Breakpoint a resumed run steps over
+    PauseReason pauseReason = PauseReason::None;
+    
+    // Time slice state
+    std::int64_t timeSlice = 0;
+    std::int64_t yieldAt = INT64_MAX;                // Instruction count the current slice ends at
+    
+    // Checkpoint state
+    std::int64_t checkpointInterval = 0;
+    std::function<void(const VMSnapshot&)> onCheckpoint;
+    std::int64_t snapshotAt = INT64_MAX;             // Instruction count of the next checkpoint
+    std::uint64_t programFingerprint = 0;            // Of the running program (when checkpointing)
+    std::uint64_t outputStartBytes = 0;              // Sink counts at execute(), shifted by restore()
+    std::uint64_t outputStartLines = 0;
+    VMSnapshot snapshot;                             // Reused for every checkpoint
+    
+    // Tiered engine state
+    std::uint32_t tierUpThreshold = DEFAULT_TIER_UP_THRESHOLD;
+    bool nativeTier = true;
+    std::vector<std::uint32_t> backEdgeCounts;       // Indexed by loop header pc
+    std::vector<int> loopAt;                         // Loop header pc -> compiledLoops index (-1 = none)
+    std::vector<std::unique_ptr<CompiledLoop>> compiledLoops;   // Null for loops left interpreted
+    std::vector<TierUp> tierUps;                     // Parallel to compiledLoops
+    const CompiledLoop* runningLoop = nullptr;       // Loop being run (error pcs are mapped back)
+    int exitPc = 0;                                  // Operand of the HALT the last loop stopped at
+    
+    // Clean run state for a program (execute() and restore())
+    void beginProgram(const BytecodeProgram& program);
+    
+    // Run from startPc with the loop specialized for the current observer mode
+    void run(int startPc);
+    void runObserved(int startPc);
+    
+    // Compile and run natively; false if the JIT cannot take this program
+    bool runJit();
+    void runNative(const JitCode& code);
+    
+    // Tiered engine: interpret until a loop gets hot, run its compiled form, repeat
+    void runTiered();
+    int runCompiledLoop(int header, int backEdge);   // Returns the pc to resume at
+    template <class Observer>
+    void runWith(int startPc, Observer& observer);
+    
+    // Interpreter loops
+    template <class Observer>
+    void runClassic(const std::vector<Instruction>& instructions, int startPc, Observer& observer);
+    template <bool Checked, class Observer>
+    void runThreaded(const std::vector<Instruction>& instructions, int startPc, int stackDepth,
+                     Observer& observer);
+    void runCached(const std::vector<Instruction>& instructions, int stackDepth);
+    
+    // Budget checks, checkpoints and slice ends at backward jumps (see BudgetMonitor)
+    std::int64_t nextCheckpoint() const { return std::min({budget.nextCheckpoint(), snapshotAt, yieldAt}); }
+    
+    // Checkpoints or time slices stop runs at back edges, which only the
+    // threaded and classic loops support
+    bool interruptible() const { return checkpointInterval > 0 || timeSlice > 0; }
+    BudgetKind checkBudget() { return budget.check(instructionCount, getOutput()); }
+    
+    // Capture the state just after a taken backward jump to pc
+    void saveCheckpoint(int pc, std::int64_t executed, const Value* values, int depth);
+    void fillSnapshot(VMSnapshot& out, int pc, std::int64_t executed, const Value* values, int depth) const;
+    [[noreturn]] void throwBudgetExceeded(BudgetKind kind, int pc) {
+        budget.fail(kind, instructionCount, runningLoop ? runningLoop->programPc(pc) : pc);
+    }
     
     // Execute single instruction
     void executeInstruction(const Instruction& instr);
     
     // Stack operations
-    void push(int value);
-    int pop();
-    int peek() const;
+    void push(Value value);
+    Value pop();
+    Value peek() const;
     
-    // Helper for trace output
-    void printTrace(int pc, const Instruction& instr);
+    // Read a variable slot, failing if it was never stored
+    Value loadSlot(int slot) const;
 };
 
 #endif
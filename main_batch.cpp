@@ -0,0 +1,116 @@
+#include "compiler/batch/BatchRunner.h"
+#include "compiler/util/JsonEscape.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Same per-program limits as the web backend
+const std::int64_t MAX_INSTRUCTIONS = 200000000;
+const std::uint64_t MAX_OUTPUT_BYTES = 1 << 20;
+const std::chrono::milliseconds MAX_WALL_TIME(2000);
+
+// One result as a single JSON line
+std::string resultToJSON(const BatchResult& result) {
+    std::ostringstream json;
+    json << "{\"index\":" << result.index;
+    json << ",\"file\":\"" << escapeJSON(result.name) << "\"";
+    json << ",\"success\":" << (result.success() ? "true" : "false");
+    json << ",\"stage\":\"" << result.stage << "\"";
+    if (!result.success()) {
+        json << ",\"error\":\"" << escapeJSON(result.error) << "\"";
+        json << ",\"line\":" << result.line;
+    }
+    json << ",\"output\":\"" << escapeJSON(result.output) << "\"";
+    json << ",\"instructionsExecuted\":" << result.instructions;
+    json << ",\"micros\":" << static_cast<long long>(result.seconds * 1e6);
+    json << ",\"worker\":" << result.worker;
+    json << "}\n";
+    return json.str();
+}
+
+// Every regular file in a directory, by name
+void addDirectory(const std::filesystem::path& dir, std::vector<BatchJob>& jobs) {
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.is_regular_file()) files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        jobs.push_back({file.string(), file.string(), ""});
+    }
+}
+
+// One source path per line; relative paths are relative to the manifest
+void addManifest(const std::filesystem::path& manifest, std::vector<BatchJob>& jobs) {
+    std::ifstream in(manifest);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open manifest: " + manifest.string());
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        std::filesystem::path file = manifest.parent_path() / line;
+        jobs.push_back({line, file.string(), ""});
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Compiles and runs many programs in parallel, one JSON line per program
+    // (in completion order; "index" is the position in the input list)
+    unsigned workers = 0;
+    std::vector<BatchJob> jobs;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--jobs=", 0) == 0) {
+                workers = static_cast<unsigned>(std::stoul(arg.substr(7)));
+            } else if (arg.rfind("--manifest=", 0) == 0) {
+                addManifest(arg.substr(11), jobs);
+            } else if (!arg.empty() && arg[0] != '-' && std::filesystem::is_directory(arg)) {
+                addDirectory(arg, jobs);
+            } else if (!arg.empty() && arg[0] != '-') {
+                jobs.push_back({arg, arg, ""});
+            } else {
+                throw std::invalid_argument(arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Usage: " << argv[0] << " [--jobs=N] [--manifest=FILE] [DIR|FILE]...\n";
+        return 1;
+    }
+
+    ExecutionBudget budget;
+    budget.maxInstructions = MAX_INSTRUCTIONS;
+    budget.maxOutputBytes = MAX_OUTPUT_BYTES;
+    budget.maxWallTime = MAX_WALL_TIME;
+
+    BatchRunner runner(workers);
+    runner.setBudget(budget);
+
+    // Lines are formatted on the workers; only the write is serialized
+    std::mutex outputLock;
+    size_t succeeded = 0;
+    auto start = std::chrono::steady_clock::now();
+    runner.run(jobs, [&](const BatchResult& result) {
+        std::string line = resultToJSON(result);
+        std::lock_guard<std::mutex> lock(outputLock);
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        if (result.success()) ++succeeded;
+    });
+    std::fflush(stdout);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cerr << jobs.size() << " programs (" << succeeded << " succeeded) on " << runner.getWorkerCount()
+              << " workers in " << std::fixed << std::setprecision(3) << seconds << " s, "
+              << runner.getStealCount() << " stolen\n";
+    return succeeded == jobs.size() ? 0 : 2;
+}
@@ -1,9 +1,13 @@
 #include "compiler/vm/VirtualMachine.h"
+#include "compiler/vm/RegisterVM.h"
+#include "compiler/verifier/BytecodeVerifier.h"
 #include "compiler/codegen/CodeGenerator.h"
+#include "compiler/codegen/RegisterCodeGenerator.h"
 #include "compiler/optimizer/Optimizer.h"
 #include "compiler/semantic/SemanticAnalyzer.h"
 #include "compiler/parser/Parser.h"
 #include "compiler/lexer/Lexer.h"
+#include "compiler/lexer/SourceBuffer.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -37,17 +41,25 @@ void waitForUser() {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filename);
+int main(int argc, char* argv[]) {
+    // --backend=register runs the register VM instead of the stack VM;
+    // --sample-profile=FILE samples the run instead of instrumenting every
+    // instruction and writes collapsed stacks (flame graph input) to FILE
+    bool useRegisters = false;
+    std::string sampleProfilePath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--backend=register") {
+            useRegisters = true;
+        } else if (arg.rfind("--sample-profile=", 0) == 0 && arg.size() > 17) {
+            sampleProfilePath = arg.substr(17);
+        } else if (arg != "--backend=stack") {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--backend=stack|--backend=register] [--sample-profile=FILE]\n";
+            return 1;
+        }
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
-}
-
-int main() {
+    
     std::cout << "╔═══════════════════════════════════════════════════════════╗\n";
     std::cout << "║                                                           ║\n";
     std::cout << "║        EDUCATIONAL COMPILER DEMONSTRATION                 ║\n";
@@ -71,16 +83,19 @@ int main() {
             break;
         }
         
-        std::string source;
+        SourceBuffer source;
         
         if (choice == 1) {
             printHeader("Direct Code Input");
             std::cout << "Enter your code (type 'END' on a new line when done):\n";
+            std::string typed;
             std::string line;
             while (std::getline(std::cin, line)) {
                 if (line == "END") break;
-                source += line + "\n";
+                typed += line;
+                typed += '\n';
             }
+            source = SourceBuffer(std::move(typed));
         }
         else if (choice == 2) {
             printHeader("Available Demo Files");
@@ -112,7 +127,7 @@ int main() {
             }
             
             try {
-                source = readFile(filename);
+                source = SourceBuffer::mapFile(filename);
                 std::cout << "\nLoading: " << filename << "\n";
             } catch (const std::exception& e) {
                 std::cout << "Error: " << e.what() << "\n";
@@ -126,7 +141,7 @@ int main() {
         
         // Show source code
         printSeparator();
-        std::cout << source;
+        std::cout << source.text();
         printSeparator();
         std::cout << "\nPress Enter to start compilation...";
         std::cin.get();
@@ -140,7 +155,7 @@ int main() {
             
             std::cout << "Source Code:\n";
             printSeparator();
-            std::cout << source;
+            std::cout << source.text();
             printSeparator();
             std::cout << "\n";
             
@@ -251,34 +266,97 @@ int main() {
             std::cout << "What happens here:\n";
             std::cout << "→ AST is traversed and converted to bytecode\n";
             std::cout << "→ Bytecode is intermediate representation for the VM\n";
-            std::cout << "→ Stack-based instructions are generated\n\n";
+            if (useRegisters) {
+                std::cout << "→ Three-address register instructions are generated\n\n";
+            } else {
+                std::cout << "→ Stack-based instructions are generated\n\n";
+            }
             
             CodeGenerator codegen;
             BytecodeProgram bytecode = codegen.generate(program);
+            RegisterProgram registerCode;
             
-            std::cout << "Generated Bytecode (Intermediate Code):\n";
-            bytecode.print();
+            if (useRegisters) {
+                RegisterCodeGenerator registerCodegen;
+                registerCode = registerCodegen.generate(program);
+                std::cout << "Generated Register Bytecode (Intermediate Code):\n";
+                registerCode.print();
+            } else {
+                std::cout << "Generated Bytecode (Intermediate Code):\n";
+                bytecode.print();
+            }
+            size_t codeSize = useRegisters ? registerCode.size() : bytecode.size();
+            
+            // Verify the bytecode before handing it to the VM
+            BytecodeVerifier verifier(bytecode);
+            verifier.verify();
+            
+            if (verifier.hasErrors()) {
+                std::cout << "\n❌ BYTECODE VERIFICATION FAILED!\n\n";
+                for (const auto& error : verifier.getErrors()) {
+                    std::cout << "  Error: " << error.what() << "\n";
+                }
+                std::cout << "\nCompilation failed. Please fix errors and try again.\n";
+                continue; // Back to menu
+            }
+            for (const auto& warning : verifier.getWarnings()) {
+                std::cout << "  Warning: " << warning.what() << "\n";
+            }
             
             std::cout << "\n✅ Code Generation Complete\n";
-            std::cout << "   " << bytecode.size() << " instructions generated\n";
+            std::cout << "   " << codeSize << " instructions generated\n";
+            if (useRegisters) {
+                std::cout << "   Registers: " << registerCode.getRegisterCount() << " ("
+                          << registerCode.getSlotCount() << " variables)\n";
+            } else if (bytecode.isVerified()) {
+                std::cout << "   Verified: max stack depth " << bytecode.getVerifiedStackDepth() << "\n";
+            }
             waitForUser();
             
             // === STAGE 6: EXECUTION ===
             printStage(6, "BYTECODE EXECUTION (Virtual Machine)");
             std::cout << "What happens here:\n";
             std::cout << "→ Bytecode is executed by the virtual machine\n";
-            std::cout << "→ Stack-based operations are performed\n";
+            if (useRegisters) {
+                std::cout << "→ Register operations are performed (one instruction per operation)\n";
+            } else {
+                std::cout << "→ Stack-based operations are performed\n";
+            }
             std::cout << "→ Results are produced\n\n";
             
             VirtualMachine vm;
+            vm.setObserverMode(sampleProfilePath.empty() ? ObserverMode::Profile : ObserverMode::Sample);
+            RegisterVM registerVm;
             
             std::cout << "Program Output:\n";
             printSeparator();
-            vm.execute(bytecode);
+            if (useRegisters) {
+                registerVm.execute(registerCode);
+            } else {
+                vm.execute(bytecode);
+            }
             printSeparator();
             
+            std::int64_t executed = useRegisters ? registerVm.getInstructionCount() : vm.getInstructionCount();
             std::cout << "\n✅ Execution Complete!\n";
-            std::cout << "   " << vm.getInstructionCount() << " instructions executed\n\n";
+            std::cout << "   " << executed << " instructions executed\n\n";
+            
+            if (!useRegisters && !sampleProfilePath.empty()) {
+                std::cout << "Sampling Profile:\n";
+                printSeparator();
+                vm.getSampler().printHistogram(std::cout, bytecode);
+                printSeparator();
+                std::ofstream folded(sampleProfilePath);
+                vm.getSampler().writeCollapsedStacks(folded, bytecode);
+                std::cout << (folded ? "Collapsed stacks written to " : "Could not write ")
+                          << sampleProfilePath << "\n\n";
+            } else if (!useRegisters) {
+                std::cout << "Execution Profile:\n";
+                printSeparator();
+                vm.getProfile().printReport(std::cout, bytecode);
+                printSeparator();
+                std::cout << "\n";
+            }
             
             // === SUMMARY ===
             printHeader("COMPILATION SUMMARY");
@@ -287,8 +365,8 @@ int main() {
             std::cout << "  ✓ Stage 2: Syntax Analysis    - AST built\n";
             std::cout << "  ✓ Stage 3: Semantic Analysis  - Validated\n";
             std::cout << "  ✓ Stage 4: Optimization        - " << optCount << " optimization(s)\n";
-            std::cout << "  ✓ Stage 5: Code Generation     - " << bytecode.size() << " instructions\n";
-            std::cout << "  ✓ Stage 6: Execution           - " << vm.getInstructionCount() << " instructions executed\n\n";
+            std::cout << "  ✓ Stage 5: Code Generation     - " << codeSize << " instructions\n";
+            std::cout << "  ✓ Stage 6: Execution           - " << executed << " instructions executed\n\n";
             printSeparator();
             
         } catch (const ParserError& e) {
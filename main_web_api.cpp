@@ -1,39 +1,24 @@
 #include "compiler/vm/VirtualMachine.h"
+#include "compiler/vm/RegisterVM.h"
+#include "compiler/verifier/BytecodeVerifier.h"
 #include "compiler/codegen/CodeGenerator.h"
+#include "compiler/codegen/RegisterCodeGenerator.h"
 #include "compiler/optimizer/Optimizer.h"
 #include "compiler/semantic/SemanticAnalyzer.h"
 #include "compiler/parser/Parser.h"
 #include "compiler/lexer/Lexer.h"
+#include "compiler/lexer/SourceBuffer.h"
+#include "compiler/util/JsonEscape.h"
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// Helper function to escape JSON strings
-std::string escapeJSON(const std::string& str) {
-    std::string escaped;
-    for (char c : str) {
-        switch (c) {
-            case '"': escaped += "\\\""; break;
-            case '\\': escaped += "\\\\"; break;
-            case '\b': escaped += "\\b"; break;
-            case '\f': escaped += "\\f"; break;
-            case '\n': escaped += "\\n"; break;
-            case '\r': escaped += "\\r"; break;
-            case '\t': escaped += "\\t"; break;
-            default:
-                if (c < 32) {
-                    // Control character - escape as unicode
-                    char buf[8];
-                    snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
-                    escaped += buf;
-                } else {
-                    escaped += c;
-                }
-        }
-    }
-    return escaped;
-}
+// Limits for one submission, so a runaway loop cannot tie up the process
+const std::int64_t MAX_INSTRUCTIONS = 200000000;
+const std::uint64_t MAX_OUTPUT_BYTES = 1 << 20;
+const std::chrono::milliseconds MAX_WALL_TIME(2000);
 
 // Convert tokens to JSON array
 std::string tokensToJSON(const std::vector<Token>& tokens) {
@@ -177,17 +162,60 @@ std::string bytecodeToJSON(const BytecodeProgram& bytecode) {
         if (i > 0) json << ",";
         json << "\n    {";
         json << "\"index\":" << i << ",";
+        json << "\"line\":" << bytecode.getLine(i) << ",";
         
         const Instruction& instr = instructions[i];
         json << "\"opcode\":\"" << opcodeToString(instr.opcode) << "\"";
         
         if (instr.opcode == OpCode::LOAD_CONST) {
-            json << ",\"operand\":" << instr.intOperand;
+            json << ",\"operand\":" << instr.operand;
+        }
+        else if (instr.opcode == OpCode::LOAD_CONST_WIDE) {
+            json << ",\"constant\":" << instr.operand;
+            json << ",\"operand\":" << bytecode.getConstant(instr.operand);
         }
-        else if (instr.opcode == OpCode::STORE_VAR || instr.opcode == OpCode::LOAD_VAR) {
-            json << ",\"variable\":\"" << escapeJSON(instr.strOperand) << "\"";
+        else if (isVariableOpcode(instr.opcode)) {
+            json << ",\"slot\":" << instr.operand;
+            json << ",\"variable\":\"" << escapeJSON(bytecode.getSlotName(instr.operand)) << "\"";
         }
+        else if (isForLoopOpcode(instr.opcode)) {
+            json << ",\"slot\":" << instr.aux;
+            json << ",\"variable\":\"" << escapeJSON(bytecode.getSlotName(instr.aux)) << "\"";
+            json << ",\"target\":" << instr.operand;
+        }
+        
+        json << "}";
+    }
+    
+    json << "\n  ]";
+    return json.str();
+}
+
+// Convert register bytecode to JSON (only the operand fields each opcode uses)
+std::string registerBytecodeToJSON(const RegisterProgram& code) {
+    std::ostringstream json;
+    json << "[";
+    
+    const auto& instructions = code.getInstructions();
+    for (size_t i = 0; i < instructions.size(); ++i) {
+        if (i > 0) json << ",";
+        json << "\n    {";
+        json << "\"index\":" << i << ",";
+        json << "\"line\":" << code.getLine(i) << ",";
+        
+        const RegInstruction& instr = instructions[i];
+        json << "\"opcode\":\"" << regOpcodeToString(instr.opcode) << "\"";
+        
+        unsigned used = regOperands(instr.opcode);
+        if (used & REG_A) json << ",\"a\":" << instr.a;
+        if (used & REG_B) json << ",\"b\":" << instr.b;
+        if (used & REG_C) json << ",\"c\":" << instr.c;
+        if (used & REG_IMM) json << ",\"imm\":" << instr.imm;
+        if (instr.opcode == RegOpCode::LOADK) json << ",\"value\":" << code.getConstant(instr.imm);
         
+        std::ostringstream text;
+        text << instr;
+        json << ",\"text\":\"" << escapeJSON(text.str()) << "\"";
         json << "}";
     }
     
@@ -195,12 +223,105 @@ std::string bytecodeToJSON(const BytecodeProgram& bytecode) {
     return json.str();
 }
 
-int main() {
-    // Read source code from stdin
-    std::string source;
-    std::string line;
-    while (std::getline(std::cin, line)) {
-        source += line + "\n";
+// Convert the slot-to-name table to JSON array (index = slot)
+std::string slotsToJSON(const BytecodeProgram& bytecode) {
+    std::ostringstream json;
+    json << "[";
+    
+    const auto& names = bytecode.getSlotNames();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i > 0) json << ",";
+        json << "\"" << escapeJSON(names[i]) << "\"";
+    }
+    
+    json << "]";
+    return json.str();
+}
+
+// Convert drained VM trace records to JSON array (stack top before each step)
+std::string traceToJSON(const std::vector<TraceRecord>& records) {
+    std::ostringstream json;
+    json << "[";
+    
+    for (size_t i = 0; i < records.size(); ++i) {
+        const TraceRecord& record = records[i];
+        if (i > 0) json << ",";
+        json << "\n    {";
+        json << "\"step\":" << record.step << ",";
+        json << "\"pc\":" << record.pc << ",";
+        json << "\"opcode\":\"" << opcodeToString(record.instr.opcode) << "\",";
+        json << "\"depth\":" << record.stackDepth << ",";
+        json << "\"top\":[";
+        for (int k = 0; k < record.stackDepth && k < 2; ++k) {
+            if (k > 0) json << ",";
+            json << record.top[k];
+        }
+        json << "]}";
+    }
+    
+    json << "\n  ]";
+    return json.str();
+}
+
+// Convert an execution profile to JSON (per line, opcode and instruction; hottest first)
+std::string profileToJSON(const ExecutionProfile& profile, const BytecodeProgram& bytecode) {
+    std::ostringstream json;
+    json << "{\n    \"unit\":\"" << ExecutionProfile::getTickUnit() << "\",";
+    json << "\"totalTicks\":" << profile.getTotalTicks() << ",";
+    
+    json << "\n    \"lines\":[";
+    auto lines = profile.byLine(bytecode);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0) json << ",";
+        json << "{\"line\":" << lines[i].line << ",\"count\":" << lines[i].count
+             << ",\"ticks\":" << lines[i].ticks << "}";
+    }
+    json << "],";
+    
+    json << "\n    \"opcodes\":[";
+    auto opcodes = profile.byOpcode(bytecode);
+    for (size_t i = 0; i < opcodes.size(); ++i) {
+        if (i > 0) json << ",";
+        json << "{\"opcode\":\"" << opcodeToString(opcodes[i].opcode) << "\",\"count\":" << opcodes[i].count
+             << ",\"ticks\":" << opcodes[i].ticks << "}";
+    }
+    json << "],";
+    
+    // Indexed like "bytecode"
+    json << "\n    \"instructions\":[";
+    for (size_t pc = 0; pc < profile.size(); ++pc) {
+        if (pc > 0) json << ",";
+        json << "{\"count\":" << profile.getCount(pc) << ",\"ticks\":" << profile.getTicks(pc) << "}";
+    }
+    json << "]\n  }";
+    return json.str();
+}
+
+int main(int argc, char* argv[]) {
+    // --backend=register executes on the register VM (no trace or profile);
+    // --file=PATH reads the program from PATH instead of stdin
+    bool useRegisters = false;
+    std::string sourcePath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--backend=register") {
+            useRegisters = true;
+        } else if (arg.rfind("--file=", 0) == 0 && arg.size() > 7) {
+            sourcePath = arg.substr(7);
+        } else if (arg != "--backend=stack") {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--backend=stack|--backend=register] [--file=PATH | < source]\n";
+            return 1;
+        }
+    }
+    
+    // Read source code, memory-mapped when it comes from a file
+    SourceBuffer source;
+    try {
+        source = sourcePath.empty() ? SourceBuffer::readStdin() : SourceBuffer::mapFile(sourcePath);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
     }
     
     // Start JSON output
@@ -251,27 +372,121 @@ int main() {
             CodeGenerator codegen;
             BytecodeProgram bytecode = codegen.generate(program);
             
-            // Stage 6: Execution
-            VirtualMachine vm;
+            // Bytecode verification (verified programs run on the unchecked VM path)
+            BytecodeVerifier verifier(bytecode);
+            verifier.verify();
             
-            // Capture output
-            std::ostringstream capturedOutput;
-            std::streambuf* oldCoutBuf = std::cout.rdbuf();
-            std::cout.rdbuf(capturedOutput.rdbuf());
+            if (verifier.hasErrors()) {
+                std::cout << "false,\n";
+                std::cout << "  \"stage\": \"verifier\",\n";
+                std::cout << "  \"errors\": [\n";
+                
+                const auto& errors = verifier.getErrors();
+                for (size_t i = 0; i < errors.size(); ++i) {
+                    if (i > 0) std::cout << ",\n";
+                    std::cout << "    {";
+                    std::cout << "\"message\":\"" << escapeJSON(errors[i].what()) << "\",";
+                    std::cout << "\"instruction\":" << errors[i].instruction;
+                    std::cout << "}";
+                }
+                std::cout << "\n  ],\n";
+                std::cout << "  \"bytecode\": " << bytecodeToJSON(bytecode) << "\n";
+                std::cout << "}\n";
+                return 0;
+            }
             
-            vm.execute(bytecode);
+            ExecutionBudget budget;
+            budget.maxInstructions = MAX_INSTRUCTIONS;
+            budget.maxOutputBytes = MAX_OUTPUT_BYTES;
+            budget.maxWallTime = MAX_WALL_TIME;
             
-            std::cout.rdbuf(oldCoutBuf);
+            // Report an exhausted budget as its own stage, with whatever was printed before it ran out
+            auto reportBudget = [&](const BudgetExceededError& e, const std::string& output, int line,
+                                    const std::string& bytecodeJSON) {
+                std::cout << "false,\n";
+                std::cout << "  \"stage\": \"budget\",\n";
+                std::cout << "  \"errors\": [{\n";
+                std::cout << "    \"message\":\"" << escapeJSON(e.what()) << "\",";
+                std::cout << "\"budget\":\"" << budgetKindToString(e.kind) << "\",";
+                std::cout << "\"instruction\":" << e.pc << ",";
+                std::cout << "\"line\":" << line;
+                std::cout << "\n  }],\n";
+                std::cout << "  \"output\": \"" << escapeJSON(output) << "\",\n";
+                std::cout << "  \"instructionsExecuted\": " << e.instructionsExecuted << ",\n";
+                std::cout << "  \"bytecode\": " << bytecodeJSON << "\n";
+                std::cout << "}\n";
+            };
+            
+            if (useRegisters) {
+                // Stage 5b/6 on the register backend
+                RegisterCodeGenerator registerCodegen;
+                RegisterProgram registerCode = registerCodegen.generate(program);
+                
+                RegisterVM registerVm;
+                registerVm.setBudget(budget);
+                BufferSink capturedOutput;
+                registerVm.setOutput(&capturedOutput);
+                try {
+                    registerVm.execute(registerCode);
+                } catch (const BudgetExceededError& e) {
+                    reportBudget(e, capturedOutput.str(), registerCode.getLine(e.pc),
+                                 registerBytecodeToJSON(registerCode));
+                    return 0;
+                }
+                
+                std::cout << "true,\n";
+                std::cout << "  \"backend\": \"register\",\n";
+                std::cout << "  \"tokens\": " << tokensToJSON(tokens) << ",\n";
+                std::cout << "  \"ast\": " << astToJSON(program) << ",\n";
+                std::cout << "  \"optimizations\": " << optimizationCount << ",\n";
+                std::cout << "  \"bytecode\": " << bytecodeToJSON(bytecode) << ",\n";
+                std::cout << "  \"registerBytecode\": " << registerBytecodeToJSON(registerCode) << ",\n";
+                std::cout << "  \"registers\": " << registerCode.getRegisterCount() << ",\n";
+                std::cout << "  \"slots\": " << slotsToJSON(bytecode) << ",\n";
+                std::cout << "  \"verified\": " << (bytecode.isVerified() ? "true" : "false") << ",\n";
+                std::cout << "  \"maxStackDepth\": " << verifier.getMaxStackDepth() << ",\n";
+                std::cout << "  \"output\": \"" << escapeJSON(capturedOutput.str()) << "\",\n";
+                std::cout << "  \"instructionsExecuted\": " << registerVm.getInstructionCount() << "\n";
+                std::cout << "}\n";
+                return 0;
+            }
+            
+            // Stage 6: Execution, traced into a bounded ring buffer for the debugger and
+            // profiled in the same budgeted run (the ticks include the cost of tracing)
+            VirtualMachine vm;
+            vm.setObserverMode(ObserverMode::TraceProfile);
+            vm.setTraceCapacity(4096);
+            vm.setBudget(budget);
+            
+            // Capture output in the VM's own sink
+            BufferSink capturedOutput;
+            vm.setOutput(&capturedOutput);
+            try {
+                vm.execute(bytecode);
+            } catch (const BudgetExceededError& e) {
+                reportBudget(e, capturedOutput.str(), bytecode.getLine(e.pc), bytecodeToJSON(bytecode));
+                return 0;
+            }
             std::string output = capturedOutput.str();
             
+            std::vector<TraceRecord> trace;
+            vm.drainTrace(trace);
+            
             // Output all stages
             std::cout << "true,\n";
+            std::cout << "  \"backend\": \"stack\",\n";
             std::cout << "  \"tokens\": " << tokensToJSON(tokens) << ",\n";
             std::cout << "  \"ast\": " << astToJSON(program) << ",\n";
             std::cout << "  \"optimizations\": " << optimizationCount << ",\n";
             std::cout << "  \"bytecode\": " << bytecodeToJSON(bytecode) << ",\n";
+            std::cout << "  \"slots\": " << slotsToJSON(bytecode) << ",\n";
+            std::cout << "  \"verified\": " << (bytecode.isVerified() ? "true" : "false") << ",\n";
+            std::cout << "  \"maxStackDepth\": " << verifier.getMaxStackDepth() << ",\n";
             std::cout << "  \"output\": \"" << escapeJSON(output) << "\",\n";
-            std::cout << "  \"instructionsExecuted\": " << vm.getInstructionCount() << "\n";
+            std::cout << "  \"instructionsExecuted\": " << vm.getInstructionCount() << ",\n";
+            std::cout << "  \"trace\": " << traceToJSON(trace) << ",\n";
+            std::cout << "  \"traceDropped\": " << vm.getTraceBuffer().dropped() << ",\n";
+            std::cout << "  \"profile\": " << profileToJSON(vm.getProfile(), bytecode) << "\n";
         }
     }
     catch (const ParserError& e) {
@@ -0,0 +1,139 @@
+#include "compiler/batch/BatchRunner.h"
+#include <iostream>
+#include <filesystem>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+// Run jobs on the pool and collect the results by input position
+std::vector<BatchResult> runAll(BatchRunner& runner, const std::vector<BatchJob>& jobs) {
+    std::vector<BatchResult> results(jobs.size());
+    std::vector<int> seen(jobs.size(), 0);
+    std::mutex lock;
+    runner.run(jobs, [&](const BatchResult& result) {
+        std::lock_guard<std::mutex> guard(lock);
+        results[result.index] = result;
+        ++seen[result.index];
+    });
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (seen[i] != 1) {
+            throw std::runtime_error("job " + std::to_string(i) + " reported " + std::to_string(seen[i]) + " times");
+        }
+    }
+    return results;
+}
+
+void testDemoCorpus() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Demo Corpus in Parallel\n";
+    std::cout << "========================================\n";
+
+    std::vector<BatchJob> jobs;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator("demos")) {
+        if (entry.path().extension() == ".txt") files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    // Several copies, so every worker gets some
+    for (int copy = 0; copy < 8; ++copy) {
+        for (const auto& file : files) jobs.push_back({file.filename().string(), file.string(), ""});
+    }
+
+    // The same jobs one by one on a single VM
+    VirtualMachine vm;
+    BufferSink sink;
+    std::vector<BatchResult> expected;
+    for (const BatchJob& job : jobs) expected.push_back(BatchRunner::runOne(job, vm, sink));
+
+    BatchRunner runner(4);
+    std::vector<BatchResult> results = runAll(runner, jobs);
+
+    bool same = true;
+    size_t succeeded = 0;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        same = same && results[i].stage == expected[i].stage && results[i].output == expected[i].output &&
+               results[i].error == expected[i].error && results[i].instructions == expected[i].instructions;
+        if (results[i].success()) ++succeeded;
+    }
+    std::cout << (same && succeeded > 0 ? "✅ " : "❌ ") << jobs.size() << " programs on "
+              << runner.getWorkerCount() << " workers match the sequential run (" << succeeded << " succeeded)\n";
+}
+
+void testFailureStages() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Failures Are Reported by Stage\n";
+    std::cout << "========================================\n";
+
+    std::vector<BatchJob> jobs = {
+        {"ok", "", "let x = 6;\nprint x * 7;"},
+        {"parser", "", "let = 5;"},
+        {"semantic", "", "print y;"},
+        {"runtime", "", "let zero = 0;\nprint 1 / zero;"},
+        {"budget", "", "for i = 1 to 1000000000 {\n    print i;\n}"},
+        {"io", "no/such/file.txt", ""},
+    };
+
+    BatchRunner runner(3);
+    ExecutionBudget budget;
+    budget.maxInstructions = 100000;
+    runner.setBudget(budget);
+    std::vector<BatchResult> results = runAll(runner, jobs);
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        bool ok = results[i].stage == jobs[i].name && results[i].name == jobs[i].name &&
+                  (results[i].success() ? results[i].output == "42\n" : !results[i].error.empty());
+        std::cout << (ok ? "✅ " : "❌ ") << jobs[i].name << ": stage " << results[i].stage;
+        if (!results[i].error.empty()) std::cout << " (" << results[i].error << ", line " << results[i].line << ")";
+        std::cout << "\n";
+    }
+}
+
+void testWorkStealing() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Idle Workers Steal Queued Jobs\n";
+    std::cout << "========================================\n";
+
+    // Every heavy job lands in the first worker's share
+    std::vector<BatchJob> jobs;
+    for (int i = 0; i < 8; ++i) {
+        jobs.push_back({"heavy", "", "for i = 1 to 300000 {\n    let y = i % 7;\n}\nprint 7;"});
+    }
+    for (int i = 0; i < 24; ++i) {
+        jobs.push_back({"light", "", "print " + std::to_string(i) + ";"});
+    }
+
+    BatchRunner runner(4);
+    std::vector<BatchResult> results = runAll(runner, jobs);
+
+    bool correct = true;
+    unsigned heavyWorkers = 0;
+    std::vector<int> ranHeavy(runner.getWorkerCount(), 0);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        std::string want = i < 8 ? "7\n" : std::to_string(i - 8) + "\n";
+        correct = correct && results[i].output == want;
+        if (i < 8 && ranHeavy[results[i].worker]++ == 0) ++heavyWorkers;
+    }
+    std::cout << (correct && runner.getStealCount() > 0 && heavyWorkers > 1 ? "✅ " : "❌ ")
+              << runner.getStealCount() << " jobs stolen, heavy jobs ran on " << heavyWorkers << " workers\n";
+}
+
+int main() {
+    std::cout << "╔════════════════════════════════════════════╗\n";
+    std::cout << "║  Educational Compiler - Batch Runner Tests ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n";
+
+    try {
+        testDemoCorpus();
+        testFailureStages();
+        testWorkStealing();
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "\n╔════════════════════════════════════════════╗\n";
+    std::cout << "║          All Tests Completed!              ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n";
+
+    return 0;
+}
@@ -7,10 +7,12 @@ void testBytecodeCreation() {
     std::cout << "========================================\n";
     
     // Test creating individual instructions
+    // (variable operands are indices into a program's name table)
+    BytecodeProgram names;
     Instruction i1(OpCode::LOAD_CONST, 42);
-    Instruction i2(OpCode::LOAD_VAR, "x");
+    Instruction i2(OpCode::LOAD_VAR, names.declareSlot("x"));
     Instruction i3(OpCode::ADD);
-    Instruction i4(OpCode::STORE_VAR, "result");
+    Instruction i4(OpCode::STORE_VAR, names.declareSlot("result"));
     Instruction i5(OpCode::HALT);
     
     std::cout << "✅ Created instructions:\n";
@@ -19,6 +21,7 @@ void testBytecodeCreation() {
     std::cout << "  " << i3 << "\n";
     std::cout << "  " << i4 << "\n";
     std::cout << "  " << i5 << "\n";
+    std::cout << "✅ Instruction size: " << sizeof(Instruction) << " bytes\n";
 }
 
 void testSimpleProgram() {
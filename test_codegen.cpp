@@ -12,12 +12,9 @@ void testCodeGeneration(const std::string& testName, const std::string& source,
     std::cout << "Source:\n" << source << "\n\n";
     
     try {
-        // Lex
+        // Lex and parse
         Lexer lexer(source);
-        auto tokens = lexer.getAllTokens();
-        
-        // Parse
-        Parser parser(tokens);
+        Parser parser(lexer);
         auto program = parser.parse();
         
         // Semantic analysis
@@ -139,7 +136,16 @@ int main() {
         "print 2 + 3 * 4;"
     );
     
-    // Test 12: Optimized constant folding comparison
+    // Test 12: Counted loop (bound evaluated once, FOR_PREP/FOR_LOOP)
+    testCodeGeneration(
+        "Counted For Loop",
+        "let n = 3;\n"
+        "for i = 1 to n * 2 {\n"
+        "    print i;\n"
+        "}"
+    );
+    
+    // Test 13: Optimized constant folding comparison
     std::cout << "════════════════════════════════════════\n";
     std::cout << "Optimization Impact Comparison\n";
     std::cout << "════════════════════════════════════════\n\n";
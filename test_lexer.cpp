@@ -1,5 +1,9 @@
 #include "compiler/lexer/Lexer.h"
+#include "compiler/lexer/SourceBuffer.h"
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 void testLexer(const std::string& testName, const std::string& source) {
@@ -15,6 +19,101 @@ void testLexer(const std::string& testName, const std::string& source) {
     }
 }
 
+// Run lengths around the 16- and 32-byte vector widths, with newlines at
+// every offset within a whitespace run and runs that reach the end of input
+std::string makeScannerCorpus() {
+    std::string source;
+    for (int length = 1; length <= 70; ++length) {
+        source += std::string(length, 'a' + length % 26) + "_" + std::to_string(length) + " ";
+        source += std::string(length, '0' + length % 10) + "\t";
+        std::string gap(length, ' ');
+        gap[length / 2] = '\n';
+        gap[length - 1] = length % 3 == 0 ? '\r' : '\n';
+        source += "Z9" + gap + "+" + std::string(length % 5, '\t') + "\xC3\xA9@;\n";
+    }
+    return source + std::string(40, ' ') + "\n\n  last_identifier_reaching_the_end_of_the_input";
+}
+
+// Each SIMD scanner must produce exactly the scalar scanner's tokens
+void testScanners() {
+    std::cout << "\n=== Test: Run Scanners Agree ===\n";
+    std::string source = makeScannerCorpus();
+    Lexer::Scanner original = Lexer::getScanner();
+    
+    Lexer::setScanner(Lexer::Scanner::SCALAR);
+    Lexer reference(source);
+    std::vector<Token> expected = reference.getAllTokens();
+    
+    for (Lexer::Scanner scanner : {Lexer::Scanner::SSE2, Lexer::Scanner::AVX2}) {
+        if (!Lexer::setScanner(scanner)) {
+            std::cout << "  " << Lexer::scannerName(scanner) << ": not supported here, skipped\n";
+            continue;
+        }
+        Lexer lexer(source);
+        std::vector<Token> tokens = lexer.getAllTokens();
+        bool same = tokens.size() == expected.size();
+        for (size_t i = 0; same && i < tokens.size(); ++i) {
+            same = tokens[i].type == expected[i].type && tokens[i].lexeme == expected[i].lexeme &&
+                   tokens[i].line == expected[i].line && tokens[i].column == expected[i].column;
+            if (!same) std::cout << "  first difference: " << tokens[i] << " vs " << expected[i] << "\n";
+        }
+        std::cout << (same ? "✅ " : "❌ ") << Lexer::scannerName(scanner) << ": " << tokens.size()
+                  << " tokens, last " << tokens[tokens.size() - 2] << "\n";
+    }
+    Lexer::setScanner(original);
+}
+
+bool sameTokens(const std::vector<Token>& a, const std::vector<Token>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].type != b[i].type || a[i].lexeme != b[i].lexeme ||
+            a[i].line != b[i].line || a[i].column != b[i].column) return false;
+    }
+    return true;
+}
+
+// A mapped file (or bulk-read stream) lexes in place to the same tokens
+void testSourceBuffer() {
+    std::cout << "\n=== Test: Source Buffers ===\n";
+    std::string program = makeScannerCorpus();
+    Lexer reference(program);
+    std::vector<Token> expected = reference.getAllTokens();
+    
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "test_lexer_source.txt";
+    std::ofstream(path, std::ios::binary) << program;
+    {
+        SourceBuffer mapped = SourceBuffer::mapFile(path.string());
+        Lexer lexer(mapped);
+        std::vector<Token> tokens = lexer.getAllTokens();
+        const char* begin = mapped.text().data();
+        bool inPlace = tokens.front().lexeme.data() == begin;
+        std::cout << (sameTokens(tokens, expected) && inPlace ? "✅" : "❌") << " file ("
+                  << (mapped.isMapped() ? "mapped" : "read") << "): " << tokens.size()
+                  << " tokens lexed in place\n";
+    }
+    std::ofstream(path, std::ios::binary).close();
+    {
+        SourceBuffer empty = SourceBuffer::mapFile(path.string());
+        Lexer lexer(empty);
+        bool onlyEof = lexer.nextToken().type == TokenType::END_OF_FILE;
+        std::cout << (empty.text().empty() && onlyEof ? "✅" : "❌") << " empty file: EOF only\n";
+    }
+    std::filesystem::remove(path);
+    
+    std::istringstream stream(program);
+    SourceBuffer streamed = SourceBuffer::readStream(stream);
+    Lexer lexer(streamed);
+    std::cout << (sameTokens(lexer.getAllTokens(), expected) ? "✅" : "❌") << " stream: "
+              << streamed.text().size() << " bytes in one buffer\n";
+    
+    try {
+        SourceBuffer::mapFile(path.string());
+        std::cout << "❌ missing file: no error\n";
+    } catch (const std::runtime_error&) {
+        std::cout << "✅ missing file: throws\n";
+    }
+}
+
 int main() {
     std::cout << "Educational Compiler - Lexer Test Suite\n";
     std::cout << "========================================\n";
@@ -52,6 +151,27 @@ int main() {
     // Test 10: All operators
     testLexer("All Operators", "a + b - c * d / e = f;");
     
+    // Test 11: Two-character operators and unpaired & / |
+    testLexer("Two-Character Operators", "if a >= 10 && b != 3 || !c <= d == e { print a % 2; } & |");
+    
+    // Test 12: Every keyword, plus identifiers that are close to one
+    testLexer("Keyword Table", "let print if else for to lets prin iff els fore t to_ LET Print _if for2");
+    
+    // Test 13: Lexemes are views into the lexer's source buffer
+    std::cout << "\n=== Test: Zero-Copy Lexemes ===\n";
+    Lexer lexer("let long_variable_name_here = 123456789;");
+    std::vector<Token> tokens = lexer.getAllTokens();
+    const char* first = tokens.front().lexeme.data();
+    bool contiguous = tokens[1].lexeme.data() == first + 4 && tokens[3].lexeme.data() == first + 30;
+    std::cout << (contiguous ? "✅" : "❌") << " '" << tokens[1].lexeme << "' and '" << tokens[3].lexeme
+              << "' point into the source\n";
+    
+    // Test 14: Vector scanners match the scalar scanner
+    testScanners();
+    
+    // Test 15: Mapped and bulk-read sources
+    testSourceBuffer();
+    
     std::cout << "\n========================================\n";
     std::cout << "All tests completed!\n";
     
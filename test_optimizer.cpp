@@ -21,8 +21,7 @@ void testOptimization(const std::string& testName, const std::string& source, bo
     try {
         // Parse
         Lexer lexer(source);
-        auto tokens = lexer.getAllTokens();
-        Parser parser(tokens);
+        Parser parser(lexer);
         auto program = parser.parse();
         
         // Print original AST
@@ -142,6 +141,19 @@ int main() {
         "let diff = 100 - 42;"
     );
     
+    // Test 13: 64-bit folding
+    testOptimization(
+        "Constant Folding: Past 32 Bits",
+        "let big = 4294967296 * 4;"
+    );
+    
+    // Test 14: Overflow is left for the VM to report at runtime
+    testOptimization(
+        "No Folding on Overflow",
+        "let big = 9223372036854775807 + 1;",
+        false
+    );
+    
     std::cout << "╔════════════════════════════════════════════╗\n";
     std::cout << "║          All Tests Completed!              ║\n";
     std::cout << "╚════════════════════════════════════════════╝\n";
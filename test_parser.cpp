@@ -1,6 +1,7 @@
 #include "compiler/parser/Parser.h"
 #include "compiler/lexer/Lexer.h"
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 void testParser(const std::string& testName, const std::string& source, bool shouldFail = false) {
@@ -10,12 +11,9 @@ void testParser(const std::string& testName, const std::string& source, bool sho
     std::cout << "Source:\n" << source << "\n\n";
     
     try {
-        // Tokenize
+        // Tokenize and parse
         Lexer lexer(source);
-        std::vector<Token> tokens = lexer.getAllTokens();
-        
-        // Parse
-        Parser parser(tokens);
+        Parser parser(lexer);
         auto statements = parser.parse();
         
         if (shouldFail) {
@@ -41,6 +39,42 @@ void testParser(const std::string& testName, const std::string& source, bool sho
     }
 }
 
+// Print an AST, or the parser error, to a string
+template <typename MakeParser>
+std::string parseToText(const std::string& source, MakeParser makeParser) {
+    std::ostringstream text;
+    std::streambuf* saved = std::cout.rdbuf(text.rdbuf());
+    try {
+        Lexer lexer(source);
+        Parser parser = makeParser(lexer);
+        for (const auto& stmt : parser.parse()) {
+            stmt->print(1);
+        }
+    } catch (const ParserError& e) {
+        text << "error: " << e.what();
+    }
+    std::cout.rdbuf(saved);
+    return text.str();
+}
+
+// The streaming parser must build the same AST (and report the same errors)
+// as parsing a complete token list
+void testStreamingMatchesTokenList(const std::string& testName, const std::string& source) {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: " << testName << "\n";
+    std::cout << "========================================\n";
+    
+    std::string streamed = parseToText(source, [](Lexer& lexer) { return Parser(lexer); });
+    std::string listed = parseToText(source, [](Lexer& lexer) { return Parser(lexer.getAllTokens()); });
+    
+    if (streamed == listed) {
+        std::cout << "✅ Streaming and token-list parses match\n";
+    } else {
+        std::cout << "❌ FAILED: Streaming parse differs\n";
+        std::cout << "Streaming:\n" << streamed << "\nToken list:\n" << listed << "\n";
+    }
+}
+
 int main() {
     std::cout << "╔════════════════════════════════════════╗\n";
     std::cout << "║  Educational Compiler - Parser Tests  ║\n";
@@ -175,6 +209,27 @@ int main() {
         true  // Should fail
     );
     
+    // === Streaming ===
+    
+    // Test 21: Nested blocks stream through the lookahead buffer
+    testStreamingMatchesTokenList(
+        "Streaming: Nested Blocks",
+        "let total = 0;\n"
+        "for i = 1 to 10 {\n"
+        "    if i % 2 == 0 && !(i > 8) {\n"
+        "        print i * (total + 1);\n"
+        "    } else {\n"
+        "        print i;\n"
+        "    }\n"
+        "}\n"
+    );
+    
+    // Test 22: Errors report the same position
+    testStreamingMatchesTokenList(
+        "Streaming: Error Position",
+        "let x = 1;\nif x >= 1 {\n    print (x + ;\n}\n"
+    );
+    
     std::cout << "\n╔════════════════════════════════════════╗\n";
     std::cout << "║          All Tests Completed!          ║\n";
     std::cout << "╚════════════════════════════════════════╝\n";
@@ -0,0 +1,262 @@
+#include "compiler/vm/RegisterVM.h"
+#include "compiler/vm/VirtualMachine.h"
+#include "compiler/codegen/RegisterCodeGenerator.h"
+#include "compiler/codegen/CodeGenerator.h"
+#include "compiler/semantic/SemanticAnalyzer.h"
+#include "compiler/parser/Parser.h"
+#include "compiler/lexer/Lexer.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <vector>
+
+std::vector<std::unique_ptr<Statement>> parseChecked(const std::string& source) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parse();
+
+    SemanticAnalyzer analyzer(program);
+    analyzer.analyze();
+    if (analyzer.hasErrors()) {
+        throw std::runtime_error(analyzer.getErrors()[0].what());
+    }
+    return program;
+}
+
+RegisterProgram compileRegisters(const std::string& source) {
+    auto program = parseChecked(source);
+    RegisterCodeGenerator codegen;
+    return codegen.generate(program);
+}
+
+bool containsInstruction(const RegisterProgram& code, const std::string& text) {
+    for (const auto& instr : code.getInstructions()) {
+        std::ostringstream out;
+        out << instr;
+        if (out.str() == text) return true;
+    }
+    return false;
+}
+
+// Run a program on both VMs; output and final variable values must agree
+bool compareWithStackVM(const std::string& name, const std::string& source) {
+    auto program = parseChecked(source);
+    CodeGenerator codegen;
+    BytecodeProgram bytecode = codegen.generate(program);
+    RegisterCodeGenerator registerCodegen;
+    RegisterProgram registers = registerCodegen.generate(program);
+
+    BufferSink stackOut, registerOut;
+    VirtualMachine vm;
+    vm.setOutput(&stackOut);
+    RegisterVM registerVm;
+    registerVm.setOutput(&registerOut);
+
+    std::string stackError, registerError;
+    try { vm.execute(bytecode); } catch (const std::exception& e) { stackError = e.what(); }
+    try { registerVm.execute(registers); } catch (const std::exception& e) { registerError = e.what(); }
+
+    bool same = stackOut.str() == registerOut.str() && stackError == registerError &&
+                bytecode.getSlotNames() == registers.getSlotNames();
+    for (int slot = 0; same && stackError.empty() && slot < vm.getSlotCount(); ++slot) {
+        if (vm.isSlotAssigned(slot) && vm.getSlotValue(slot) != registerVm.getSlotValue(slot)) {
+            same = false;
+        }
+    }
+
+    std::cout << (same ? "✅ " : "❌ ") << name << ": stack " << vm.getInstructionCount()
+              << " instr, register " << registerVm.getInstructionCount() << " instr";
+    if (!stackError.empty()) std::cout << " (" << stackError << ")";
+    std::cout << "\n";
+    if (!same) {
+        std::cout << "   stack output:    " << stackOut.str() << stackError << "\n";
+        std::cout << "   register output: " << registerOut.str() << registerError << "\n";
+    }
+    return same;
+}
+
+void testDifferential() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Register VM matches the Stack VM\n";
+    std::cout << "========================================\n";
+
+    compareWithStackVM("arithmetic", "let a = 10;\nlet b = 3;\nprint a + b;\nprint a - b;\nprint a * b;\n"
+                                     "print a / b;\nprint a % b;\nprint 7 - a;\nprint 2 * a + b * 4;");
+    compareWithStackVM("constants on either side", "let x = 9;\nprint 100 / x;\nprint x / 2;\nprint 5 + x;\n"
+                                                   "print x % 4;\nprint 3 * x;\nprint 20 - x;");
+    compareWithStackVM("comparisons and logic", "let a = 3;\nlet b = 5;\nprint a < b;\nprint a > b;\n"
+                                                "print a <= 3;\nprint b >= 6;\nprint a == 3;\nprint a != b;\n"
+                                                "print a < b && b < 10;\nprint a > b || b == 5;\nprint !(a == b);");
+    compareWithStackVM("if / else", "let x = 7;\nif (x > 5) {\n    print 1;\n} else {\n    print 0;\n}\n"
+                                    "if (x == 3 || x == 7) {\n    print 2;\n}\nif (!(x < 0)) {\n    print 3;\n}");
+    compareWithStackVM("nested loops", "let total = 0;\nfor i = 1 to 20 {\n    for j = i to 20 {\n"
+                                       "        let p = i * j;\n        if (p % 7 == 0) {\n            print p;\n"
+                                       "        }\n    }\n}");
+    compareWithStackVM("loop bound from a variable", "let n = 4;\nfor i = n - 2 to n * 2 {\n    print i * i;\n}");
+    compareWithStackVM("empty loop", "for i = 5 to 1 {\n    print i;\n}\nprint 0;");
+    compareWithStackVM("copy between variables", "let a = 4;\nlet b = a;\nlet c = b;\nprint c;");
+    compareWithStackVM("division by zero", "let z = 0;\nprint 1;\nprint 10 / z;");
+    compareWithStackVM("modulo by zero", "let z = 0;\nprint 10 % z;");
+    compareWithStackVM("literal division by zero", "print 2;\nprint 10 / 0;");
+    compareWithStackVM("64-bit values", "let big = 9223372036854775807;\nprint big;\nprint big / 4294967296;\n"
+                                        "let a = 3000000;\nlet b = a * 3000000000;\nprint b;\nprint b - 5000000000;\n"
+                                        "print b % 4000000000;\nprint 0 - big - 1;");
+    compareWithStackVM("addition overflow", "let x = 9223372036854775806;\nprint x + 1;\nprint x + 2;");
+    compareWithStackVM("multiplication overflow", "let x = 3037000500;\nfor i = 1 to 3 {\n    print x * i;\n}\n"
+                                                  "print x * x;");
+    compareWithStackVM("overflow in a loop", "for i = 1 to 5 {\n    let p = 2147483648 * 2147483648 * i;\n"
+                                             "    print p;\n}");
+    compareWithStackVM("min / -1", "let m = 0 - 9223372036854775807 - 1;\nlet d = 0 - 1;\nprint m % d;\nprint m / d;");
+
+    // Every demo program that gets through the front end
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator("demos")) {
+        if (entry.path().extension() == ".txt") files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        std::ifstream in(file);
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        try {
+            parseChecked(buffer.str());
+        } catch (const std::exception&) {
+            continue;
+        }
+        compareWithStackVM(file, buffer.str());
+    }
+}
+
+void testCodeShape() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Three-Address Code Shape\n";
+    std::cout << "========================================\n";
+
+    RegisterProgram code = compileRegisters("let x = 5;\nlet y = x + 1;\nlet z = x * y - 3;\n"
+                                            "for i = 1 to 10 {\n    if (i < z) {\n        print i;\n    }\n}");
+    code.print();
+
+    auto check = [&](const std::string& text, const std::string& what) {
+        std::cout << (containsInstruction(code, text) ? "✅ " : "❌ ") << what << ": " << text << "\n";
+    };
+    check("LOADI r0, 5", "constant straight into the variable");
+    check("ADDI r1, r0, 1", "x + 1 is one instruction");
+    check("MUL r4, r0, r1", "product lands in a temporary");
+    check("SUBI r2, r4, 3", "result written to the variable");
+    check("JUMP_IF_NOT_LTE r3, r4, 11", "loop test fused with its branch");
+    check("JUMP_IF_NOT_LT r3, r2, 9", "if comparison fused with its branch");
+    check("ADDI r3, r3, 1", "loop increment in place");
+
+    std::cout << (code.getSlotCount() == 4 && code.getRegisterCount() == 5 ? "✅ " : "❌ ")
+              << "4 variable registers + 1 temporary (" << code.getRegisterCount() << " registers)\n";
+}
+
+void testInvalidPrograms() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Invalid Register Programs Rejected\n";
+    std::cout << "========================================\n";
+
+    auto expectRejected = [](const std::string& name, const RegisterProgram& code) {
+        RegisterVM vm;
+        try {
+            vm.execute(code);
+            std::cout << "❌ " << name << ": accepted\n";
+        } catch (const std::runtime_error& e) {
+            std::cout << "✅ " << name << ": " << e.what() << "\n";
+        }
+    };
+
+    RegisterProgram noHalt;
+    noHalt.setRegisterCount(1);
+    noHalt.emit(RegInstruction(RegOpCode::LOADI, 0, 0, 0, 1));
+    expectRejected("missing HALT", noHalt);
+
+    RegisterProgram badRegister;
+    badRegister.setRegisterCount(2);
+    badRegister.emit(RegInstruction(RegOpCode::ADD, 0, 1, 2));
+    badRegister.emit(RegInstruction(RegOpCode::HALT, 0, 0, 0));
+    expectRejected("register out of range", badRegister);
+
+    RegisterProgram badJump;
+    badJump.setRegisterCount(1);
+    badJump.emit(RegInstruction(RegOpCode::JUMP, 0, 0, 0, 7));
+    badJump.emit(RegInstruction(RegOpCode::HALT, 0, 0, 0));
+    expectRejected("jump out of range", badJump);
+
+    RegisterProgram zeroDivisor;
+    zeroDivisor.setRegisterCount(1);
+    zeroDivisor.emit(RegInstruction(RegOpCode::DIVI, 0, 0, 0, 0));
+    zeroDivisor.emit(RegInstruction(RegOpCode::HALT, 0, 0, 0));
+    expectRejected("DIVI by zero", zeroDivisor);
+
+    RegisterProgram minusOneDivisor;
+    minusOneDivisor.setRegisterCount(1);
+    minusOneDivisor.emit(RegInstruction(RegOpCode::MODI, 0, 0, 0, -1));
+    minusOneDivisor.emit(RegInstruction(RegOpCode::HALT, 0, 0, 0));
+    expectRejected("MODI by -1", minusOneDivisor);
+
+    RegisterProgram badConstant;
+    badConstant.setRegisterCount(1);
+    badConstant.addConstant(VALUE_MAX);
+    badConstant.emit(RegInstruction(RegOpCode::LOADK, 0, 0, 0, 1));
+    badConstant.emit(RegInstruction(RegOpCode::HALT, 0, 0, 0));
+    expectRejected("constant out of range", badConstant);
+}
+
+void testBudget() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Budgets on the Register VM\n";
+    std::cout << "========================================\n";
+
+    RegisterProgram code = compileRegisters("for i = 1 to 1000000000 {\n    print i;\n}");
+
+    RegisterVM vm;
+    BufferSink output;
+    vm.setOutput(&output);
+    ExecutionBudget budget;
+    budget.maxInstructions = 10000;
+    vm.setBudget(budget);
+    try {
+        vm.execute(code);
+        std::cout << "❌ Instruction budget not enforced\n";
+    } catch (const BudgetExceededError& e) {
+        bool ok = e.kind == BudgetKind::Instructions && e.instructionsExecuted >= 10000 &&
+                  e.instructionsExecuted < 10010 && !output.str().empty();
+        std::cout << (ok ? "✅ " : "❌ ") << e.what() << " after " << e.instructionsExecuted
+                  << " instructions at pc " << e.pc << "\n";
+    }
+
+    budget = ExecutionBudget();
+    budget.maxOutputBytes = 1000;
+    vm.setBudget(budget);
+    try {
+        vm.execute(code);
+        std::cout << "❌ Output budget not enforced\n";
+    } catch (const BudgetExceededError& e) {
+        std::cout << (e.kind == BudgetKind::OutputBytes ? "✅ " : "❌ ") << e.what() << "\n";
+    }
+}
+
+int main() {
+    std::cout << "╔════════════════════════════════════════════╗\n";
+    std::cout << "║  Educational Compiler - Register VM Tests ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n";
+
+    try {
+        testDifferential();
+        testCodeShape();
+        testInvalidPrograms();
+        testBudget();
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "\n╔════════════════════════════════════════════╗\n";
+    std::cout << "║          All Tests Completed!              ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n";
+
+    return 0;
+}
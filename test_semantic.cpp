@@ -10,12 +10,9 @@ void testSemantic(const std::string& testName, const std::string& source, bool s
     std::cout << "Source:\n" << source << "\n\n";
     
     try {
-        // Tokenize
+        // Tokenize and parse
         Lexer lexer(source);
-        auto tokens = lexer.getAllTokens();
-        
-        // Parse
-        Parser parser(tokens);
+        Parser parser(lexer);
         auto program = parser.parse();
         
         // Semantic Analysis
@@ -49,6 +46,32 @@ void testSemantic(const std::string& testName, const std::string& source, bool s
     }
 }
 
+// Errors point at the identifier, even when it is not on the line of its 'let'
+void testErrorPosition() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Error Position of a Split Declaration\n";
+    std::cout << "========================================\n";
+    
+    try {
+        Lexer lexer("let\nx = 1;\nlet\n  x = 2;");
+        Parser parser(lexer);
+        auto program = parser.parse();
+        SemanticAnalyzer analyzer(program);
+        analyzer.analyze();
+        
+        const auto& errors = analyzer.getErrors();
+        bool placed = errors.size() == 1 && errors[0].line == 4 && errors[0].column == 3 &&
+                      std::string(errors[0].what()).find("line 2, column 1") != std::string::npos;
+        for (const auto& error : errors) {
+            std::cout << "  • " << error.what() << " at line " << error.line
+                      << ", column " << error.column << "\n";
+        }
+        std::cout << (placed ? "✅" : "❌") << " Redeclaration reported at the identifiers\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Unexpected Error: " << e.what() << "\n";
+    }
+}
+
 int main() {
     std::cout << "╔════════════════════════════════════════════╗\n";
     std::cout << "║  Educational Compiler - Semantic Tests    ║\n";
@@ -180,6 +203,9 @@ int main() {
         true  // Should fail (z undefined)
     );
     
+    // Test 16: Error positions when 'let' and its identifier are on different lines
+    testErrorPosition();
+    
     std::cout << "\n╔════════════════════════════════════════════╗\n";
     std::cout << "║          All Tests Completed!              ║\n";
     std::cout << "╚════════════════════════════════════════════╝\n";
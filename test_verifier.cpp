@@ -0,0 +1,229 @@
+#include "compiler/verifier/BytecodeVerifier.h"
+#include <iostream>
+
+// Verify a hand-built program and print what the verifier found
+void verifyAndReport(BytecodeProgram& program, bool expectErrors) {
+    program.print();
+
+    BytecodeVerifier verifier(program);
+    verifier.verify();
+
+    for (const auto& error : verifier.getErrors()) {
+        std::cout << "  Error: " << error.what() << "\n";
+    }
+    for (const auto& warning : verifier.getWarnings()) {
+        std::cout << "  Warning: " << warning.what() << "\n";
+    }
+
+    if (verifier.hasErrors() == expectErrors) {
+        std::cout << "✅ " << (expectErrors ? "Rejected as expected" : "Accepted as expected") << "\n";
+    } else {
+        std::cout << "❌ Unexpected verifier result\n";
+    }
+    std::cout << "Fast path: " << (program.isVerified() ? "yes" : "no");
+    if (program.isVerified()) {
+        std::cout << " (max stack depth " << program.getVerifiedStackDepth() << ")";
+    }
+    std::cout << "\n";
+}
+
+void testValidProgram() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Valid Program - let z = (1 + 2) * 3;\n";
+    std::cout << "========================================\n";
+
+    BytecodeProgram program;
+    program.emit(OpCode::LOAD_CONST, 1);
+    program.emit(OpCode::LOAD_CONST, 2);
+    program.emit(OpCode::ADD);
+    program.emit(OpCode::LOAD_CONST, 3);
+    program.emit(OpCode::MUL);
+    program.emit(OpCode::STORE_VAR, "z");
+    program.emit(OpCode::LOAD_VAR, "z");
+    program.emit(OpCode::PRINT);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, false);
+}
+
+void testStackUnderflow() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Stack Underflow\n";
+    std::cout << "========================================\n";
+
+    BytecodeProgram program;
+    program.emit(OpCode::LOAD_CONST, 1);
+    program.emit(OpCode::ADD);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, true);
+}
+
+void testJumpOutOfRange() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Jump Target Out of Range\n";
+    std::cout << "========================================\n";
+
+    BytecodeProgram program;
+    program.emit(OpCode::JUMP, 42);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, true);
+}
+
+void testDepthMismatchAtJoin() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Stack Depth Mismatch at Join\n";
+    std::cout << "========================================\n";
+
+    // One branch pushes an extra value before both paths meet at 4
+    BytecodeProgram program;
+    program.emit(OpCode::LOAD_CONST, 1);
+    program.emit(OpCode::JUMP_IF_FALSE, 4);
+    program.emit(OpCode::LOAD_CONST, 7);
+    program.emit(OpCode::JUMP, 4);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, true);
+}
+
+void testFallsOffEnd() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Control Falls Off the End\n";
+    std::cout << "========================================\n";
+
+    BytecodeProgram program;
+    program.emit(OpCode::LOAD_CONST, 5);
+    program.emit(OpCode::PRINT);
+
+    verifyAndReport(program, true);
+}
+
+void testMaybeUnassigned() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Variable Stored on Only One Path\n";
+    std::cout << "========================================\n";
+
+    // x is stored only when the condition holds, then loaded unconditionally
+    BytecodeProgram program;
+    program.emit(OpCode::LOAD_CONST, 0);
+    program.emit(OpCode::JUMP_IF_FALSE, 4);
+    program.emit(OpCode::LOAD_CONST, 10);
+    program.emit(OpCode::STORE_VAR, "x");
+    program.emit(OpCode::LOAD_VAR, "x");
+    program.emit(OpCode::PRINT);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, false);
+}
+
+void testLoopKeepsDepth() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Loop With Balanced Stack\n";
+    std::cout << "========================================\n";
+
+    // let i = 0; while (i < 3) { i = i + 1; }
+    BytecodeProgram program;
+    program.emit(OpCode::LOAD_CONST, 0);
+    program.emit(OpCode::STORE_VAR, "i");
+    program.emit(OpCode::LOAD_VAR, "i");
+    program.emit(OpCode::LOAD_CONST, 3);
+    program.emit(OpCode::CMP_LT);
+    program.emit(OpCode::JUMP_IF_FALSE, 11);
+    program.emit(OpCode::LOAD_VAR, "i");
+    program.emit(OpCode::LOAD_CONST, 1);
+    program.emit(OpCode::ADD);
+    program.emit(OpCode::STORE_VAR, "i");
+    program.emit(OpCode::JUMP, 2);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, false);
+}
+
+void testCountedLoop() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Counted Loop Keeps Its Limit\n";
+    std::cout << "========================================\n";
+
+    // for i = 1 to 3 { print i; }  (limit stays on the stack for the whole loop)
+    BytecodeProgram program;
+    int i = program.declareSlot("i");
+    program.emit(OpCode::LOAD_CONST, 1);
+    program.emit(OpCode::STORE_SLOT, i);
+    program.emit(OpCode::LOAD_CONST, 3);
+    program.addInstruction(Instruction(OpCode::FOR_PREP, static_cast<std::uint16_t>(i), 7));
+    program.emit(OpCode::LOAD_SLOT, i);
+    program.emit(OpCode::PRINT);
+    program.addInstruction(Instruction(OpCode::FOR_LOOP, static_cast<std::uint16_t>(i), 4));
+    program.emit(OpCode::POP);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, false);
+
+    // FOR_PREP without a limit underneath
+    BytecodeProgram missingLimit;
+    int j = missingLimit.declareSlot("j");
+    missingLimit.emit(OpCode::LOAD_CONST, 1);
+    missingLimit.emit(OpCode::STORE_SLOT, j);
+    missingLimit.addInstruction(Instruction(OpCode::FOR_PREP, static_cast<std::uint16_t>(j), 3));
+    missingLimit.emit(OpCode::HALT);
+
+    verifyAndReport(missingLimit, true);
+}
+
+void testWideConstants() {
+    std::cout << "\n========================================\n";
+    std::cout << "Test: Wide Constants and Constant Divisors\n";
+    std::cout << "========================================\n";
+
+    // print 9223372036854775807 / 2;  (the literal needs the constant pool)
+    BytecodeProgram program;
+    program.emitConstant(VALUE_MAX);
+    program.emitConstant(2);
+    program.emit(OpCode::DIV);
+    program.emit(OpCode::PRINT);
+    program.emit(OpCode::HALT);
+
+    verifyAndReport(program, false);
+
+    // LOAD_CONST_WIDE past the end of the pool
+    BytecodeProgram badIndex;
+    badIndex.emit(OpCode::LOAD_CONST_WIDE, 3);
+    badIndex.emit(OpCode::PRINT);
+    badIndex.emit(OpCode::HALT);
+
+    verifyAndReport(badIndex, true);
+
+    // x / -1 could overflow, so it never becomes SLOT_DIV_CONST
+    BytecodeProgram minusOne;
+    int x = minusOne.declareSlot("x");
+    minusOne.emit(OpCode::LOAD_CONST, 5);
+    minusOne.emit(OpCode::STORE_SLOT, x);
+    minusOne.addInstruction(Instruction(OpCode::SLOT_DIV_CONST, static_cast<std::uint16_t>(x), -1));
+    minusOne.emit(OpCode::PRINT);
+    minusOne.emit(OpCode::HALT);
+
+    verifyAndReport(minusOne, true);
+}
+
+int main() {
+    std::cout << "╔════════════════════════════════════════════╗\n";
+    std::cout << "║  Educational Compiler - Verifier Tests    ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n";
+
+    testValidProgram();
+    testStackUnderflow();
+    testJumpOutOfRange();
+    testDepthMismatchAtJoin();
+    testFallsOffEnd();
+    testMaybeUnassigned();
+    testLoopKeepsDepth();
+    testCountedLoop();
+    testWideConstants();
+
+    std::cout << "\n╔════════════════════════════════════════════╗\n";
+    std::cout << "║          All Tests Completed!              ║\n";
+    std::cout << "╚════════════════════════════════════════════╝\n";
+
+    return 0;
+}
@@ -1,13 +1,28 @@
 #include "compiler/vm/VirtualMachine.h"
+#include "compiler/vm/VMPool.h"
+#include "compiler/vm/VMScheduler.h"
+#include "compiler/jit/JitCompiler.h"
+#include "compiler/verifier/BytecodeVerifier.h"
 #include "compiler/codegen/CodeGenerator.h"
 #include "compiler/optimizer/Optimizer.h"
 #include "compiler/semantic/SemanticAnalyzer.h"
 #include "compiler/parser/Parser.h"
 #include "compiler/lexer/Lexer.h"
 #include <iostream>
+#include <sstream>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+
+// Engine and loop for the pipeline tests (test_vm --jit runs them natively,
+// test_vm --cached on the top-of-stack cached loop, test_vm --tiered with
+// loops promoted after two iterations)
+ExecutionEngine testEngine = ExecutionEngine::Interpreter;
+DispatchMode testDispatch = DispatchMode::Threaded;
 
 void testFullPipeline(const std::string& testName, const std::string& source, 
-                      bool optimize = false, bool trace = false) {
+                      bool optimize = false, bool trace = false,
+                      unsigned superinstructions = FUSE_NONE) {
     std::cout << "════════════════════════════════════════\n";
     std::cout << "Test: " << testName << "\n";
     std::cout << "════════════════════════════════════════\n";
@@ -16,9 +31,7 @@ void testFullPipeline(const std::string& testName, const std::string& source,
     try {
         // Full compilation pipeline
         Lexer lexer(source);
-        auto tokens = lexer.getAllTokens();
-        
-        Parser parser(tokens);
+        Parser parser(lexer);
         auto program = parser.parse();
         
         SemanticAnalyzer analyzer(program);
@@ -39,14 +52,26 @@ void testFullPipeline(const std::string& testName, const std::string& source,
         }
         
         CodeGenerator codegen;
+        codegen.setSuperinstructions(superinstructions);
         BytecodeProgram bytecode = codegen.generate(program);
         
         std::cout << "Generated Bytecode:\n";
         bytecode.print();
         std::cout << "\n";
         
+        // Verified programs run on the VM's unchecked fast path
+        BytecodeVerifier verifier(bytecode);
+        verifier.verify();
+        if (verifier.hasErrors()) {
+            std::cout << "❌ Verifier error: " << verifier.getErrors()[0].what() << "\n";
+            return;
+        }
+        
         // Execute
         VirtualMachine vm;
+        vm.setEngine(testEngine);
+        vm.setDispatchMode(testDispatch);
+        vm.setTierUpThreshold(2);   // Loops in these small programs get promoted under --tiered
         vm.setTraceMode(trace);
         
         std::cout << "Program Output:\n";
@@ -54,7 +79,9 @@ void testFullPipeline(const std::string& testName, const std::string& source,
         vm.execute(bytecode);
         std::cout << "──────────────────────────────────\n";
         
-        if (!trace) {
+        if (trace) {
+            vm.printTrace(std::cout);
+        } else {
             std::cout << "Instructions executed: " << vm.getInstructionCount() << "\n";
         }
         
@@ -67,7 +94,1339 @@ void testFullPipeline(const std::string& testName, const std::string& source,
     std::cout << "\n";
 }
 
-int main() {
+// Compile a source string to bytecode, with the given superinstructions and
+// optionally without FOR_LOOP. Semantic errors throw, so a test can only run
+// programs the real compiler accepts.
+BytecodeProgram compile(const std::string& source, unsigned fuse = FUSE_NONE, bool forLoops = true) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto program = parser.parse();
+    SemanticAnalyzer analyzer(program);
+    analyzer.analyze();
+    if (analyzer.hasErrors()) {
+        throw std::runtime_error(std::string("Test program rejected: ") + analyzer.getErrors()[0].what());
+    }
+    CodeGenerator codegen;
+    codegen.setSuperinstructions(fuse);
+    codegen.setForLoopOpcodes(forLoops);
+    return codegen.generate(program);
+}
+
+// compile(), then verify (verified programs run on the unchecked fast path)
+BytecodeProgram compileVerified(const std::string& source, unsigned fuse = FUSE_NONE, bool forLoops = true) {
+    BytecodeProgram bytecode = compile(source, fuse, forLoops);
+    BytecodeVerifier verifier(bytecode);
+    verifier.verify();
+    return bytecode;
+}
+
+void testObserverModes() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Observer Modes (trace / profile / breakpoint)\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    try {
+        BytecodeProgram bytecode = compileVerified(
+            "let base = 0;\n"
+            "for i = 1 to 3 {\n"
+            "    let total = base + i;\n"
+            "}\n"
+            "print total;");
+        
+        // Trace records are the same whichever loop produced them
+        VirtualMachine threaded;
+        VirtualMachine classic;
+        classic.setDispatchMode(DispatchMode::Classic);
+        std::vector<TraceRecord> threadedRecords, classicRecords;
+        for (VirtualMachine* vm : {&threaded, &classic}) {
+            vm->setTraceMode(true);
+            vm->execute(bytecode);
+        }
+        threaded.drainTrace(threadedRecords);
+        classic.drainTrace(classicRecords);
+        bool same = threadedRecords.size() == classicRecords.size();
+        for (size_t i = 0; same && i < threadedRecords.size(); ++i) {
+            same = threadedRecords[i].pc == classicRecords[i].pc &&
+                   threadedRecords[i].stackDepth == classicRecords[i].stackDepth &&
+                   threadedRecords[i].top[0] == classicRecords[i].top[0];
+        }
+        std::cout << (same ? "✅" : "❌") << " Threaded and classic traces match ("
+                  << threadedRecords.size() << " records)\n";
+        
+        // A small ring buffer keeps only the most recent steps
+        VirtualMachine ring;
+        ring.setTraceMode(true);
+        ring.setTraceCapacity(8);
+        ring.execute(bytecode);
+        std::cout << "✅ Ring buffer: kept " << ring.getTraceBuffer().size()
+                  << ", dropped " << ring.getTraceBuffer().dropped() << "\n";
+        
+        // Per-opcode counts add up to the instruction count (plus the final HALT)
+        VirtualMachine profiled;
+        profiled.setObserverMode(ObserverMode::Profile);
+        profiled.execute(bytecode);
+        std::uint64_t total = 0;
+        for (int op = 0; op <= static_cast<int>(OpCode::HALT); ++op) {
+            total += profiled.getOpcodeCount(static_cast<OpCode>(op));
+        }
+        std::cout << "✅ Profile: " << profiled.getOpcodeCount(OpCode::ADD) << " ADD, "
+                  << total << " dispatches for " << profiled.getInstructionCount() << " instructions\n";
+        
+        // Tracing and profiling in one run gives the same records and counts as separate runs
+        VirtualMachine both;
+        both.setObserverMode(ObserverMode::TraceProfile);
+        both.execute(bytecode);
+        std::vector<TraceRecord> bothRecords;
+        both.drainTrace(bothRecords);
+        bool combined = bothRecords.size() == threadedRecords.size() &&
+                        both.getOpcodeCount(OpCode::ADD) == profiled.getOpcodeCount(OpCode::ADD);
+        for (size_t pc = 0; combined && pc < bytecode.size(); ++pc) {
+            combined = both.getProfile().getCount(pc) == profiled.getProfile().getCount(pc);
+        }
+        std::cout << (combined ? "✅" : "❌") << " Trace + profile in one run matches separate runs\n";
+        
+        // Pause at the loop's store each iteration, then run to completion
+        int storePc = -1;
+        for (size_t i = 0; i < bytecode.size(); ++i) {
+            if (bytecode[i].opcode == OpCode::STORE_SLOT && bytecode.getSlotName(bytecode[i].operand) == "total" &&
+                storePc < 0 && i > 2) {
+                storePc = static_cast<int>(i);
+            }
+        }
+        VirtualMachine debug;
+        debug.setObserverMode(ObserverMode::Breakpoint);
+        debug.addBreakpoint(storePc);
+        std::cout << "Program Output:\n";
+        debug.execute(bytecode);
+        int stops = 0;
+        while (debug.isPaused()) {
+            ++stops;
+            std::cout << "  paused at [" << debug.getPausedPc() << "] after "
+                      << debug.getInstructionCount() << " instructions\n";
+            debug.resume();
+        }
+        std::cout << "✅ Breakpoint hit " << stops << " times, "
+                  << debug.getInstructionCount() << " instructions in total\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+// Sinks point into their own buffers; copying one (or a VM that owns one) must not compile
+static_assert(!std::is_copy_constructible_v<BufferSink> && !std::is_copy_assignable_v<StreamSink>,
+              "output sinks must not be copyable");
+static_assert(!std::is_copy_constructible_v<VirtualMachine>, "VirtualMachine must not be copyable");
+
+void testOutputSinks() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: PRINT Output Sinks\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    try {
+        BytecodeProgram bytecode = compileVerified(
+            "for i = 1 to 5 {\n"
+            "    print i * 1000000 - 3000000;\n"
+            "}");
+        
+        // Each VM writes to its own sink; std::cout is never touched
+        BufferSink buffer;
+        VirtualMachine vm;
+        vm.setOutput(&buffer);
+        vm.execute(bytecode);
+        std::cout << "Captured " << buffer.getLineCount() << " lines, " << buffer.size() << " bytes:\n"
+                  << buffer.view();
+        
+        // A reused buffer starts empty again after clear()
+        buffer.clear();
+        vm.execute(bytecode);
+        std::cout << (buffer.getLineCount() == 5 ? "✅" : "❌") << " Reused buffer holds one run\n";
+        
+        CountingSink counter;
+        vm.setOutput(&counter);
+        vm.execute(bytecode);
+        std::cout << (counter.getByteCount() == buffer.size() ? "✅" : "❌") << " Counting sink: "
+                  << counter.getLineCount() << " lines, " << counter.getByteCount() << " bytes\n";
+        
+        // Output printed before a runtime error is still delivered
+        BytecodeProgram failing = compileVerified(
+            "let zero = 0;\n"
+            "print 7;\n"
+            "print 7 / zero;");
+        std::ostringstream stream;
+        StreamSink streamSink(stream);
+        vm.setOutput(&streamSink);
+        try {
+            vm.execute(failing);
+            std::cout << "❌ Expected a runtime error\n";
+        } catch (const std::exception& e) {
+            std::cout << (stream.str() == "7\n" ? "✅" : "❌") << " Output before \""
+                      << e.what() << "\" was flushed\n";
+        }
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+// Run one program on both engines and compare everything observable
+void compareEngines(const std::string& label, const BytecodeProgram& bytecode) {
+    BufferSink interpretedOut, jitOut;
+    std::string interpretedError, jitError;
+    VirtualMachine interpreter, jit;
+    interpreter.setOutput(&interpretedOut);
+    jit.setOutput(&jitOut);
+    jit.setEngine(ExecutionEngine::Jit);
+    
+    try { interpreter.execute(bytecode); } catch (const std::exception& e) { interpretedError = e.what(); }
+    try { jit.execute(bytecode); } catch (const std::exception& e) { jitError = e.what(); }
+    
+    bool same = interpretedOut.view() == jitOut.view() && interpretedError == jitError &&
+                interpreter.getInstructionCount() == jit.getInstructionCount();
+    for (int slot = 0; same && slot < interpreter.getSlotCount(); ++slot) {
+        same = interpreter.isSlotAssigned(slot) == jit.isSlotAssigned(slot) &&
+               (!interpreter.isSlotAssigned(slot) || interpreter.getSlotValue(slot) == jit.getSlotValue(slot));
+    }
+    
+    std::cout << (same ? "✅ " : "❌ ") << label << ": "
+              << jit.getInstructionCount() << " instructions, "
+              << jitOut.getLineCount() << " lines"
+              << (jitError.empty() ? "" : ", error \"" + jitError + "\"")
+              << (jit.getLastEngine() == ExecutionEngine::Jit ? "" : " (interpreted)") << "\n";
+}
+
+void testJitEngine() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: JIT Matches the Interpreter\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    if (!JitCompiler::isSupported()) {
+        std::cout << "JIT not supported on this host; the VM falls back to the interpreter\n\n";
+        return;
+    }
+    
+    try {
+        compareEngines("arithmetic and comparisons", compileVerified(
+            "let a = 17;\n"
+            "let b = 5;\n"
+            "print a + b * 2 - a / b + a % b;\n"
+            "print a < b; print a > b; print a <= 17; print b >= 6; print a == 17; print a != b;\n"
+            "print a > b && b > 10 || !(a == b);"));
+        
+        compareEngines("deep expression (spilled stack)", compileVerified(
+            "print 1 + (2 + (3 + (4 + (5 + (6 + (7 + (8 * (9 - 10))))))));"));
+        
+        const char* loops =
+            "let base = 100;\n"
+            "for i = 1 to 30 {\n"
+            "    for j = 1 to 20 {\n"
+            "        let total = base + i * j % 7;\n"
+            "        if i % 10 == 0 && j == 20 {\n"
+            "            print total;\n"
+            "        }\n"
+            "    }\n"
+            "}";
+        compareEngines("nested loops", compileVerified(loops));
+        
+        compareEngines("nested loops (superinstructions)", compileVerified(loops, FUSE_ALL));
+        
+        compareEngines("division by zero", compileVerified(
+            "let zero = 0;\n"
+            "print 1;\n"
+            "for i = 1 to 3 {\n"
+            "    print i / zero;\n"
+            "}"));
+        compareEngines("modulo by zero", compileVerified(
+            "let zero = 0;\n"
+            "print 5 % zero;"));
+        
+        // PRINT with live values below it on the stack (not produced by codegen)
+        BytecodeProgram live;
+        for (int i = 1; i <= 8; ++i) live.emit(OpCode::LOAD_CONST, i);
+        live.emit(OpCode::DUP);
+        live.emit(OpCode::PRINT);
+        for (int i = 1; i < 8; ++i) live.emit(OpCode::ADD);
+        live.emit(OpCode::PRINT);
+        live.emit(OpCode::HALT);
+        BytecodeVerifier liveVerifier(live);
+        liveVerifier.verify();
+        compareEngines("print across a live stack", live);
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testProfiler() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Per-Instruction Profiler and Line Table\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    try {
+        const char* source =
+            "let base = 10;\n"
+            "for i = 1 to 4 {\n"
+            "    let total = base + i;\n"
+            "}\n"
+            "print total;";
+        
+        for (bool fused : {false, true}) {
+            BytecodeProgram bytecode = compile(source, fused ? FUSE_ALL : FUSE_NONE);
+            const char* label = fused ? " (superinstructions)" : "";
+            
+            // Every instruction but the final HALT belongs to a statement line
+            bool linesValid = bytecode.getLines().size() == bytecode.size() &&
+                              bytecode.getLine(bytecode.size() - 1) == 0;
+            for (size_t pc = 0; linesValid && pc + 1 < bytecode.size(); ++pc) {
+                linesValid = bytecode.getLine(pc) >= 1 && bytecode.getLine(pc) <= 5;
+            }
+            std::cout << (linesValid ? "✅" : "❌") << " Line table covers " << bytecode.size()
+                      << " instructions" << label << "\n";
+            
+            VirtualMachine vm;
+            CountingSink out;
+            vm.setOutput(&out);
+            vm.setObserverMode(ObserverMode::Profile);
+            vm.execute(bytecode);
+            const ExecutionProfile& profile = vm.getProfile();
+            
+            std::uint64_t total = 0;
+            for (size_t pc = 0; pc < profile.size(); ++pc) total += profile.getCount(pc);
+            std::uint64_t bodyRuns = 0;
+            for (const auto& line : profile.byLine(bytecode)) {
+                if (line.line == 3) bodyRuns = line.count;
+            }
+            bool ok = total == static_cast<std::uint64_t>(vm.getInstructionCount()) + 1 &&
+                      bodyRuns == 4 && profile.getTotalTicks() > 0;
+            std::cout << (ok ? "✅" : "❌") << " Profile" << label << ": " << total
+                      << " dispatches, loop body line ran " << bodyRuns << " times\n";
+        }
+        
+        // Profiling is off by default and leaves no data behind
+        BytecodeProgram bytecode = compileVerified(source);
+        VirtualMachine plain;
+        CountingSink out;
+        plain.setOutput(&out);
+        plain.execute(bytecode);
+        std::cout << (plain.getProfile().size() == 0 ? "✅" : "❌") << " No profile without ObserverMode::Profile\n";
+        
+        VirtualMachine profiled;
+        profiled.setOutput(&out);
+        profiled.setObserverMode(ObserverMode::Profile);
+        profiled.execute(bytecode);
+        std::ostringstream report;
+        profiled.getProfile().printReport(report, bytecode);
+        bool hasSections = report.str().find("Hottest lines") != std::string::npos &&
+                           report.str().find("Hottest opcodes") != std::string::npos &&
+                           report.str().find("Hottest instructions") != std::string::npos;
+        std::cout << (hasSections ? "✅" : "❌") << " Text report has line, opcode and instruction sections\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+// Run with a budget, returning the error (kind None if the run completed)
+BudgetExceededError runWithBudget(VirtualMachine& vm, const BytecodeProgram& bytecode,
+                                  const ExecutionBudget& budget) {
+    vm.setBudget(budget);
+    try {
+        vm.execute(bytecode);
+    } catch (const BudgetExceededError& e) {
+        return e;
+    }
+    return BudgetExceededError("", BudgetKind::None, vm.getInstructionCount(), -1);
+}
+
+void testBudgets() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Execution Budgets\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    try {
+        const char* endless =
+            "let scale = 2;\n"
+            "for i = 1 to 2000000000 {\n"
+            "    for j = 1 to 3 {\n"
+            "        let product = i * j * scale;\n"
+            "    }\n"
+            "}";
+        BytecodeProgram verified = compileVerified(endless);
+        BytecodeProgram unverified = compile(endless);
+        
+        // Fuel stops every engine at the same backward jump
+        ExecutionBudget fuel;
+        fuel.maxInstructions = 100000;
+        std::int64_t expected = -1;
+        bool same = true;
+        std::string message;
+        for (int engine = 0; engine < 5; ++engine) {
+            VirtualMachine vm;
+            if (engine == 0) vm.setDispatchMode(DispatchMode::Classic);
+            if (engine == 3) vm.setEngine(ExecutionEngine::Jit);
+            if (engine == 4) vm.setDispatchMode(DispatchMode::Cached);
+            BudgetExceededError result = runWithBudget(vm, engine == 1 ? unverified : verified, fuel);
+            same = same && result.kind == BudgetKind::Instructions &&
+                   (expected < 0 || result.instructionsExecuted == expected) &&
+                   result.instructionsExecuted == vm.getInstructionCount() &&
+                   (engine != 3 || !JitCompiler::isSupported() || vm.getLastEngine() == ExecutionEngine::Jit);
+            expected = result.instructionsExecuted;
+            message = result.what();
+        }
+        bool bounded = expected >= fuel.maxInstructions && expected < fuel.maxInstructions + 100;
+        std::cout << (same && bounded ? "✅" : "❌") << " Fuel: all engines stopped after "
+                  << expected << " instructions (\"" << message << "\")\n";
+        
+        // Output budget keeps the partial output
+        BytecodeProgram printer = compileVerified(
+            "for i = 1 to 2000000000 {\n"
+            "    print i;\n"
+            "}");
+        ExecutionBudget output;
+        output.maxOutputBytes = 10000;
+        for (ExecutionEngine engine : {ExecutionEngine::Interpreter, ExecutionEngine::Jit}) {
+            VirtualMachine vm;
+            BufferSink sink;
+            vm.setOutput(&sink);
+            vm.setEngine(engine);
+            BudgetExceededError result = runWithBudget(vm, printer, output);
+            bool ok = result.kind == BudgetKind::OutputBytes && sink.size() > output.maxOutputBytes &&
+                      sink.size() < output.maxOutputBytes + 16 * 4096 && sink.view().substr(0, 4) == "1\n2\n";
+            std::cout << (ok ? "✅" : "❌") << " Output budget"
+                      << (engine == ExecutionEngine::Jit ? " (JIT)" : "") << ": stopped with partial output\n";
+        }
+        
+        // Wall-clock budget
+        ExecutionBudget time;
+        time.maxWallTime = std::chrono::milliseconds(20);
+        for (ExecutionEngine engine : {ExecutionEngine::Interpreter, ExecutionEngine::Jit}) {
+            VirtualMachine vm;
+            vm.setEngine(engine);
+            auto start = std::chrono::steady_clock::now();
+            BudgetExceededError result = runWithBudget(vm, verified, time);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            bool ok = result.kind == BudgetKind::WallTime && elapsed < std::chrono::seconds(2);
+            std::cout << (ok ? "✅" : "❌") << " Time budget"
+                      << (engine == ExecutionEngine::Jit ? " (JIT)" : "") << ": stopped in time\n";
+        }
+        
+        // Programs within budget are unaffected
+        VirtualMachine vm;
+        BufferSink sink;
+        vm.setOutput(&sink);
+        ExecutionBudget generous;
+        generous.maxInstructions = 1000;
+        generous.maxOutputBytes = 100;
+        generous.maxWallTime = std::chrono::milliseconds(1000);
+        BudgetExceededError result = runWithBudget(vm, compileVerified(
+            "let x = 0;\n"
+            "for i = 1 to 10 {\n"
+            "    let sum = x + i * (i + 1) / 2;\n"
+            "}\n"
+            "print sum;"), generous);
+        std::cout << (result.kind == BudgetKind::None && sink.view() == "55\n" ? "✅" : "❌")
+                  << " Program within budget completes\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testTopOfStackCache() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Top-of-Stack Cached Loop\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    const char* programs[] = {
+        "let a = 5;\nlet b = 3;\nlet c = 2;\n"
+        "print a + b * c;\nprint (a + b) * c;\nprint a * b + c * 4;\nprint 10 + 20 * 2 - 5;",
+        
+        "let base = 0;\n"
+        "for i = 1 to 50 {\n"
+        "    let total = base + i * i % 7;\n"
+        "    if i % 10 == 0 && !(total < 0) {\n"
+        "        print total;\n"
+        "    }\n"
+        "}",
+        
+        "let x = 9;\nprint x / 2;\nprint x % 4;\nprint x > 3 || x == 0;\nprint x - 100;",
+        
+        "let z = 0;\nprint 7;\nprint 1 / z;",
+    };
+    
+    try {
+        int index = 0;
+        for (const char* source : programs) {
+            ++index;
+            for (unsigned fuse : {static_cast<unsigned>(FUSE_NONE), static_cast<unsigned>(FUSE_ALL)}) {
+                BytecodeProgram bytecode = compileVerified(source, fuse);
+                
+                VirtualMachine threaded, cached;
+                cached.setDispatchMode(DispatchMode::Cached);
+                BufferSink threadedOut, cachedOut;
+                threaded.setOutput(&threadedOut);
+                cached.setOutput(&cachedOut);
+                std::string threadedError, cachedError;
+                try { threaded.execute(bytecode); } catch (const std::exception& e) { threadedError = e.what(); }
+                try { cached.execute(bytecode); } catch (const std::exception& e) { cachedError = e.what(); }
+                
+                bool same = bytecode.isVerified() && threadedOut.str() == cachedOut.str() &&
+                            threadedError == cachedError &&
+                            threaded.getInstructionCount() == cached.getInstructionCount();
+                for (int slot = 0; same && slot < threaded.getSlotCount(); ++slot) {
+                    same = threaded.getSlotValue(slot) == cached.getSlotValue(slot);
+                }
+                std::cout << (same ? "✅" : "❌") << " Program " << index
+                          << (fuse == FUSE_ALL ? " (fused)" : "") << ": same output and "
+                          << cached.getInstructionCount() << " instructions"
+                          << (cachedError.empty() ? "" : " (" + cachedError + ")") << "\n";
+            }
+        }
+        
+        // Observers need the stack in memory, so they fall back to the threaded loop
+        BytecodeProgram small = compileVerified("let x = 3;\nprint x + 1;");
+        VirtualMachine reference, traced;
+        traced.setDispatchMode(DispatchMode::Cached);
+        BufferSink referenceOut, sink;
+        reference.setOutput(&referenceOut);
+        traced.setOutput(&sink);
+        for (VirtualMachine* vm : {&reference, &traced}) {
+            vm->setTraceMode(true);
+            vm->execute(small);
+        }
+        bool ok = traced.getTraceBuffer().size() == reference.getTraceBuffer().size() && sink.view() == "4\n";
+        std::cout << (ok ? "✅" : "❌") << " Trace mode records every step ("
+                  << traced.getTraceBuffer().size() << " records)\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testVmReuse() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Reusable VMs and the VM Pool\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    try {
+        BytecodeProgram loop = compileVerified(
+            "let base = 0;\n"
+            "for i = 1 to 20 {\n"
+            "    let total = base + i * (i + 1) / 2;\n"
+            "}\n"
+            "print total;");
+        BytecodeProgram small = compileVerified("let x = 6;\nprint x * 7;");
+        
+        // One VM, many programs: same results as fresh VMs, no allocations once warm
+        VirtualMachine reused;
+        BufferSink reusedOut;
+        reused.setOutput(&reusedOut);
+        bool same = true;
+        std::uint64_t lastAllocations = 0;
+        for (int run = 0; run < 6; ++run) {
+            const BytecodeProgram& program = run % 2 == 0 ? loop : small;
+            reusedOut.clear();
+            reused.execute(program);
+            lastAllocations += run >= 2 ? reused.getAllocationCount() : 0;
+            
+            VirtualMachine fresh;
+            BufferSink freshOut;
+            fresh.setOutput(&freshOut);
+            fresh.execute(program);
+            same = same && freshOut.view() == reusedOut.view() &&
+                   fresh.getInstructionCount() == reused.getInstructionCount();
+        }
+        std::cout << (same ? "✅" : "❌") << " Reused VM matches fresh VMs over 6 runs\n";
+        std::cout << (lastAllocations == 0 ? "✅" : "❌") << " Steady state: "
+                  << lastAllocations << " allocations in runs 3-6\n";
+        
+        // Reserved VMs do not allocate even on their first run
+        VirtualMachine reserved;
+        reserved.reserve(8, 8);
+        reserved.setOutput(&reusedOut);
+        reserved.execute(loop);
+        std::cout << (reserved.getAllocationCount() == 0 ? "✅" : "❌") << " Reserved VM: "
+                  << reserved.getAllocationCount() << " allocations on first run\n";
+        
+        // reset() restores the default configuration
+        reused.setObserverMode(ObserverMode::Profile);
+        reused.setDispatchMode(DispatchMode::Classic);
+        ExecutionBudget budget;
+        budget.maxInstructions = 5;
+        reused.setBudget(budget);
+        reused.addBreakpoint(3);
+        reused.reset();
+        bool defaults = reused.getObserverMode() == ObserverMode::None &&
+                        reused.getDispatchMode() == DispatchMode::Threaded &&
+                        reused.getBudget().isUnlimited() && &reused.getOutput() != &reusedOut &&
+                        reused.getInstructionCount() == 0 && !reused.isPaused();
+        std::cout << (defaults ? "✅" : "❌") << " reset() restores the default configuration\n";
+        
+        // Memory retained across reset() is bounded
+        std::string wide;
+        for (int i = 0; i < 4000; ++i) wide += "let v" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+        BytecodeProgram big = compileVerified(wide);
+        VirtualMachine bounded;
+        bounded.reserve(16, 16);
+        bounded.setRetainedMemoryLimit(4096);
+        bounded.execute(big);
+        size_t grown = bounded.getRetainedMemory();
+        bounded.reset();
+        std::cout << (grown > 4096 && bounded.getRetainedMemory() <= 4096 ? "✅" : "❌")
+                  << " Retained memory bounded: " << grown << " bytes after a 4000-variable program, "
+                  << bounded.getRetainedMemory() << " after reset()\n";
+        
+        // Pool: check out, run, return
+        VMPool pool(2);
+        {
+            VMPool::Lease first = pool.acquire();
+            VMPool::Lease second = pool.acquire();
+            VMPool::Lease third = pool.tryAcquire();
+            BufferSink out;
+            first->setOutput(&out);
+            first->execute(small);
+            std::cout << (!third && pool.available() == 0 && out.view() == "42\n" ? "✅" : "❌")
+                      << " Pool of 2: both checked out, third request refused\n";
+        }
+        VMPool::Lease again = pool.acquire();
+        bool clean = pool.available() == 1 && again->getInstructionCount() == 0 &&
+                     again->getObserverMode() == ObserverMode::None;
+        std::cout << (clean ? "✅" : "❌") << " Returned VMs are reset (" << pool.getCheckoutCount()
+                  << " checkouts)\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testCountedLoops() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: FOR_PREP / FOR_LOOP Counted Loops\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    // A loop whose bound can change while it runs (the bound reads the counter, or the
+    // body re-declares one of its variables) keeps the re-evaluating shape
+    struct Case { const char* name; const char* source; int countedLoops; };
+    const Case cases[] = {
+        {"constant bound", "for i = 1 to 5 {\n    print i * i;\n}", 1},
+        {"variable bound", "let n = 4;\nfor i = n - 2 to n * 2 {\n    print i;\n}\nprint i;", 1},
+        {"empty loop", "for i = 5 to 1 {\n    print i;\n}\nprint i;", 1},
+        {"single iteration", "for i = 3 to 3 {\n    print i;\n}\nprint i;", 1},
+        {"nested loops", "for i = 1 to 6 {\n    for j = i to 6 {\n        if (i * j) % 4 == 0 {\n"
+                         "            print i * j;\n        }\n    }\n}", 2},
+        {"body moves the counter", "for i = 1 to 20 {\n    print i;\n    for i = i * 2 to 0 {\n        print 0;\n    }\n}\n"
+                                   "print i;", 2},
+        {"bound divides by zero", "let z = 0;\nprint 1;\nfor i = 1 to 10 / z {\n    print i;\n}", 1},
+        {"bound reads the counter", "let i = 2;\nfor i = 1 to 12 - i {\n    print i;\n}", 0},
+        {"body moves the bound", "let n = 3;\nfor i = 1 to n {\n    print i;\n    if i < 5 {\n"
+                                 "        for n = n + 1 to 0 {\n            print 0;\n        }\n    }\n}", 1},
+        {"inner loop variable is the bound", "let j = 2;\nfor i = 1 to j {\n    for j = 1 to 3 {\n"
+                                             "        print i * 10 + j;\n    }\n}", 1},
+    };
+    
+    auto countForLoops = [](const BytecodeProgram& bytecode) {
+        int loops = 0;
+        for (const auto& instr : bytecode.getInstructions()) {
+            if (instr.opcode == OpCode::FOR_LOOP) ++loops;
+        }
+        return loops;
+    };
+    
+    try {
+        for (const Case& test : cases) {
+            BytecodeProgram reference = compileVerified(test.source, FUSE_NONE, false);
+            VirtualMachine referenceVm;
+            BufferSink referenceOut;
+            referenceVm.setOutput(&referenceOut);
+            std::string referenceError;
+            try { referenceVm.execute(reference); } catch (const std::exception& e) { referenceError = e.what(); }
+            
+            // Every engine runs the counted loop, plain and fused, with the reference behaviour
+            bool same = true;
+            std::int64_t instructions = 0;
+            for (unsigned fuse : {static_cast<unsigned>(FUSE_NONE), static_cast<unsigned>(FUSE_ALL)}) {
+                BytecodeProgram bytecode = compileVerified(test.source, fuse);
+                same = same && bytecode.isVerified() && countForLoops(bytecode) == test.countedLoops;
+                for (int engine = 0; engine < 4; ++engine) {
+                    VirtualMachine vm;
+                    vm.setDispatchMode(engine == 0 ? DispatchMode::Classic :
+                                       engine == 2 ? DispatchMode::Cached : DispatchMode::Threaded);
+                    vm.setEngine(engine == 3 ? ExecutionEngine::Jit : ExecutionEngine::Interpreter);
+                    BufferSink out;
+                    vm.setOutput(&out);
+                    std::string error;
+                    try { vm.execute(bytecode); } catch (const std::exception& e) { error = e.what(); }
+                    same = same && out.str() == referenceOut.str() && error == referenceError;
+                    for (int slot = 0; same && slot < vm.getSlotCount(); ++slot) {
+                        same = vm.isSlotAssigned(slot) == referenceVm.isSlotAssigned(slot) &&
+                               (!vm.isSlotAssigned(slot) || vm.getSlotValue(slot) == referenceVm.getSlotValue(slot));
+                    }
+                    if (fuse == FUSE_NONE && engine == 1) instructions = vm.getInstructionCount();
+                }
+            }
+            std::cout << (same ? "✅ " : "❌ ") << test.name << ": "
+                      << test.countedLoops << " counted loop(s), "
+                      << referenceVm.getInstructionCount() << " -> " << instructions << " instructions"
+                      << (referenceError.empty() ? "" : " (" + referenceError + ")") << "\n";
+        }
+        
+        // Loop overhead is one dispatch per pass: 4 to set up, 2 body + FOR_LOOP per pass, POP
+        BytecodeProgram loop = compileVerified("for i = 1 to 1000 {\n    let x = i;\n}");
+        VirtualMachine vm;
+        vm.execute(loop);
+        std::cout << (vm.getInstructionCount() == 4 + 3 * 1000 + 1 ? "✅" : "❌")
+                  << " 1000 iterations in " << vm.getInstructionCount() << " instructions\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testSamplingProfiler() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Sampling Profiler\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    // Long enough (tens of ms) for the profiling timer to fire several times;
+    // sample counts vary between runs, so only their shape is checked
+    const char* source =
+        "let m = 3;\n"
+        "for i = 1 to 3000 {\n"
+        "    for j = 1 to 3000 {\n"
+        "        let r = i * j * m;\n"
+        "    }\n"
+        "}\n"
+        "print r;";
+    
+    try {
+        BytecodeProgram bytecode = compileVerified(source);
+        VirtualMachine plain;
+        BufferSink plainOut;
+        plain.setOutput(&plainOut);
+        plain.execute(bytecode);
+        std::cout << (plain.getSampler().size() == 0 ? "✅" : "❌") << " No samples without ObserverMode::Sample\n";
+        
+        VirtualMachine vm;
+        BufferSink out;
+        vm.setOutput(&out);
+        vm.setObserverMode(ObserverMode::Sample);
+        vm.setSampleInterval(std::chrono::microseconds(500));
+        vm.execute(bytecode);
+        const SamplingProfiler& sampler = vm.getSampler();
+        bool same = out.str() == plainOut.str() && vm.getInstructionCount() == plain.getInstructionCount();
+        std::cout << (same && !sampler.isRunning() ? "✅" : "❌") << " Sampled run matches the plain run, "
+                  << "timer stopped\n";
+        
+        // Nearly all the time goes to the inner loop body (line 4) and its FOR_LOOP (line 3)
+        std::uint64_t total = sampler.getTotalSamples();
+        std::uint64_t inLoop = 0;
+        for (const auto& line : sampler.byLine(bytecode)) {
+            if (line.line == 3 || line.line == 4) inLoop += line.samples;
+        }
+        std::cout << (total > 0 && inLoop * 10 >= total * 8 ? "✅" : "❌")
+                  << " Samples land in the inner loop\n";
+        
+        std::ostringstream histogram;
+        sampler.printHistogram(histogram, bytecode);
+        bool hasLines = histogram.str().find("Samples by line") != std::string::npos &&
+                        histogram.str().find("\n  4 ") != std::string::npos;
+        std::cout << (hasLines ? "✅" : "❌") << " Per-line histogram\n";
+        
+        // Folded stacks: "program;frame;...;frame count", counts adding up to the samples
+        std::ostringstream folded;
+        sampler.writeCollapsedStacks(folded, bytecode);
+        std::istringstream lines(folded.str());
+        std::string line;
+        std::uint64_t foldedTotal = 0;
+        bool wellFormed = true;
+        bool nested = false;
+        while (std::getline(lines, line)) {
+            size_t space = line.rfind(' ');
+            std::string stack = line.substr(0, space);
+            std::string count = space == std::string::npos ? "" : line.substr(space + 1);
+            wellFormed = wellFormed && stack.rfind("program;", 0) == 0 && stack.find(";;") == std::string::npos &&
+                         stack.back() != ';' && !count.empty() &&
+                         count.find_first_not_of("0123456789") == std::string::npos;
+            if (wellFormed) foldedTotal += std::stoull(count);
+            nested = nested || stack.find("program;loop (line 2);loop (line 3);line 4;") == 0;
+        }
+        std::cout << (wellFormed && nested && foldedTotal == total ? "✅" : "❌")
+                  << " Collapsed stacks for flame graphs\n";
+        
+        // One sampler per thread at a time
+        SamplingProfiler first, second;
+        SamplingProfiler::Session session(first, nullptr);
+        bool threw = false;
+        try { second.start(nullptr); } catch (const std::runtime_error&) { threw = true; }
+        std::cout << (threw || !SamplingProfiler::usesProfilingSignal() ? "✅" : "❌")
+                  << " Second sampler on the same thread is rejected\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testTieredExecution() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Tiered Execution\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    const char* cases[] = {
+        "for i = 1 to 50 {\n    print i * i;\n}",
+        "let total = 0;\nfor i = 1 to 30 {\n    for j = i to 30 {\n        if (i * j) % 4 == 0 {\n"
+        "            for total = total + i * j to 0 {\n            }\n        }\n    }\n}\nprint total;",
+        "let z = 0;\nfor i = 1 to 20 {\n    print i;\n    if i == 15 {\n        print 10 / z;\n    }\n}",
+        "for i = 1 to 20 {\n    print i;\n    for i = i * 2 to 0 {\n    }\n}\nprint i;",
+        "let n = 3;\nfor i = 1 to n {\n    print i;\n    if i < 50 {\n        for n = n + 1 to 0 {\n        }\n    }\n}",
+    };
+    
+    try {
+        // Both tiers, promoted early or late, behave like the interpreter
+        int index = 0;
+        for (const char* source : cases) {
+            BytecodeProgram bytecode = compileVerified(source);
+            VirtualMachine reference;
+            BufferSink referenceOut;
+            reference.setOutput(&referenceOut);
+            std::string referenceError;
+            try { reference.execute(bytecode); } catch (const std::exception& e) { referenceError = e.what(); }
+            
+            bool same = true;
+            size_t tierUps = 0;
+            for (bool native : {false, true}) {
+                for (std::uint32_t threshold : {1u, 3u}) {
+                    VirtualMachine vm;
+                    BufferSink out;
+                    vm.setOutput(&out);
+                    vm.setEngine(ExecutionEngine::Tiered);
+                    vm.setNativeTier(native);
+                    vm.setTierUpThreshold(threshold);
+                    std::string error;
+                    try { vm.execute(bytecode); } catch (const std::exception& e) { error = e.what(); }
+                    same = same && out.str() == referenceOut.str() && error == referenceError &&
+                           vm.getLastEngine() == ExecutionEngine::Tiered && !vm.getTierUps().empty();
+                    for (int slot = 0; same && slot < vm.getSlotCount(); ++slot) {
+                        same = vm.isSlotAssigned(slot) == reference.isSlotAssigned(slot) &&
+                               (!vm.isSlotAssigned(slot) || vm.getSlotValue(slot) == reference.getSlotValue(slot));
+                    }
+                    // Native code counts exactly what the interpreter would have run
+                    if (vm.getTierUps()[0].tier == LoopTier::Native) {
+                        same = same && vm.getInstructionCount() == reference.getInstructionCount();
+                    }
+                    tierUps = vm.getTierUps().size();
+                }
+            }
+            std::cout << (same ? "✅" : "❌") << " Program " << ++index << ": same behaviour on both tiers, "
+                      << tierUps << " loop(s) promoted\n";
+        }
+        
+        // Tier-up decisions: the inner loop gets hot first and is entered once
+        // per outer pass; the outer loop follows
+        BytecodeProgram nested = compileVerified("let m = 3;\nfor i = 1 to 40 {\n    for j = 1 to 40 {\n"
+                                         "        let r = i * j * m;\n    }\n}");
+        VirtualMachine vm;
+        vm.setEngine(ExecutionEngine::Tiered);
+        vm.setTierUpThreshold(20);
+        vm.execute(nested);
+        const auto& tierUps = vm.getTierUps();
+        bool decisions = tierUps.size() == 2 && tierUps[0].line == 3 && tierUps[1].line == 2 &&
+                         tierUps[0].entries == 20 && tierUps[1].entries == 1 &&
+                         tierUps[0].promotedAt < tierUps[1].promotedAt &&
+                         tierUps[0].header > tierUps[1].header && tierUps[0].backEdge < tierUps[1].backEdge;
+        std::cout << (decisions ? "✅" : "❌") << " Inner loop promoted, then the outer one:\n";
+        for (const TierUp& tierUp : tierUps) {
+            std::cout << "    line " << tierUp.line << ": [" << tierUp.header << ", " << tierUp.backEdge << "], "
+                      << "entered " << tierUp.entries << " time(s)\n";
+        }
+        
+        // The fused tier runs fewer, larger instructions
+        BytecodeProgram counter = compileVerified("let t = 0;\nfor i = 1 to 500 {\n    for t = t + 1 to 0 {\n    }\n}\nprint t;");
+        VirtualMachine plain;
+        BufferSink plainOut;
+        plain.setOutput(&plainOut);
+        plain.execute(counter);
+        VirtualMachine fused;
+        BufferSink fusedOut;
+        fused.setOutput(&fusedOut);
+        fused.setEngine(ExecutionEngine::Tiered);
+        fused.setNativeTier(false);
+        fused.setTierUpThreshold(10);
+        fused.execute(counter);
+        bool fewer = fusedOut.str() == plainOut.str() && fused.getTierUps().size() == 1 &&
+                     fused.getTierUps()[0].tier == LoopTier::Fused &&
+                     fused.getInstructionCount() < plain.getInstructionCount();
+        std::cout << (fewer ? "✅" : "❌") << " Fused tier: " << plain.getInstructionCount() << " -> "
+                  << fused.getInstructionCount() << " instructions\n";
+
+        // A loop fusion cannot improve is recorded but keeps running interpreted
+        VirtualMachine unfusable;
+        unfusable.setEngine(ExecutionEngine::Tiered);
+        unfusable.setNativeTier(false);
+        unfusable.setTierUpThreshold(20);
+        unfusable.execute(nested);
+        bool kept = unfusable.getTierUps().size() == 2 && unfusable.getInstructionCount() == vm.getInstructionCount();
+        for (const TierUp& tierUp : unfusable.getTierUps()) {
+            kept = kept && tierUp.tier == LoopTier::Interpreter && tierUp.entries == 0 && tierUp.codeSize == 0;
+        }
+        std::cout << (kept ? "✅" : "❌") << " Loops with nothing to fuse stay in the interpreter\n";
+
+        // Cold code never leaves the interpreter
+        VirtualMachine cold;
+        CountingSink coldOut;
+        cold.setOutput(&coldOut);
+        cold.setEngine(ExecutionEngine::Tiered);
+        cold.execute(counter);
+        std::cout << (cold.getTierUps().empty() && cold.getInstructionCount() == plain.getInstructionCount() ? "✅" : "❌")
+                  << " 500 iterations stay below the default threshold\n";
+        
+        // Budgets stop a compiled loop where the interpreter would stop
+        ExecutionBudget fuel;
+        fuel.maxInstructions = 5000;
+        auto failure = [&](ExecutionEngine engine) {
+            VirtualMachine limited;
+            CountingSink out;
+            limited.setOutput(&out);
+            limited.setEngine(engine);
+            limited.setTierUpThreshold(10);
+            limited.setBudget(fuel);
+            try {
+                limited.execute(nested);
+            } catch (const BudgetExceededError& e) {
+                return std::make_pair(e.pc, e.instructionsExecuted);
+            }
+            return std::make_pair(-1, std::int64_t{0});
+        };
+        auto interpreted = failure(ExecutionEngine::Interpreter);
+        auto tiered = failure(ExecutionEngine::Tiered);
+        std::cout << (interpreted.first >= 0 && (tiered == interpreted || !JitCompiler::isSupported()) ? "✅" : "❌")
+                  << " Fuel runs out at the same back edge inside a compiled loop\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testCheckpointRestore() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Checkpoint and Restore\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    const char* source =
+        "let total = 0;\n"
+        "for i = 1 to 60 {\n"
+        "    for j = 1 to i {\n"
+        "        for total = total + j to 0 {\n"
+        "        }\n"
+        "    }\n"
+        "    if i % 10 == 0 {\n"
+        "        print total;\n"
+        "    }\n"
+        "}\n"
+        "print total * 2;";
+    
+    try {
+        for (bool verify : {true, false}) {
+            BytecodeProgram bytecode = verify ? compileVerified(source) : compile(source);
+            VirtualMachine reference;
+            BufferSink referenceOut;
+            reference.setOutput(&referenceOut);
+            reference.execute(bytecode);
+            
+            // Every checkpoint, encoded and restored into a fresh VM, finishes the run
+            std::vector<std::vector<std::uint8_t>> checkpoints;
+            VirtualMachine vm;
+            BufferSink out;
+            vm.setOutput(&out);
+            vm.setEngine(testEngine);
+            vm.setDispatchMode(testDispatch);
+            vm.setCheckpointInterval(1000, [&](const VMSnapshot& snapshot) {
+                checkpoints.emplace_back();
+                snapshot.encode(checkpoints.back());
+            });
+            vm.execute(bytecode);
+            
+            // The classic loop checkpoints at the same back edges
+            std::vector<std::vector<std::uint8_t>> classicCheckpoints;
+            VirtualMachine classic;
+            CountingSink discard;
+            classic.setOutput(&discard);
+            classic.setDispatchMode(DispatchMode::Classic);
+            classic.setCheckpointInterval(1000, [&](const VMSnapshot& snapshot) {
+                classicCheckpoints.emplace_back();
+                snapshot.encode(classicCheckpoints.back());
+            });
+            classic.execute(bytecode);
+            
+            bool resumed = out.str() == referenceOut.str() && checkpoints.size() > 5 &&
+                           classicCheckpoints == checkpoints;
+            size_t largest = 0;
+            for (const auto& bytes : checkpoints) {
+                largest = std::max(largest, bytes.size());
+                VMSnapshot snapshot = VMSnapshot::decode(bytes);
+                VirtualMachine restored;
+                BufferSink rest;
+                restored.setOutput(&rest);
+                restored.restore(bytecode, snapshot);
+                restored.resume();
+                resumed = resumed && restored.isPaused() == false &&
+                          referenceOut.str().substr(0, snapshot.outputBytes) + rest.str() == referenceOut.str() &&
+                          restored.getInstructionCount() == reference.getInstructionCount() &&
+                          restored.getSlotValue(0) == reference.getSlotValue(0);
+            }
+            std::cout << (resumed ? "✅" : "❌") << (verify ? " Verified" : " Unverified") << " program: "
+                      << checkpoints.size() << " checkpoints, each resumes to the same output ("
+                      << largest << " bytes at most)\n";
+        }
+        
+        BytecodeProgram bytecode = compileVerified(source);
+        VirtualMachine reference;
+        BufferSink referenceOut;
+        reference.setOutput(&referenceOut);
+        reference.execute(bytecode);
+        
+        // A run stopped by its budget continues from the last checkpoint
+        std::vector<std::uint8_t> last;
+        VirtualMachine limited;
+        BufferSink partial;
+        limited.setOutput(&partial);
+        limited.setCheckpointInterval(1000, [&](const VMSnapshot& snapshot) { snapshot.encode(last); });
+        ExecutionBudget fuel;
+        fuel.maxInstructions = 9000;
+        limited.setBudget(fuel);
+        bool stopped = false;
+        try {
+            limited.execute(bytecode);
+        } catch (const BudgetExceededError&) {
+            stopped = true;
+        }
+        VMSnapshot snapshot = VMSnapshot::decode(last);
+        VirtualMachine second;
+        BufferSink rest;
+        second.setOutput(&rest);
+        second.restore(bytecode, snapshot);
+        second.resume();
+        std::string combined = partial.str().substr(0, snapshot.outputBytes) + rest.str();
+        std::cout << (stopped && snapshot.instructionCount <= 9000 && combined == referenceOut.str() ? "✅" : "❌")
+                  << " Budget-stopped run continues from its last checkpoint\n";
+        
+        // The budget keeps counting from the snapshot
+        VirtualMachine capped;
+        CountingSink discard;
+        capped.setOutput(&discard);
+        capped.setBudget(fuel);
+        capped.restore(bytecode, snapshot);
+        bool counted = false;
+        try {
+            capped.resume();
+        } catch (const BudgetExceededError& e) {
+            counted = e.instructionsExecuted - 9000 < 100;
+        }
+        std::cout << (counted ? "✅" : "❌") << " Instruction budget counts the restored instructions\n";
+        
+        // A VM paused at a breakpoint can be snapshotted; the restored copy
+        // stops at the same breakpoint's next hit
+        int printPc = -1;
+        for (size_t pc = 0; pc < bytecode.size(); ++pc) {
+            if (bytecode[pc].opcode == OpCode::PRINT) {
+                printPc = static_cast<int>(pc);
+                break;
+            }
+        }
+        VirtualMachine debugger;
+        BufferSink debugOut;
+        debugger.setOutput(&debugOut);
+        debugger.setObserverMode(ObserverMode::Breakpoint);
+        debugger.addBreakpoint(printPc);
+        debugger.execute(bytecode);
+        debugger.resume();
+        VMSnapshot paused = debugger.checkpoint();
+        VirtualMachine copy;
+        BufferSink copyOut;
+        copy.setOutput(&copyOut);
+        copy.setObserverMode(ObserverMode::Breakpoint);
+        copy.addBreakpoint(printPc);
+        copy.restore(bytecode, paused);
+        copy.resume();
+        bool immediate = copy.isPaused() && copy.getPausedPc() == printPc && copyOut.str().empty();
+        copy.clearBreakpoints();
+        copy.resume();
+        std::cout << (paused.pc == printPc && immediate &&
+                      debugOut.str() + copyOut.str() == referenceOut.str() ? "✅" : "❌")
+                  << " Breakpoint state restored before the paused instruction\n";
+        
+        // Snapshots only go back into the program they came from
+        std::vector<std::uint8_t> bytes;
+        paused.encode(bytes);
+        int rejected = 0;
+        try { VMSnapshot::decode(bytes.data(), bytes.size() - 1); } catch (const std::runtime_error&) { ++rejected; }
+        bytes[0] = 'X';
+        try { VMSnapshot::decode(bytes); } catch (const std::runtime_error&) { ++rejected; }
+        BytecodeProgram other = compileVerified("print 1;");
+        try { copy.restore(other, paused); } catch (const std::runtime_error&) { ++rejected; }
+        std::cout << (rejected == 3 ? "✅" : "❌") << " Truncated, corrupt and mismatched snapshots are rejected\n";
+        
+        // The stack must be exactly as deep as the verifier proved at the
+        // resume pc, or the unchecked loop would read outside it
+        BytecodeProgram sum = compileVerified("let a = 1; let b = 2; print a + b;");
+        int addPc = -1;
+        for (size_t pc = 0; pc < sum.size(); ++pc) {
+            if (sum[pc].opcode == OpCode::ADD) addPc = static_cast<int>(pc);
+        }
+        VirtualMachine atAdd;
+        BufferSink addOut;
+        atAdd.setOutput(&addOut);
+        atAdd.setObserverMode(ObserverMode::Breakpoint);
+        atAdd.addBreakpoint(addPc);
+        atAdd.execute(sum);
+        VMSnapshot exact = atAdd.checkpoint();
+        int refused = 0;
+        for (size_t depth : {size_t(0), size_t(1), size_t(3)}) {
+            VMSnapshot wrong = exact;
+            wrong.stack.resize(depth, 0);
+            VirtualMachine target;
+            try { target.restore(sum, wrong); } catch (const std::runtime_error&) { ++refused; }
+        }
+        VirtualMachine target;
+        BufferSink targetOut;
+        target.setOutput(&targetOut);
+        target.restore(sum, exact);
+        target.resume();
+        std::cout << (exact.stack.size() == 2 && refused == 3 && targetOut.str() == "3\n" ? "✅" : "❌")
+                  << " Snapshots with the wrong stack depth for their pc are rejected\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testTimeSlicing() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: Time Slices and the VM Scheduler\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    const char* source =
+        "let base = 0;\n"
+        "for i = 1 to 200 {\n"
+        "    for j = 1 to 50 {\n"
+        "        let total = base + j;\n"
+        "    }\n"
+        "    if i % 50 == 0 {\n"
+        "        print total;\n"
+        "    }\n"
+        "}";
+    
+    try {
+        BytecodeProgram bytecode = compileVerified(source);
+        VirtualMachine reference;
+        BufferSink referenceOut;
+        reference.setOutput(&referenceOut);
+        reference.execute(bytecode);
+        
+        // Sliced runs pause at back edges and end with the same state on every loop
+        for (DispatchMode mode : {testDispatch, DispatchMode::Classic}) {
+            VirtualMachine vm;
+            BufferSink out;
+            vm.setOutput(&out);
+            vm.setEngine(testEngine);
+            vm.setDispatchMode(mode);
+            vm.setTimeSlice(5000);
+            vm.execute(bytecode);
+            int slices = 1;
+            bool bounded = true;
+            std::int64_t before = 0;
+            while (vm.isPaused()) {
+                bounded = bounded && vm.getPauseReason() == PauseReason::TimeSlice &&
+                          vm.getInstructionCount() - before < 5100;
+                before = vm.getInstructionCount();
+                vm.resume();
+                ++slices;
+            }
+            bool same = out.view() == referenceOut.view() &&
+                        vm.getInstructionCount() == reference.getInstructionCount() &&
+                        vm.getSlotValue(0) == reference.getSlotValue(0);
+            std::cout << (same && bounded && slices > 5 ? "✅" : "❌")
+                      << (mode == DispatchMode::Classic ? " Classic" : " Default") << " loop: "
+                      << slices << " slices of at most ~5000 instructions, same result\n";
+        }
+        
+        // A breakpoint inside a slice still stops the run there
+        VirtualMachine debugger;
+        BufferSink debugOut;
+        debugger.setOutput(&debugOut);
+        debugger.setObserverMode(ObserverMode::Breakpoint);
+        debugger.setTimeSlice(1000);
+        int printPc = -1;
+        for (size_t pc = 0; pc < bytecode.size() && printPc < 0; ++pc) {
+            if (bytecode[pc].opcode == OpCode::PRINT) printPc = static_cast<int>(pc);
+        }
+        debugger.addBreakpoint(printPc);
+        debugger.execute(bytecode);
+        int breakpointStops = 0;
+        while (debugger.isPaused()) {
+            if (debugger.getPauseReason() == PauseReason::Breakpoint) ++breakpointStops;
+            debugger.resume();
+        }
+        std::cout << (breakpointStops == 4 && debugOut.view() == referenceOut.view() ? "✅" : "❌")
+                  << " Breakpoints and time slices interleave (" << breakpointStops << " breakpoint stops)\n";
+        
+        // The scheduler: short programs finish while long ones are still running
+        BytecodeProgram longProgram = compileVerified(
+            "let x = 0;\n"
+            "for i = 1 to 2000000 {\n"
+            "    let y = x + i;\n"
+            "}\n"
+            "print y;");
+        BytecodeProgram shortProgram = compileVerified("let x = 6;\nprint x * 7;");
+        std::mutex lock;
+        std::vector<ScheduledResult> results;
+        auto collect = [&](const ScheduledResult& result) {
+            std::lock_guard<std::mutex> guard(lock);
+            results.push_back(result);
+        };
+        VMScheduler scheduler(2, 10000);
+        for (int i = 0; i < 4; ++i) scheduler.submit(longProgram, collect);
+        for (int i = 0; i < 50; ++i) scheduler.submit(shortProgram, collect);
+        ExecutionBudget fuel;
+        fuel.maxInstructions = 50000;
+        scheduler.submit(longProgram, collect, fuel);
+        scheduler.wait();
+        
+        int longDone = 0, shortDone = 0, shortBeforeLong = 0, budgetStops = 0;
+        for (const ScheduledResult& result : results) {
+            if (result.budgetExceeded) {
+                ++budgetStops;
+            } else if (result.output == "2000000\n" && result.slices > 1) {
+                ++longDone;
+            } else if (result.success && result.output == "42\n" && result.slices == 1) {
+                ++shortDone;
+                if (longDone == 0) ++shortBeforeLong;
+            }
+        }
+        std::cout << (longDone == 4 && shortDone == 50 && budgetStops == 1 && shortBeforeLong == 50 ? "✅" : "❌")
+                  << " Scheduler on " << scheduler.getThreadCount() << " threads: " << shortDone
+                  << " short programs (all before any long one finished), " << longDone << " long, "
+                  << budgetStops << " out of fuel, " << scheduler.getSliceCount() << " slices\n";
+        
+        // Wall time counts across slices, in one VM and through the scheduler's
+        // snapshots alike (fuel only stops the run if it does not)
+        BytecodeProgram endless = compileVerified(
+            "let x = 0;\n"
+            "for i = 1 to 2000000000 {\n"
+            "    let y = x + i;\n"
+            "}");
+        ExecutionBudget time;
+        time.maxWallTime = std::chrono::milliseconds(30);
+        time.maxInstructions = 100000000;
+        VirtualMachine sliced;
+        sliced.setBudget(time);
+        sliced.setTimeSlice(1000);
+        BudgetKind slicedKind = BudgetKind::None;
+        try {
+            sliced.execute(endless);
+            while (sliced.isPaused()) sliced.resume();
+        } catch (const BudgetExceededError& e) {
+            slicedKind = e.kind;
+        }
+        std::string scheduledError;
+        VMScheduler timed(1, 1000);
+        timed.submit(endless, [&](const ScheduledResult& result) { scheduledError = result.error; }, time);
+        timed.wait();
+        bool timedOut = slicedKind == BudgetKind::WallTime &&
+                        scheduledError.find("time limit") != std::string::npos;
+        std::cout << (timedOut ? "✅" : "❌") << " Sliced runs stop at the wall-time limit of the whole program\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+void testIntegerArithmetic() {
+    std::cout << "════════════════════════════════════════\n";
+    std::cout << "Test: 64-bit Values and Overflow Checks\n";
+    std::cout << "════════════════════════════════════════\n";
+    
+    const std::string overflow = OVERFLOW_ERROR;
+    struct Case { const char* name; const char* source; const char* output; bool overflows; };
+    const Case cases[] = {
+        {"sum past 2^31", "let total = 0;\nfor i = 1 to 30000 {\n    for total = total + 100000 to 0 {\n    }\n}\nprint total;",
+         "3000000000\n", false},
+        {"wide literals", "let big = 9223372036854775807;\nprint big;\nprint 0 - big - 1;\nprint 4294967296 * 3;",
+         "9223372036854775807\n-9223372036854775808\n12884901888\n", false},
+        {"add overflows", "let x = 9223372036854775807;\nprint 1;\nprint x + 1;", "1\n", true},
+        {"increment overflows", "let x = 9223372036854775806;\nfor x = x + 1 to 0 {\n}\nprint x;\nfor x = x + 1 to 0 {\n}",
+         "9223372036854775807\n", true},
+        {"sub overflows", "let x = 0 - 9223372036854775807;\nprint x - 2;", "", true},
+        {"mul overflows in a loop", "let x = 1;\nfor i = 1 to 100 {\n    for x = x * 2 to 0 {\n    }\n}\nprint x;", "", true},
+        {"constant mul overflows", "let x = 4294967296;\nlet y = x * 4294967296;", "", true},
+        {"min / -1", "let m = 0 - 9223372036854775807 - 1;\nlet d = 0 - 1;\nprint m % d;\nprint m / d;",
+         "0\n", true},
+        {"counter at the maximum", "for i = 9223372036854775806 to 9223372036854775807 {\n    print i;\n}",
+         "9223372036854775806\n9223372036854775807\n", true},
+    };
+    
+    try {
+        for (const Case& test : cases) {
+            // Classic, threaded, cached, JIT and tiered; plain and fused
+            bool same = true;
+            for (unsigned fuse : {static_cast<unsigned>(FUSE_NONE), static_cast<unsigned>(FUSE_ALL)}) {
+                BytecodeProgram bytecode = compileVerified(test.source, fuse);
+                same = same && bytecode.isVerified();
+                for (int engine = 0; engine < 5; ++engine) {
+                    VirtualMachine vm;
+                    vm.setDispatchMode(engine == 0 ? DispatchMode::Classic :
+                                       engine == 2 ? DispatchMode::Cached : DispatchMode::Threaded);
+                    vm.setEngine(engine == 3 ? ExecutionEngine::Jit :
+                                 engine == 4 ? ExecutionEngine::Tiered : ExecutionEngine::Interpreter);
+                    vm.setTierUpThreshold(2);
+                    BufferSink out;
+                    vm.setOutput(&out);
+                    std::string error;
+                    try { vm.execute(bytecode); } catch (const std::exception& e) { error = e.what(); }
+                    same = same && out.str() == test.output && error == (test.overflows ? overflow : "");
+                }
+            }
+            std::cout << (same ? "✅ " : "❌ ") << test.name
+                      << (test.overflows ? " (" + overflow + ")" : "") << "\n";
+        }
+        
+        // Literals past the 64-bit range are rejected by the parser
+        bool rejected = false;
+        try {
+            Lexer lexer("print 9223372036854775808;");
+            Parser parser(lexer);
+            parser.parse();
+        } catch (const std::exception& e) {
+            rejected = std::string(e.what()).find("out of range") != std::string::npos;
+        }
+        std::cout << (rejected ? "✅" : "❌") << " 9223372036854775808 is out of range\n";
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << "\n";
+    }
+    
+    std::cout << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--jit") {
+        testEngine = ExecutionEngine::Jit;
+    } else if (argc > 1 && std::string(argv[1]) == "--cached") {
+        testDispatch = DispatchMode::Cached;
+    } else if (argc > 1 && std::string(argv[1]) == "--tiered") {
+        testEngine = ExecutionEngine::Tiered;
+    }
+    
     std::cout << "╔════════════════════════════════════════════╗\n";
     std::cout << "║  Educational Compiler - Full Pipeline     ║\n";
     std::cout << "║         VM Execution Tests                 ║\n";
@@ -173,6 +1532,81 @@ int main() {
         "print result;"
     );
     
+    // Test 11: Slot-resolved variables in a loop
+    testFullPipeline(
+        "Loop Variables in Slots",
+        "let total = 0;\n"
+        "for i = 1 to 4 {\n"
+        "    let sq = i * i;\n"
+        "    print sq;\n"
+        "}",
+        false,  // No optimization
+        true    // Trace shows variables by name
+    );
+    
+    // Test 12: Slot read before any store (declared only in an untaken branch)
+    testFullPipeline(
+        "Unassigned Slot Runtime Error",
+        "let x = 1;\n"
+        "if x > 5 {\n"
+        "    let y = 2;\n"
+        "}\n"
+        "print y;"
+    );
+    
+    // Test 13: Superinstructions (same output, fewer dispatches)
+    const char* fusedSource =
+        "let limit = 4;\n"
+        "for i = 1 to limit {\n"
+        "    let double = i * 2;\n"
+        "    print double;\n"
+        "    if i % 2 == 0 {\n"
+        "        print i - 1;\n"
+        "    }\n"
+        "}";
+    testFullPipeline("Loop Without Superinstructions", fusedSource);
+    testFullPipeline("Loop With Superinstructions", fusedSource, false, false, FUSE_ALL);
+    testFullPipeline("Superinstructions with Trace", "let x = 3;\nprint x + 1;", false, true, FUSE_ALL);
+    
+    // Test 14: Observer-specialized loops
+    testObserverModes();
+    
+    // Test 15: Per-VM output sinks
+    testOutputSinks();
+    
+    // Test 16: Native code tier
+    testJitEngine();
+    
+    // Test 17: Profiler and source line table
+    testProfiler();
+    
+    // Test 18: Fuel, output and wall-time budgets
+    testBudgets();
+    
+    // Test 19: Top-of-stack caching
+    testTopOfStackCache();
+    
+    // Test 20: VM reuse and pooling
+    testVmReuse();
+    
+    // Test 21: Counted-loop opcodes
+    testCountedLoops();
+    
+    // Test 22: Sampling profiler
+    testSamplingProfiler();
+    
+    // Test 23: Tiered execution
+    testTieredExecution();
+    
+    // Test 24: Checkpoint and restore
+    testCheckpointRestore();
+    
+    // Test 25: Time slices and the scheduler
+    testTimeSlicing();
+    
+    // Test 26: 64-bit values and overflow checks
+    testIntegerArithmetic();
+    
     std::cout << "╔════════════════════════════════════════════╗\n";
     std::cout << "║          All Tests Completed!              ║\n";
     std::cout << "║                                            ║\n";
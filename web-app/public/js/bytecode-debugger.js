@@ -1038,10 +1038,12 @@ class BytecodeDebugger {
         try {
             switch (instr.opcode) {
                 case 'LOAD_CONST':
+                case 'LOAD_CONST_WIDE':
                     this.stack.push(instr.operand);
                     break;
 
                 case 'LOAD_VAR':
+                case 'LOAD_SLOT':
                     if (this.variables[instr.variable] !== undefined) {
                         this.stack.push(this.variables[instr.variable]);
                     } else {
@@ -1050,6 +1052,7 @@ class BytecodeDebugger {
                     break;
 
                 case 'STORE_VAR':
+                case 'STORE_SLOT':
                     if (this.stack.length === 0) {
                         throw new Error('Stack underflow');
                     }
@@ -908,15 +908,20 @@ function renderBytecode(bytecode) {
         let operand = '-';
         let description = '';
 
-        if (instr.opcode === 'LOAD_CONST' && instr.operand !== undefined) {
+        if ((instr.opcode === 'LOAD_CONST' || instr.opcode === 'LOAD_CONST_WIDE') && instr.operand !== undefined) {
             operand = `<code style="background: var(--bg-tertiary); padding: 0.25rem 0.5rem; border-radius: 0.25rem;">${instr.operand}</code>`;
             description = `Push constant ${instr.operand} onto stack`;
-        } else if (instr.opcode === 'STORE_VAR' && instr.variable) {
+        } else if ((instr.opcode === 'STORE_VAR' || instr.opcode === 'STORE_SLOT') && instr.variable) {
             operand = `<code style="background: var(--bg-tertiary); padding: 0.25rem 0.5rem; border-radius: 0.25rem;">${escapeHtml(instr.variable)}</code>`;
             description = `Store top of stack in variable "${escapeHtml(instr.variable)}"`;
-        } else if (instr.opcode === 'LOAD_VAR' && instr.variable) {
+        } else if ((instr.opcode === 'LOAD_VAR' || instr.opcode === 'LOAD_SLOT') && instr.variable) {
             operand = `<code style="background: var(--bg-tertiary); padding: 0.25rem 0.5rem; border-radius: 0.25rem;">${escapeHtml(instr.variable)}</code>`;
             description = `Push variable "${escapeHtml(instr.variable)}" onto stack`;
+        } else if ((instr.opcode === 'FOR_PREP' || instr.opcode === 'FOR_LOOP') && instr.variable) {
+            operand = `<code style="background: var(--bg-tertiary); padding: 0.25rem 0.5rem; border-radius: 0.25rem;">${escapeHtml(instr.variable)}, ${instr.target}</code>`;
+            description = instr.opcode === 'FOR_PREP'
+                ? `Skip the loop (jump to ${instr.target}) if "${escapeHtml(instr.variable)}" is past the limit on the stack`
+                : `Add 1 to "${escapeHtml(instr.variable)}", jump back to ${instr.target} while it is within the limit`;
         } else if (instr.opcode === 'ADD') {
             description = 'Pop two values, add them, push result';
         } else if (instr.opcode === 'SUB') {
@@ -1141,7 +1146,8 @@ function renderErrors(data) {
         'syntax': 'Syntax Analysis',
         'semantic': 'Semantic Analysis',
         'optimization': 'Optimization',
-        'codegen': 'Code Generation'
+        'codegen': 'Code Generation',
+        'budget': 'Execution (budget exceeded)'
     };
 
     const stageName = stageNames[failedStage] || 'Unknown Stage';
@@ -1209,6 +1215,15 @@ function renderErrors(data) {
         stageContent.appendChild(genericError);
     }
 
+    // Output printed before an execution budget ran out
+    if (data.output) {
+        const partialHeader = document.createElement('h4');
+        partialHeader.textContent = 'Partial Output';
+        partialHeader.style.cssText = 'color: var(--text-primary); margin: 1rem 0; font-size: 1.125rem;';
+        stageContent.appendChild(partialHeader);
+        stageContent.appendChild(createCodeBlock(data.output));
+    }
+
     // Help message
     const helpBox = document.createElement('div');
     helpBox.style.cssText = `